@@ -33,17 +33,21 @@ GraphicsEngine::GraphicsEngine(std::string title, GLint width, GLint height) :
 {
     isDrawAxes = GL_FALSE;
     isPlaying = GL_FALSE;
-    fps = 5;
 
+    // Configuration is loaded by main, which may select another drive from the command line.
     confLoader = ConfigLoader::getInstance();
-    confLoader->loadFile("conf.txt");
 
     screen = Screen::getInstance();
 
     dataLoader = DataLoader::getInstance();
 
     pointsLoader = PointsLoader::getInstance();
-    dataLoader->attach(pointsLoader);
+    dataLoader->attach(static_cast<Observer<CloudPoints>*>(pointsLoader));
+    dataLoader->attach(static_cast<Observer<OXT>*>(pointsLoader));
+
+    mapLoader = MapLoader::getInstance();
+    dataLoader->attach(mapLoader);
+    isDrawMap = confLoader->isMap();
 
     boxLoader = BoxLoader::instance();
     dataLoader->attach(boxLoader);
@@ -202,6 +206,7 @@ Currently empty, no allocated memory to clear.
 
 GraphicsEngine::~GraphicsEngine() {
     delete pointsLoader;
+    delete mapLoader;
     delete dataLoader;
     delete boxLoader;
     delete subwindow;
@@ -230,9 +235,19 @@ void GraphicsEngine::display()
         setSize(1500, 800);
     }
 
-    sf::Vector2u subwindowSize = sf::Vector2u(size.x, 200);
+    // Each row of the camera grid gets the height of the strip, the grid at most half the window.
+    int numRows = subwindow->getNumRows();
+    int subwindowHeight = std::min(numRows * SUBWINDOW_HEIGHT, (int)size.y / 2);
+    sf::Vector2u subwindowSize = sf::Vector2u(size.x, isCameraEnlarged && numRows > 0 ? size.y / 2 : subwindowHeight);
     glViewport(0, subwindowSize.y, size.x, size.y - subwindowSize.y);
 
+    // Only shown cameras are loaded, no larger than their view unless enlarged.
+    dataLoader->setVisibleCameras(subwindow->getVisibleCameras());
+    if (isCameraEnlarged || numRows == 0)
+        dataLoader->setImageViewSize(0, 0);
+    else
+        dataLoader->setImageViewSize(subwindowSize.x / subwindow->getNumColumns(), subwindowSize.y / numRows);
+
     screen->update(size.y, size.x);
 
     // Set view matrix via current camera.
@@ -259,26 +274,43 @@ void GraphicsEngine::display()
     // Reset PVM
     glUniformMatrix4fv(PVMLoc, 1, GL_FALSE, glm::value_ptr(projection*view*up));
 
+    glm::vec3 eye;
+    if (CameraNumber == 1)
+        eye = sphcamera.getPosition();
+    else if (CameraNumber == 2)
+        eye = yprcamera.getPosition();
+
+    // Zoomed out or fast playback draws fewer points, a shorter prefix of the progressive sweep.
     if (isDrawCloudpoints)
-        pointsLoader->draw();
+    {
+        float distance = std::max(glm::length(eye), 1.0f);
+        float detail = std::min(POINT_DETAIL_DISTANCE * POINT_DETAIL_DISTANCE / (distance * distance), 1.0f);
+        detail /= std::max(getPlaybackSpeed(), 1.0f);
+        pointsLoader->draw(PVMLoc, projection*view*up, std::max(detail, MIN_POINT_DETAIL));
+    }
+
+    // The map opens once its builder is done.
+    if (isDrawMap)
+    {
+        if (!mapLoader->isOpen() && dataLoader->isMapReady())
+            mapLoader->open(dataLoader->getMapFilename());
+        mapLoader->draw(PVMLoc, projection, view*up, size.y - subwindowSize.y);
+    }
     boxLoader->draw(PVMLoc, projection, view);
 
     speedometer.draw();
     glUseProgram(program);
 
     // Look at the main vehicle
-    glm::vec3 eye;
-    if (CameraNumber == 1)
-        eye = sphcamera.getPosition();
-    else if (CameraNumber == 2)
-        eye = yprcamera.getPosition();
-
     glUniform3fv(glGetUniformLocation(program, "eye"), 1, glm::value_ptr(eye));
     mainCar.setEye(eye);
     mainCar.draw(projection, view);
 
-    glViewport(0, 0, subwindowSize.x, subwindowSize.y);
-    subwindow->draw();
+    if (subwindowSize.y > 0)
+    {
+        glViewport(0, 0, subwindowSize.x, subwindowSize.y);
+        subwindow->draw();
+    }
 
 
     sf::RenderWindow::display();
@@ -720,6 +752,171 @@ void GraphicsEngine::toggleDrawCloudpoints()
     isDrawCloudpoints = !isDrawCloudpoints;
 }
 
+/**
+\brief Toggles between the camera strip and camera views enlarged to full resolution.
+
+*/
+
+void GraphicsEngine::toggleEnlargedCameras()
+{
+    isCameraEnlarged = !isCameraEnlarged;
+}
+
+/**
+\brief Shows or hides a camera in the camera grid.
+
+\param camera --- KITTI camera number, 0 for image_00.
+
+*/
+
+void GraphicsEngine::toggleCamera(int camera)
+{
+    subwindow->toggleCamera(camera);
+}
+
+/**
+\brief Steps number of sweeps drawn through 1, 5, 10 and 20, older sweeps are placed by the
+ego motion since.
+
+*/
+
+void GraphicsEngine::cycleAccumulatedSweeps()
+{
+    int count = pointsLoader->getNumSweeps();
+    count = count < 5 ? 5 : count < 10 ? 10 : count < PointsLoader::MAX_SWEEPS ? PointsLoader::MAX_SWEEPS : 1;
+    pointsLoader->setNumSweeps(count);
+    printf("Cloud points: %d sweep(s)\n", count);
+}
+
+/**
+\brief Steps most cloud points drawn per frame through all, 400k, 200k, 100k and 50k. Sweeps
+are ordered progressively, so a lower budget thins out the whole sweep.
+
+*/
+
+void GraphicsEngine::cyclePointBudget()
+{
+    GLuint budget = pointsLoader->getPointBudget();
+    budget = budget == 0 ? 400000 : budget > 50000 ? budget / 2 : 0;
+    pointsLoader->setPointBudget(budget);
+    if (budget > 0)
+        printf("Cloud points: at most %u per frame\n", budget);
+    else
+        printf("Cloud points: all drawn\n");
+}
+
+/**
+\brief Toggles drawing the map of the whole drive, building it first if missing.
+
+*/
+
+void GraphicsEngine::toggleMap()
+{
+    isDrawMap = !isDrawMap;
+    if (isDrawMap && !dataLoader->isMapReady())
+    {
+        dataLoader->buildMap();
+        printf("Map: shown once built\n");
+        return;
+    }
+    printf("Map: %s, %d MB on GPU\n", isDrawMap ? "shown" : "hidden", (int)(mapLoader->getGPUBytes() >> 20));
+}
+
+/**
+\brief Toggles keeping only cloud points within view of the color cameras.
+
+*/
+
+void GraphicsEngine::toggleCameraViewPoints()
+{
+    PointFilter::Settings settings = dataLoader->getPointFilter();
+    settings.isCameraView = !settings.isCameraView;
+    dataLoader->setPointFilter(settings);
+    printf("Cloud points: %s\n", settings.isCameraView ? "camera view only" : "all around");
+}
+
+/**
+\brief Steps voxel size cloud points are thinned out with through off, 0.1, 0.2 and 0.4 meters.
+
+*/
+
+void GraphicsEngine::cyclePointVoxelSize()
+{
+    PointFilter::Settings settings = dataLoader->getPointFilter();
+    if (settings.voxelSize <= 0)
+        settings.voxelSize = 0.1;
+    else if (settings.voxelSize < 0.4)
+        settings.voxelSize = std::min(settings.voxelSize * 2, 0.4f);
+    else
+        settings.voxelSize = 0;
+    dataLoader->setPointFilter(settings);
+    printf("Cloud points: voxel size %.2f m\n", settings.voxelSize);
+}
+
+/**
+\brief Steps cloud points kept from every point up to every fourth point.
+
+*/
+
+void GraphicsEngine::cyclePointStride()
+{
+    PointFilter::Settings settings = dataLoader->getPointFilter();
+    settings.stride = settings.stride % 4 + 1;
+    dataLoader->setPointFilter(settings);
+    printf("Cloud points: keeping 1 in %d\n", settings.stride);
+}
+
+/**
+\brief Steps farthest cloud points kept through all, 60, 40 and 20 m from the velodyne.
+
+*/
+
+void GraphicsEngine::cyclePointRange()
+{
+    PointFilter::Settings settings = dataLoader->getPointFilter();
+    if (settings.maxRange <= 0)
+        settings.maxRange = 60;
+    else if (settings.maxRange > 20)
+        settings.maxRange = std::max(settings.maxRange - 20, 20.0f);
+    else
+        settings.maxRange = 0;
+    dataLoader->setPointFilter(settings);
+    if (settings.maxRange > 0)
+        printf("Cloud points: within %.0f m\n", settings.maxRange);
+    else
+        printf("Cloud points: any range\n");
+}
+
+/**
+\brief Steps cloud points kept through all, above the ground, and above the ground up to 3 m.
+
+*/
+
+void GraphicsEngine::cyclePointHeight()
+{
+    PointFilter::Settings settings = dataLoader->getPointFilter();
+    if (settings.minHeight == -INFINITY)
+    {
+        settings.minHeight = 0.3f - PointFilter::SENSOR_HEIGHT;
+        settings.maxHeight = INFINITY;
+    }
+    else if (settings.maxHeight == INFINITY)
+        settings.maxHeight = 3 - PointFilter::SENSOR_HEIGHT;
+    else
+    {
+        settings.minHeight = -INFINITY;
+        settings.maxHeight = INFINITY;
+    }
+    dataLoader->setPointFilter(settings);
+    if (settings.minHeight == -INFINITY)
+        printf("Cloud points: any height\n");
+    else if (settings.maxHeight == INFINITY)
+        printf("Cloud points: over %.1f m above ground\n", settings.minHeight + PointFilter::SENSOR_HEIGHT);
+    else
+        printf("Cloud points: %.1f to %.1f m above ground\n",
+               settings.minHeight + PointFilter::SENSOR_HEIGHT, settings.maxHeight + PointFilter::SENSOR_HEIGHT);
+}
+
 /**
 \brief Toggles the boolean to draw the axes or not.
 
@@ -742,35 +939,83 @@ void GraphicsEngine::togglePlayingVideo()
 }
 
 /**
-\brief Increase frame rate (frame per second).
+\brief Scale playback speed.
+
+\param factor - multiplier applied to current speed, e.g. 2 to double or 0.5 to halve it.
+*/
+
+void GraphicsEngine::changePlaybackSpeed(float factor)
+{
+    setPlaybackSpeed(getPlaybackSpeed() * factor);
+}
+
+/**
+\brief Set playback speed.
+
+\param speed - drive seconds played per second, clamped to 0.1x - 16x.
+*/
+
+void GraphicsEngine::setPlaybackSpeed(float speed)
+{
+    dataLoader->setPlaybackSpeed(speed);
+}
+
+/**
+\brief Get playback speed.
+*/
+
+float GraphicsEngine::getPlaybackSpeed() const
+{
+    return dataLoader->getPlaybackSpeed();
+}
+
+/**
+\brief Toggle playing backward.
+*/
+
+void GraphicsEngine::toggleReverse()
+{
+    dataLoader->setReverse(!dataLoader->isReverse());
+}
+
+/**
+\brief Check if playing backward.
+*/
+
+bool GraphicsEngine::isReverse() const
+{
+    return dataLoader->isReverse();
+}
+
+/**
+\brief Jump forward or backward from the current frame.
 
-\param diff - increasing value. This can be set to negative value to decrease framerate
+\param diff - number of frames to jump, negative to jump backward.
 */
 
-void GraphicsEngine::increaseFrameRate(int diff)
+void GraphicsEngine::seekFrames(int diff)
 {
-    setFrameRate(fps + diff);
+    seekToFrame(dataLoader->getCurrentFrame() + diff);
 }
 
 /**
-\brief Set frame rate (frame per second).
+\brief Jump to a frame.
 
-\param frameRate
+\param frameId - id of target frame.
 */
 
-void GraphicsEngine::setFrameRate(int frameRate)
+void GraphicsEngine::seekToFrame(int frameId)
 {
-    fps = frameRate;
-    dataLoader->setFPS(fps);
+    dataLoader->seek(frameId);
 }
 
 /**
-\brief Get frame rate (frame per second).
+\brief Print loader latency statistics to console.
 */
 
-int GraphicsEngine::getFrameRate() const
+void GraphicsEngine::printLoaderStats()
 {
-    return fps;
+    dataLoader->printStats();
 }
 
 /**
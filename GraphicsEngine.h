@@ -16,6 +16,7 @@
 
 #include "lib/objects/Axes.h"
 #include "lib/loaders/PointsLoader.h"
+#include "lib/loaders/MapLoader.h"
 #include "lib/loaders/DataLoader.h"
 #include "lib/loaders/BoxLoader.h"
 #include "lib/loaders/ConfigLoader.h"
@@ -50,10 +51,16 @@ class GraphicsEngine : public sf::RenderWindow {
         GLenum mode;    ///< Mode, either point, line or fill.
         int sscount;    ///< Screenshot count to be appended to the screenshot filename.
         bool isDrawCloudpoints = true;
+        bool isDrawMap = false;             ///< Map of the whole drive drawn around the sweeps.
+        bool isCameraEnlarged = false;      ///< Camera views take half the window at full resolution.
         const int NUM_LIGHT = 3;
+        const int SUBWINDOW_HEIGHT = 200;   ///< Height of a camera grid row when not enlarged.
+        const float POINT_DETAIL_DISTANCE = 30;     ///< Camera distance up to which every cloud point is drawn.
+        const float MIN_POINT_DETAIL = 0.25;        ///< Smallest fraction of cloud points drawn when zoomed out or fast.
 
         Axes coords;    ///< Axes Object
         PointsLoader* pointsLoader;      ///< Object to load velodyne cloud points.
+        MapLoader* mapLoader;            ///< Object to stream the map of the drive.
         DataLoader* dataLoader;          ///< Object to control all data processing.
         BoxLoader* boxLoader;            ///< Object to control all bouding boxes.
         SubWindow* subwindow;             ///< SubWindow Objects
@@ -98,8 +105,6 @@ class GraphicsEngine : public sf::RenderWindow {
         GraphicsEngine(std::string, GLint, GLint);
         ~GraphicsEngine();
 
-        int fps;
-
         void display();
         void changeMode();
         void screenshotPNG();
@@ -120,11 +125,27 @@ class GraphicsEngine : public sf::RenderWindow {
         void togglePlayingVideo();
         void toggleBoxes();
         void toggleDrawCloudpoints();
+        void toggleEnlargedCameras();
+        void toggleCamera(int camera);
+        void cycleAccumulatedSweeps();
+        void cyclePointBudget();
+        void toggleMap();
+        void toggleCameraViewPoints();
+        void cyclePointVoxelSize();
+        void cyclePointStride();
+        void cyclePointRange();
+        void cyclePointHeight();
         void toggleSpeedUnit();
 
-        void setFrameRate(int frameRate);
-        int getFrameRate() const;
-        void increaseFrameRate(int diff);
+        void setPlaybackSpeed(float speed);
+        float getPlaybackSpeed() const;
+        void changePlaybackSpeed(float factor);
+        void toggleReverse();
+        bool isReverse() const;
+
+        void seekFrames(int diff);
+        void seekToFrame(int frameId);
+        void printLoaderStats();
 
         void setupSideWindows();
         void drawSideWindows();
@@ -200,6 +200,69 @@ void UI::keyPressed(sf::Event::KeyEvent keyevent)
         ge->toggleBoxes();
         break;
 
+    case sf::Keyboard::V:
+        ge->toggleEnlargedCameras();
+        break;
+
+    case sf::Keyboard::Num0:
+    case sf::Keyboard::Num1:
+    case sf::Keyboard::Num2:
+    case sf::Keyboard::Num3:
+        ge->toggleCamera(key - sf::Keyboard::Num0);
+        break;
+
+    case sf::Keyboard::A:
+        ge->cycleAccumulatedSweeps();
+        break;
+
+    case sf::Keyboard::K:
+        ge->cyclePointBudget();
+        break;
+
+    case sf::Keyboard::O:
+        ge->toggleMap();
+        break;
+
+    case sf::Keyboard::F:
+        ge->toggleCameraViewPoints();
+        break;
+
+    case sf::Keyboard::G:
+        ge->cyclePointVoxelSize();
+        break;
+
+    case sf::Keyboard::T:
+        ge->cyclePointStride();
+        break;
+
+    case sf::Keyboard::D:
+        ge->cyclePointRange();
+        break;
+
+    case sf::Keyboard::H:
+        ge->cyclePointHeight();
+        break;
+
+    case sf::Keyboard::R:
+        ge->toggleReverse();
+        break;
+
+    case sf::Keyboard::LBracket:
+        ge->seekFrames(-10);
+        break;
+
+    case sf::Keyboard::RBracket:
+        ge->seekFrames(10);
+        break;
+
+    case sf::Keyboard::Home:
+        ge->seekToFrame(0);
+        break;
+
+    case sf::Keyboard::L:
+        ge->printLoaderStats();
+        break;
+
     default:
         break;
     }
@@ -209,10 +272,10 @@ void UI::keyPressed(sf::Event::KeyEvent keyevent)
     if (shiftdown)
     {
         if (sf::Keyboard::isKeyPressed(sf::Keyboard::Comma))
-                ge->increaseFrameRate(-1);
+                ge->changePlaybackSpeed(0.5);
 
         if (sf::Keyboard::isKeyPressed(sf::Keyboard::Period))
-            ge->increaseFrameRate(1);
+            ge->changePlaybackSpeed(2);
     }
 }
 
@@ -1,11 +1,11 @@
 #include "BoundingBox.h"
 
-BoundingBox::BoundingBox(char type[], glm::vec3 s, glm::vec3 t, float r)
+BoundingBox::BoundingBox(const char type[], glm::vec3 s, glm::vec3 t, float r)
 {
     setData(type, s, t, r);
 }
 
-BoundingBox::BoundingBox(char type[], glm::vec3 s, glm::vec3 t, glm::vec3 r)
+BoundingBox::BoundingBox(const char type[], glm::vec3 s, glm::vec3 t, glm::vec3 r)
 {
     setData(type, s, t, r.z);
 }
@@ -14,7 +14,7 @@ BoundingBox::~BoundingBox()
 {
 }
 
-void BoundingBox::setData(char type[], glm::vec3 s, glm::vec3 t, float r)
+void BoundingBox::setData(const char type[], glm::vec3 s, glm::vec3 t, float r)
 {
     objectType = type;
     transform = glm::vec3(t.x, t.z, -t.y);
@@ -28,7 +28,7 @@ void BoundingBox::setData(char type[], glm::vec3 s, glm::vec3 t, float r)
     model = glm::scale(model, size);
 }
 
-glm::mat4 BoundingBox::getModelMatrix()
+glm::mat4 BoundingBox::getModelMatrix() const
 {
     return model;
 }
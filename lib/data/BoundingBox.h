@@ -17,10 +17,10 @@ class BoundingBox
 {
     public:
         BoundingBox(std::string filename);
-        BoundingBox(char[], glm::vec3, glm::vec3, float);
-        BoundingBox(char[], glm::vec3, glm::vec3, glm::vec3);
+        BoundingBox(const char[], glm::vec3, glm::vec3, float);
+        BoundingBox(const char[], glm::vec3, glm::vec3, glm::vec3);
         ~BoundingBox();
-        glm::mat4 getModelMatrix();
+        glm::mat4 getModelMatrix() const;
     protected:
     private:
         glm::mat4 model;
@@ -29,7 +29,7 @@ class BoundingBox
         glm::vec3 transform;
         float rotAngle;
 
-        void setData(char[], glm::vec3, glm::vec3, float);
+        void setData(const char[], glm::vec3, glm::vec3, float);
 };
 
 #endif // BOUNDINGBOX_H
@@ -10,8 +10,57 @@ BoxList::BoxList(std::string filename)
         exit(EXIT_FAILURE);
     }
 
+    parse(infile);
+}
+
+/**
+\brief Parse boxes already in memory.
+
+\param bytes - content of a tracklet file, empty if the frame has no boxes.
+\param size - number of bytes.
+*/
+
+BoxList::BoxList(const char* bytes, size_t size)
+{
+    std::istringstream in(std::string(bytes, size));
+    parse(in);
+}
+
+/**
+\brief Take the boxes of a frame from a tracklet store, without copying them.
+
+\param store - tracklets of the drive.
+\param frameId - id of the frame.
+*/
+
+BoxList::BoxList(std::shared_ptr<const TrackletStore> store, int frameId) : store(store), slice(store->getBoxes(frameId))
+{
+}
+
+BoxList::~BoxList()
+{
+    //dtor
+}
+
+/**
+\brief Get view of the boxes. The view is valid as long as this object lives.
+*/
+
+ArrayView<BoundingBox> BoxList::getData() const
+{
+    return store ? slice : ArrayView<BoundingBox>(data);
+}
+
+/**
+\brief Parse one box per line: type, size, translation and rotation.
+
+\param in - stream to read from.
+*/
+
+void BoxList::parse(std::istream& in)
+{
     std::string line;
-    while (std::getline(infile, line))
+    while (std::getline(in, line))
     {
         std::istringstream iss(line);
         char objectType[10];
@@ -25,13 +74,3 @@ BoxList::BoxList(std::string filename)
         data.push_back(BoundingBox(objectType, size, transform, rotation));
     }
 }
-
-BoxList::~BoxList()
-{
-    //dtor
-}
-
-std::vector<BoundingBox> BoxList::getData()
-{
-    return data;
-}
\ No newline at end of file
@@ -9,19 +9,28 @@
 #include <string>
 #include <fstream>
 #include <vector>
+#include <memory>
 
 #include "../data/BoundingBox.h"
+#include "../data/TrackletStore.h"
+#include "../utils/ArrayView.h"
 
 class BoxList
 {
     public:
         BoxList(std::string filename);
+        BoxList(const char* bytes, size_t size);
+        BoxList(std::shared_ptr<const TrackletStore> store, int frameId);
         virtual ~BoxList();
-        std::vector<BoundingBox> getData();
+        ArrayView<BoundingBox> getData() const;
     protected:
 
     private:
-        std::vector<BoundingBox> data;
+        std::vector<BoundingBox> data;                  ///< Boxes parsed from a per-frame tracklet file.
+        std::shared_ptr<const TrackletStore> store;     ///< Owner of boxes when sliced from a store, NULL otherwise.
+        ArrayView<BoundingBox> slice;                   ///< Boxes of the frame in store.
+
+        void parse(std::istream& in);
 };
 
 #endif // BOXLIST_H
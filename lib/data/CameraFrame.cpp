@@ -0,0 +1,282 @@
+#include "CameraFrame.h"
+
+const char CameraFrame::MAGIC[4] = {'K', 'V', 'C', 'F'};
+const uint32_t CameraFrame::VERSION;
+const int CameraFrame::MAX_LEVELS;
+
+/**
+\brief Allocate a frame to decode into. Level 0 is filled in through getPixels, then
+buildMips computes the other levels.
+
+\param width - width in pixels.
+\param height - height in pixels.
+\param channels - bytes per pixel.
+*/
+
+CameraFrame::CameraFrame(int width, int height, int channels)
+{
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.width = std::max(width, 1);
+    header.height = std::max(height, 1);
+    header.channels = channels;
+    header.numLevels = 1;
+    while (header.numLevels < MAX_LEVELS && std::max(getWidth(header.numLevels - 1), getHeight(header.numLevels - 1)) > 1)
+        header.numLevels++;
+
+    std::shared_ptr<FileBuffer> buffer = BufferPool::getInstance()->acquire(layout(header, offsets));
+    memcpy(buffer->getData(), &header, sizeof(header));
+    writable = buffer->getData();
+    bytes = buffer;
+}
+
+/**
+\brief Transcode a decoded image, dropping alpha and building its mip chain.
+
+\param rgba - four bytes per pixel, rows top to bottom.
+\param width - width in pixels.
+\param height - height in pixels.
+*/
+
+CameraFrame::CameraFrame(const uint8_t* rgba, int width, int height) : CameraFrame(width, height, 3)
+{
+    uint8_t* dst = getPixels(0);
+    for (size_t i = 0; i < (size_t)width * height; i++)
+    {
+        dst[3 * i] = rgba[4 * i];
+        dst[3 * i + 1] = rgba[4 * i + 1];
+        dst[3 * i + 2] = rgba[4 * i + 2];
+    }
+    buildMips();
+}
+
+/**
+\brief Shrink an image to a smaller size with a box filter, then build its mip chain. Each
+target pixel averages the source pixels it covers, so the target can be any size up to the
+source size.
+
+\param pixels - channels bytes per pixel, rows top to bottom.
+\param width - width of the source.
+\param height - height of the source.
+\param channels - bytes per pixel.
+\param targetWidth - width of the frame, at most width.
+\param targetHeight - height of the frame, at most height.
+*/
+
+CameraFrame::CameraFrame(const uint8_t* pixels, int width, int height, int channels, int targetWidth, int targetHeight)
+    : CameraFrame(targetWidth, targetHeight, channels)
+{
+    std::vector<int> xStarts;
+    std::vector<int> yStarts;
+    boxSpans(width, getWidth(), xStarts);
+    boxSpans(height, getHeight(), yStarts);
+
+    // Column sums of the rows under one target row, then averaged across each column span.
+    std::vector<uint32_t> sums((size_t)width * channels);
+    uint8_t* dst = getPixels(0);
+    for (int y = 0; y < getHeight(); y++)
+    {
+        std::fill(sums.begin(), sums.end(), 0);
+        for (int sy = yStarts[y]; sy < yStarts[y + 1]; sy++)
+        {
+            const uint8_t* row = pixels + (size_t)sy * width * channels;
+            for (size_t i = 0; i < sums.size(); i++)
+                sums[i] += row[i];
+        }
+
+        int rows = yStarts[y + 1] - yStarts[y];
+        for (int x = 0; x < getWidth(); x++)
+        {
+            int count = rows * (xStarts[x + 1] - xStarts[x]);
+            for (int c = 0; c < channels; c++)
+            {
+                uint32_t sum = 0;
+                for (int sx = xStarts[x]; sx < xStarts[x + 1]; sx++)
+                    sum += sums[sx * channels + c];
+                *dst++ = (sum + count / 2) / count;
+            }
+        }
+    }
+    buildMips();
+}
+
+/**
+\brief Use a frame read from the camera cache in place.
+
+\param file - content of a cached frame, checked with isEncoded.
+*/
+
+CameraFrame::CameraFrame(std::shared_ptr<const FileBuffer> file) : bytes(file)
+{
+    memcpy(&header, file->getData(), sizeof(header));
+    layout(header, offsets);
+}
+
+CameraFrame::~CameraFrame()
+{
+    //dtor
+}
+
+/**
+\brief Check if bytes hold a complete cached frame rather than an image file.
+
+\param bytes - content of a file.
+\param size - number of bytes.
+*/
+
+bool CameraFrame::isEncoded(const char* bytes, size_t size)
+{
+    if (size < sizeof(Header) || memcmp(bytes, MAGIC, sizeof(MAGIC)) != 0)
+        return false;
+
+    Header header;
+    memcpy(&header, bytes, sizeof(header));
+    if (header.version != VERSION || header.width == 0 || header.height == 0 || header.width > 1 << 15 ||
+        header.height > 1 << 15 || header.channels == 0 || header.channels > 4 || header.numLevels == 0 ||
+        header.numLevels > MAX_LEVELS)
+        return false;
+
+    size_t offsets[MAX_LEVELS];
+    return layout(header, offsets) == size;
+}
+
+/**
+\brief Get width of a mip level, halved per level and at least 1.
+*/
+
+int CameraFrame::getWidth(int level) const
+{
+    return std::max((int)header.width >> level, 1);
+}
+
+/**
+\brief Get height of a mip level, halved per level and at least 1.
+*/
+
+int CameraFrame::getHeight(int level) const
+{
+    return std::max((int)header.height >> level, 1);
+}
+
+int CameraFrame::getChannels() const
+{
+    return header.channels;
+}
+
+int CameraFrame::getNumLevels() const
+{
+    return header.numLevels;
+}
+
+/**
+\brief Get pixels of a mip level, rows are tightly packed.
+*/
+
+const uint8_t* CameraFrame::getPixels(int level) const
+{
+    return (const uint8_t*)bytes->getData() + offsets[level];
+}
+
+/**
+\brief Get pixels of a mip level to fill in, only for frames allocated by this process.
+*/
+
+uint8_t* CameraFrame::getPixels(int level)
+{
+    if (!writable)
+    {
+        printf("Camera frame read from cache can not be modified.\n");
+        exit(1);
+    }
+    return (uint8_t*)writable + offsets[level];
+}
+
+/**
+\brief Compute every mip level from level 0.
+*/
+
+void CameraFrame::buildMips()
+{
+    for (int level = 1; level < header.numLevels; level++)
+        downsample(getPixels(level - 1), getWidth(level - 1), getHeight(level - 1), header.channels, getPixels(level));
+}
+
+/**
+\brief Get the whole frame as stored in the camera cache.
+*/
+
+std::shared_ptr<const FileBuffer> CameraFrame::getBytes() const
+{
+    return bytes;
+}
+
+size_t CameraFrame::getByteSize() const
+{
+    return bytes->getSize();
+}
+
+/**
+\brief Compute where each level starts.
+
+\param header - frame size and level count.
+\param offsets - receives start of each level.
+\return total size of the frame in bytes.
+*/
+
+size_t CameraFrame::layout(const Header& header, size_t offsets[])
+{
+    size_t size = sizeof(Header);
+    for (int level = 0; level < header.numLevels; level++)
+    {
+        offsets[level] = size;
+        size += (size_t)std::max((int)header.width >> level, 1) * std::max((int)header.height >> level, 1) * header.channels;
+    }
+    return size;
+}
+
+/**
+\brief Average 2x2 blocks of a level into the next one. An odd last row or column is
+left out, a level of size 1 is repeated.
+
+\param src - pixels of the level.
+\param width - width of the level.
+\param height - height of the level.
+\param channels - bytes per pixel.
+\param dst - receives pixels of the next level.
+*/
+
+void CameraFrame::downsample(const uint8_t* src, int width, int height, int channels, uint8_t* dst)
+{
+    int dstWidth = std::max(width >> 1, 1);
+    int dstHeight = std::max(height >> 1, 1);
+    for (int y = 0; y < dstHeight; y++)
+    {
+        int y0 = std::min(2 * y, height - 1);
+        int y1 = std::min(2 * y + 1, height - 1);
+        const uint8_t* row0 = src + (size_t)y0 * width * channels;
+        const uint8_t* row1 = src + (size_t)y1 * width * channels;
+        uint8_t* out = dst + (size_t)y * dstWidth * channels;
+        for (int x = 0; x < dstWidth; x++)
+        {
+            int x0 = std::min(2 * x, width - 1) * channels;
+            int x1 = std::min(2 * x + 1, width - 1) * channels;
+            for (int c = 0; c < channels; c++)
+                out[x * channels + c] = (row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2;
+        }
+    }
+}
+
+/**
+\brief Split a source axis into one span of whole pixels per target pixel.
+
+\param size - source pixels.
+\param targetSize - target pixels, at most size.
+\param starts - receives targetSize + 1 span bounds.
+*/
+
+void CameraFrame::boxSpans(int size, int targetSize, std::vector<int>& starts)
+{
+    starts.resize(targetSize + 1);
+    for (int i = 0; i <= targetSize; i++)
+        starts[i] = (int)((int64_t)i * size / targetSize);
+}
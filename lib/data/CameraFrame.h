@@ -0,0 +1,72 @@
+#ifndef CAMERAFRAME_H
+#define CAMERAFRAME_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#include "../utils/FileBuffer.h"
+#include "../utils/BufferPool.h"
+
+/**
+\class CameraFrame
+
+\brief Camera image in the layout it is uploaded to the GPU in: tightly packed RGB8 rows
+followed by every mip level down to 1x1, each a 2x2 box average of the level above.
+
+The frame is one contiguous buffer that is also its file format, so a frame read from the
+camera cache is used as is, without decoding or copying. Layout: Header, then the pixels of
+each level in turn.
+
+*/
+
+class CameraFrame
+{
+    public:
+        static const char MAGIC[4];
+        static const uint32_t VERSION = 1;
+        static const int MAX_LEVELS = 16;
+
+        struct Header
+        {
+            char magic[4];
+            uint32_t version;
+            uint32_t width;
+            uint32_t height;
+            uint32_t channels;      ///< Bytes per pixel.
+            uint32_t numLevels;     ///< Mip levels stored, level 0 is the full image.
+        };
+
+        CameraFrame(int width, int height, int channels);
+        CameraFrame(const uint8_t* rgba, int width, int height);
+        CameraFrame(const uint8_t* pixels, int width, int height, int channels, int targetWidth, int targetHeight);
+        CameraFrame(std::shared_ptr<const FileBuffer> file);
+        ~CameraFrame();
+
+        static bool isEncoded(const char* bytes, size_t size);
+
+        int getWidth(int level = 0) const;
+        int getHeight(int level = 0) const;
+        int getChannels() const;
+        int getNumLevels() const;
+        const uint8_t* getPixels(int level = 0) const;
+        uint8_t* getPixels(int level = 0);
+        void buildMips();
+        std::shared_ptr<const FileBuffer> getBytes() const;
+        size_t getByteSize() const;
+    protected:
+    private:
+        std::shared_ptr<const FileBuffer> bytes;
+        char* writable = NULL;          ///< Start of bytes while they are filled in, NULL for cached frames.
+        Header header;
+        size_t offsets[MAX_LEVELS];     ///< Start of each level in bytes.
+
+        static size_t layout(const Header& header, size_t offsets[]);
+        static void downsample(const uint8_t* src, int width, int height, int channels, uint8_t* dst);
+        static void boxSpans(int size, int targetSize, std::vector<int>& starts);
+};
+
+#endif // CAMERAFRAME_H
@@ -1,5 +1,7 @@
 #include "CloudPoints.h"
 
+const size_t CloudPoints::ALIGNMENT;
+
 CloudPoints::CloudPoints(const char *filename)
 {
     loadData(filename);
@@ -10,13 +12,119 @@ CloudPoints::CloudPoints(std::string filename)
     loadData(filename.c_str());
 }
 
+/**
+\brief Decode a sweep from file content already in memory.
+
+\param bytes - content of the sweep file.
+\param size - number of bytes.
+\param isText - true for sweeps stored as text, false for binary float arrays. Sweeps encoded
+by PointCodec are recognized either way.
+\param filter - drops points before vertices are computed, NULL to keep every point.
+*/
+
+CloudPoints::CloudPoints(const char* bytes, size_t size, bool isText, std::shared_ptr<const PointFilter> filter)
+    : filter(filter)
+{
+    if (PointCodec::isEncoded(bytes, size))
+    {
+        allocate(PointCodec::getNumPoints(bytes, size));
+        if (!PointCodec::decode(bytes, size, columns))
+        {
+            std::cout << " Error, Corrupt encoded sweep\n";
+            exit(1);
+        }
+        transform();
+        return;
+    }
+
+    if (isText)
+    {
+        std::string text(bytes, size);
+        std::vector<float> points;
+        parseTextData(text.c_str(), points);
+        setPoints(points.empty() ? NULL : &points[0], points.size() / NUM_CHANNELS);
+        return;
+    }
+
+    // Binary sweeps are split into columns straight from the file bytes, which need not be aligned.
+    setPoints((const float*)bytes, size / (NUM_CHANNELS * sizeof(float)));
+}
+
 CloudPoints::~CloudPoints()
 {
     //dtor
 }
 
+/**
+\brief Allocate columns and vertices of a sweep.
+
+\param count - number of points.
+*/
+
+void CloudPoints::allocate(size_t count)
+{
+    const size_t floatsPerLine = ALIGNMENT / sizeof(float);
+    size_t stride = (count + floatsPerLine - 1) / floatsPerLine * floatsPerLine;
+
+    numPoints = count;
+    buffer = FileBuffer::allocate((stride * NUM_CHANNELS + count * 4) * sizeof(float), ALIGNMENT);
+    float* data = (float*)buffer->getData();
+    for (int c = 0; c < NUM_CHANNELS; c++)
+        columns[c] = data + c * stride;
+    vertices = data + NUM_CHANNELS * stride;
+}
+
+/**
+\brief Take points from interleaved floats, as stored in KITTI files.
+
+\param points - four floats x, y, z, reflectance per point.
+\param count - number of points.
+*/
+
+void CloudPoints::setPoints(const float* points, size_t count)
+{
+    allocate(count);
+    PointTransform::split(points, count, columns[X], columns[Y], columns[Z], columns[REFLECTANCE]);
+    transform();
+}
+
+/**
+\brief Filter the columns, then compute vertices in render frame from them. When points are
+dropped the columns move to a buffer of the smaller size, so cached sweeps hold no slack.
+*/
+
+void CloudPoints::transform()
+{
+    if (filter && filter->isActive())
+    {
+        size_t count = filter->apply(columns, numPoints);
+        if (count < numPoints)
+        {
+            std::shared_ptr<FileBuffer> unfiltered = buffer;
+            float* from[NUM_CHANNELS];
+            memcpy(from, columns, sizeof(columns));
+
+            allocate(count);
+            for (int c = 0; c < NUM_CHANNELS; c++)
+                memcpy(columns[c], from[c], count * sizeof(float));
+        }
+    }
+
+    PointTransform::transform(columns[X], columns[Y], columns[Z], numPoints, PointTransform::SENSOR_TO_RENDER, vertices);
+}
+
 void CloudPoints::loadData(const char *filename)
 {
+    // Unsynced "extract" drives store sweeps as text.
+    std::string name(filename);
+    if (name.size() > 4 && name.compare(name.size() - 4, 4, ".txt") == 0)
+    {
+        std::vector<float> points;
+        loadTextData(filename, points);
+        setPoints(points.empty() ? NULL : &points[0], points.size() / NUM_CHANNELS);
+        return;
+    }
+
     std::ifstream fin(filename, std::ios::binary);
     if(!fin)
     {
@@ -29,22 +137,134 @@ void CloudPoints::loadData(const char *filename)
     fin.seekg(0, std::ios::beg);
 
     std::vector<float> mdata(num_elements);
-    fin.read(reinterpret_cast<char*>(&mdata[0]), num_elements*sizeof(float));
+    fin.read(reinterpret_cast<char*>(mdata.data()), num_elements*sizeof(float));
 
-    data = mdata;
+    setPoints(mdata.data(), num_elements / NUM_CHANNELS);
 }
 
-std::vector<float> CloudPoints::getData()
+/**
+\brief Load a sweep stored as one "x y z reflectance" line per point.
+
+\param filename - name of the text file.
+\param points - receives four floats per point.
+*/
+
+void CloudPoints::loadTextData(const char *filename, std::vector<float>& points)
 {
-    return data;
+    FILE* fin = fopen(filename, "r");
+    if (!fin)
+    {
+        std::cout << " Error, Couldn't find file: " << filename << "\n";
+        exit(1);
+    }
+
+    float x, y, z, r;
+    while (fscanf(fin, "%f %f %f %f", &x, &y, &z, &r) == 4)
+    {
+        points.push_back(x);
+        points.push_back(y);
+        points.push_back(z);
+        points.push_back(r);
+    }
+    fclose(fin);
 }
 
-float* CloudPoints::getArrayData()
+/**
+\brief Parse a sweep stored as one "x y z reflectance" line per point.
+
+\param text - null terminated content of the text file.
+\param points - receives four floats per point.
+*/
+
+void CloudPoints::parseTextData(const char *text, std::vector<float>& points)
 {
-    float arr[data.size()];
-    for (int i = 0; i < data.size(); i++)
+    const char* cursor = text;
+    while (true)
     {
-        arr[i] = data[i];
+        float values[4];
+        for (int i = 0; i < 4; i++)
+        {
+            char* end;
+            values[i] = strtof(cursor, &end);
+            if (end == cursor)
+                return;
+            cursor = end;
+        }
+        points.insert(points.end(), values, values + 4);
     }
-    return arr;
+}
+
+/**
+\brief Get one column of the points in velodyne frame, getNumPoints floats.
+
+\param channel - X, Y, Z or REFLECTANCE.
+*/
+
+const float* CloudPoints::getColumn(int channel) const
+{
+    return columns[channel];
+}
+
+/**
+\brief Get all columns of the points, indexed by Channel.
+*/
+
+const float* const* CloudPoints::getColumns() const
+{
+    return columns;
+}
+
+/**
+\brief Get vertices in render frame, four floats x, y, z, 1 per point, ready for upload. The
+view is valid as long as this object lives.
+*/
+
+ArrayView<float> CloudPoints::getVertices() const
+{
+    return ArrayView<float>(vertices, numPoints * 4);
+}
+
+/**
+\brief Get number of points in sweep.
+*/
+
+size_t CloudPoints::getNumPoints() const
+{
+    return numPoints;
+}
+
+/**
+\brief Get memory held by the points.
+*/
+
+size_t CloudPoints::getByteSize() const
+{
+    return buffer->getSize();
+}
+
+/**
+\brief Get filter the points were trimmed by, NULL if none.
+*/
+
+std::shared_ptr<const PointFilter> CloudPoints::getFilter() const
+{
+    return filter;
+}
+
+/**
+\brief Set frame of the drive the sweep belongs to, before it is shared.
+*/
+
+void CloudPoints::setFrameID(int id)
+{
+    frameId = id;
+}
+
+/**
+\brief Get frame of the drive the sweep belongs to, -1 if unknown.
+*/
+
+int CloudPoints::getFrameID() const
+{
+    return frameId;
 }
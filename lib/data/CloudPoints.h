@@ -7,21 +7,73 @@
 #include <string>
 #include <fstream>
 #include <vector>
+#include <memory>
+#include <cstring>
+#include <cstdlib>
+
+#include "../utils/ArrayView.h"
+#include "../utils/FileBuffer.h"
+#include "../utils/PointTransform.h"
+#include "PointCodec.h"
+#include "PointFilter.h"
+
+/**
+\class CloudPoints
+
+\brief Velodyne sweep, decoded on a loader thread into the form the render thread uploads
+as is.
+
+Points are held as aligned columns x, y, z and reflectance in the velodyne frame, followed by
+one vertex x, y, z, 1 per point in the render frame. Both live in one buffer, each column and
+the vertices start at an ALIGNMENT boundary. Points dropped by a PointFilter are removed
+before vertices are computed.
+
+*/
 
 class CloudPoints
 {
     public:
+        enum Channel
+        {
+            X,
+            Y,
+            Z,
+            REFLECTANCE,
+            NUM_CHANNELS
+        };
+
+        static const size_t ALIGNMENT = 64;     ///< Columns start at cache lines, enough for any SIMD load.
+
         CloudPoints(const char *filename);
         CloudPoints(std::string filename);
+        CloudPoints(const char* bytes, size_t size, bool isText, std::shared_ptr<const PointFilter> filter = NULL);
         ~CloudPoints();
 
-        float* getArrayData();
-        std::vector<float> getData();
+        const float* getColumn(int channel) const;
+        const float* const* getColumns() const;
+        ArrayView<float> getVertices() const;
+        size_t getNumPoints() const;
+        size_t getByteSize() const;
+        std::shared_ptr<const PointFilter> getFilter() const;
+        void setFrameID(int id);
+        int getFrameID() const;
     protected:
 
     private:
-        std::vector<float> data;
+        std::shared_ptr<FileBuffer> buffer;
+        size_t numPoints = 0;
+        float* columns[NUM_CHANNELS];
+        float* vertices = NULL;
+        std::shared_ptr<const PointFilter> filter;     ///< Filter points were trimmed by, NULL if none.
+        int frameId = -1;                              ///< Frame of the drive the sweep belongs to, -1 if unknown.
+
+        void allocate(size_t count);
+        void setPoints(const float* points, size_t count);
+        void transform();
+
         void loadData(const char *filename);
+        void loadTextData(const char *filename, std::vector<float>& points);
+        void parseTextData(const char *text, std::vector<float>& points);
 
 };
 
@@ -0,0 +1,94 @@
+#include "FrameBundle.h"
+
+FrameBundle::FrameBundle(int id, int gen) : frameId(id), generation(gen)
+{
+    //ctor
+}
+
+FrameBundle::~FrameBundle()
+{
+    //dtor
+}
+
+/**
+\brief Get id of the frame this bundle holds.
+*/
+
+int FrameBundle::getFrameID() const
+{
+    return frameId;
+}
+
+/**
+\brief Get seek generation of this bundle. Bundles from an older generation are stale.
+*/
+
+int FrameBundle::getGeneration() const
+{
+    return generation;
+}
+
+/**
+\brief Check if every sensor slot is filled.
+
+\return True if bundle is ready to be published.
+*/
+
+bool FrameBundle::isComplete() const
+{
+    return cloudpoints && boxes && images && oxt;
+}
+
+void FrameBundle::setCloudPoints(std::shared_ptr<const CloudPoints> data)
+{
+    cloudpoints = data;
+}
+
+void FrameBundle::setBoxList(std::shared_ptr<const BoxList> data)
+{
+    boxes = data;
+}
+
+void FrameBundle::setImageData(std::shared_ptr<const ImageData> data)
+{
+    images = data;
+}
+
+void FrameBundle::setOXT(std::shared_ptr<const OXT> data)
+{
+    oxt = data;
+}
+
+std::shared_ptr<const CloudPoints> FrameBundle::getCloudPoints() const
+{
+    return cloudpoints;
+}
+
+std::shared_ptr<const BoxList> FrameBundle::getBoxList() const
+{
+    return boxes;
+}
+
+std::shared_ptr<const ImageData> FrameBundle::getImageData() const
+{
+    return images;
+}
+
+std::shared_ptr<const OXT> FrameBundle::getOXT() const
+{
+    return oxt;
+}
+
+/**
+\brief Get memory held by the sensor data of this bundle.
+*/
+
+size_t FrameBundle::getByteSize() const
+{
+    size_t bytes = sizeof(FrameBundle);
+    if (cloudpoints)
+        bytes += cloudpoints->getByteSize();
+    if (images)
+        bytes += images->getByteSize();
+    return bytes;
+}
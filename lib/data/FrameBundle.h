@@ -0,0 +1,51 @@
+#ifndef FRAMEBUNDLE_H
+#define FRAMEBUNDLE_H
+
+#include <memory>
+
+#include "../data/OXT.h"
+#include "../data/BoxList.h"
+#include "../data/CloudPoints.h"
+#include "../data/ImageData.h"
+
+/**
+\class FrameBundle
+
+\brief All sensor data of a single frame. Slots are filled in parallel by loader threads
+and the bundle is only published once every slot is set, so observers always receive
+lidar, camera, tracklets and OXT from the same frame id.
+
+*/
+
+class FrameBundle
+{
+    public:
+        FrameBundle(int frameId = -1, int generation = 0);
+        ~FrameBundle();
+
+        int getFrameID() const;
+        int getGeneration() const;
+        bool isComplete() const;
+        size_t getByteSize() const;
+
+        void setCloudPoints(std::shared_ptr<const CloudPoints> data);
+        void setBoxList(std::shared_ptr<const BoxList> data);
+        void setImageData(std::shared_ptr<const ImageData> data);
+        void setOXT(std::shared_ptr<const OXT> data);
+
+        std::shared_ptr<const CloudPoints> getCloudPoints() const;
+        std::shared_ptr<const BoxList> getBoxList() const;
+        std::shared_ptr<const ImageData> getImageData() const;
+        std::shared_ptr<const OXT> getOXT() const;
+    protected:
+    private:
+        int frameId;                                ///< Index of the frame in the drive.
+        int generation;                             ///< Seek generation the bundle was requested in.
+
+        std::shared_ptr<const CloudPoints> cloudpoints;     ///< Velodyne sweep.
+        std::shared_ptr<const BoxList> boxes;               ///< Tracklet bounding boxes.
+        std::shared_ptr<const ImageData> images;            ///< Camera images.
+        std::shared_ptr<const OXT> oxt;                     ///< GPS/IMU record.
+};
+
+#endif // FRAMEBUNDLE_H
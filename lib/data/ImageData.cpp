@@ -12,16 +12,189 @@ ImageData::ImageData(std::vector<std::string> filenames)
             std::cerr << "Could not load texture." << std::endl;
             exit(EXIT_FAILURE);
         }
-        data.push_back(texture);
+        data.push_back(std::make_shared<CameraFrame>(texture.getPixelsPtr(), texture.getSize().x, texture.getSize().y));
     }
 }
 
+/**
+\brief Decode images from file contents already in memory. Frames from the camera cache are
+used as they are, PNGs in the layout of KITTI cameras are decoded by PngDecoder and other
+images by SFML.
+
+Images larger than the view they are shown in are shrunk to it, a PNG is then decoded into
+scratch memory and only the shrunk frame is kept.
+
+\param files - content of each image or cached frame, NULL for cameras not loaded.
+\param viewWidth - width of the view in pixels, 0 for full resolution.
+\param viewHeight - height of the view in pixels, 0 for full resolution.
+\param decoded - if not NULL, receives the full resolution frame of each image decoded from
+an image file, NULL for cached frames.
+*/
+
+ImageData::ImageData(const std::vector<std::shared_ptr<const FileBuffer> >& files, int viewWidth, int viewHeight,
+                     std::vector<std::shared_ptr<const CameraFrame> >* decoded) : viewWidth(viewWidth), viewHeight(viewHeight)
+{
+    for (int i = 0; i < files.size(); i++)
+    {
+        // Cameras that are not shown have no file, their slot stays empty.
+        if (!files[i])
+        {
+            data.push_back(NULL);
+            if (decoded)
+                decoded->push_back(NULL);
+            continue;
+        }
+
+        std::shared_ptr<const CameraFrame> full;
+        bool isCached = CameraFrame::isEncoded(files[i]->getData(), files[i]->getSize());
+        if (isCached)
+        {
+            full = std::make_shared<CameraFrame>(files[i]);
+            data.push_back(fit(full));
+            if (decoded)
+                decoded->push_back(NULL);
+            continue;
+        }
+
+        PngDecoder::Info info;
+        if (PngDecoder::readInfo(files[i]->getData(), files[i]->getSize(), info))
+        {
+            // The full frame is only built when the camera cache wants it.
+            std::shared_ptr<const CameraFrame> frame = decodePng(*files[i], info, decoded != NULL);
+            if (frame)
+            {
+                data.push_back(decoded ? fit(frame) : frame);
+                if (decoded)
+                    decoded->push_back(frame);
+                continue;
+            }
+        }
+
+        sf::Image texture;
+        bool texloaded = !files[i]->isEmpty() && texture.loadFromMemory(files[i]->getData(), files[i]->getSize());
+
+        if (!texloaded)
+        {
+            std::cerr << "Could not load texture." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        full = std::make_shared<CameraFrame>(texture.getPixelsPtr(), texture.getSize().x, texture.getSize().y);
+        data.push_back(fit(full));
+        if (decoded)
+            decoded->push_back(full);
+    }
+}
+
+/**
+\brief Get size an image is shown at, its own size capped by the view size on each axis.
+*/
+
+void ImageData::getTargetSize(int width, int height, int& targetWidth, int& targetHeight) const
+{
+    targetWidth = viewWidth > 0 ? std::min(width, viewWidth) : width;
+    targetHeight = viewHeight > 0 ? std::min(height, viewHeight) : height;
+}
+
+/**
+\brief Shrink a full resolution frame to the view, starting from the smallest mip level that
+still covers it.
+
+\param frame - full resolution frame.
+\return frame itself if it is not larger than the view.
+*/
+
+std::shared_ptr<const CameraFrame> ImageData::fit(const std::shared_ptr<const CameraFrame>& frame) const
+{
+    int targetWidth, targetHeight;
+    getTargetSize(frame->getWidth(), frame->getHeight(), targetWidth, targetHeight);
+    if (targetWidth == frame->getWidth() && targetHeight == frame->getHeight())
+        return frame;
+
+    int level = 0;
+    while (level + 1 < frame->getNumLevels() && frame->getWidth(level + 1) >= targetWidth && frame->getHeight(level + 1) >= targetHeight)
+        level++;
+    return std::make_shared<CameraFrame>(frame->getPixels(level), frame->getWidth(level), frame->getHeight(level),
+                                         frame->getChannels(), targetWidth, targetHeight);
+}
+
+/**
+\brief Decode a PNG in its native channel count, into a pooled frame.
+
+\param file - content of the image file.
+\param info - result of PngDecoder::readInfo on the file.
+\param isFull - decode at full resolution regardless of the view size.
+\return NULL if the file is corrupt.
+*/
+
+std::shared_ptr<const CameraFrame> ImageData::decodePng(const FileBuffer& file, const PngDecoder::Info& info, bool isFull) const
+{
+    int targetWidth, targetHeight;
+    getTargetSize(info.width, info.height, targetWidth, targetHeight);
+    if (isFull || (targetWidth == info.width && targetHeight == info.height))
+    {
+        std::shared_ptr<CameraFrame> frame = std::make_shared<CameraFrame>(info.width, info.height, info.channels);
+        if (!PngDecoder::decode(file.getData(), file.getSize(), info, frame->getPixels()))
+            return NULL;
+        frame->buildMips();
+        return frame;
+    }
+
+    // Full resolution pixels are only needed until the frame is shrunk, they stay per thread.
+    thread_local std::vector<uint8_t> pixels;
+    pixels.resize((size_t)info.width * info.height * info.channels);
+    if (!PngDecoder::decode(file.getData(), file.getSize(), info, pixels.data()))
+        return NULL;
+    return std::make_shared<CameraFrame>(pixels.data(), info.width, info.height, info.channels, targetWidth, targetHeight);
+}
+
+/**
+\brief Check if frames were decoded for a view size.
+
+\param width - width of the view, 0 for full resolution.
+\param height - height of the view, 0 for full resolution.
+*/
+
+bool ImageData::isViewSize(int width, int height) const
+{
+    return viewWidth == width && viewHeight == height;
+}
+
 ImageData::~ImageData()
 {
     //dtor
 }
 
-std::vector<sf::Image> ImageData::getData() const
+const std::vector<std::shared_ptr<const CameraFrame> >& ImageData::getData() const
 {
     return data;
 }
+
+/**
+\brief Get memory held by the frames, mip levels included.
+*/
+
+size_t ImageData::getByteSize() const
+{
+    size_t bytes = 0;
+    for (int i = 0; i < data.size(); i++)
+    {
+        if (data[i])
+            bytes += data[i]->getByteSize();
+    }
+    return bytes;
+}
+
+/**
+\brief Get cameras holding a frame, bit i is set if getData()[i] is not NULL.
+*/
+
+uint32_t ImageData::getCameraMask() const
+{
+    uint32_t mask = 0;
+    for (int i = 0; i < data.size(); i++)
+    {
+        if (data[i])
+            mask |= 1 << i;
+    }
+    return mask;
+}
@@ -10,18 +10,35 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <memory>
+#include <algorithm>
+
+#include "../utils/FileBuffer.h"
+#include "../utils/PngDecoder.h"
+#include "CameraFrame.h"
 
 class ImageData
 {
     public:
         ImageData(std::vector<std::string> filenames);
+        ImageData(const std::vector<std::shared_ptr<const FileBuffer> >& files, int viewWidth = 0, int viewHeight = 0,
+                  std::vector<std::shared_ptr<const CameraFrame> >* decoded = NULL);
         ~ImageData();
 
-        std::vector<sf::Image> getData() const;
+        const std::vector<std::shared_ptr<const CameraFrame> >& getData() const;
+        size_t getByteSize() const;
+        bool isViewSize(int width, int height) const;
+        uint32_t getCameraMask() const;
     protected:
 
     private:
-      std::vector<sf::Image> data;
+      std::vector<std::shared_ptr<const CameraFrame> > data;
+      int viewWidth = 0;        ///< Largest size frames were decoded for, 0 for full resolution.
+      int viewHeight = 0;
+
+      void getTargetSize(int width, int height, int& targetWidth, int& targetHeight) const;
+      std::shared_ptr<const CameraFrame> fit(const std::shared_ptr<const CameraFrame>& frame) const;
+      std::shared_ptr<const CameraFrame> decodePng(const FileBuffer& file, const PngDecoder::Info& info, bool isFull) const;
 };
 
 #endif // IMAGEDATA_H
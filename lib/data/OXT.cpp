@@ -1,41 +1,63 @@
 #include "OXT.h"
-#include <sstream>
-#include <string>
-#include <fstream>
-
-OXT::OXT(std::string filename)
-{
-    std::ifstream infile(filename);
-    if(!infile.is_open())
-    {
-        std::cout << " could not open file" << filename << std::endl;
-        std::cout << " program terminating....\n";
-        exit(EXIT_FAILURE);
-    }
-
-    // Read these as float then cast to int later because of errors in KITTI data 
-    float mnavstat, mnumsats, mposmode, mvelmode, morimode;
-
-    std::string line;
-    while (std::getline(infile, line))
-    {
-        std::istringstream iss(line);
-        char objectType[10];
-        if (!(iss >>lat >> lon >> alt >> roll >> pitch >> yaw >> vn >> ve >> vf >> vl >> vu >> ax >> ay >> ay >> af >> al >> au >> wx >> wy >> wz >> wf >> wl >> wu >> pos_accuracy >> vel_accuracy >> mnavstat >> mnumsats >> mposmode >> mvelmode >> morimode)) 
-        {
-            printf("Error occurs when parsing: %s\n", filename.c_str());
-            exit(1); 
-        }
-
-        navstat = morimode;
-        numsats = mnumsats;
-        posmode = mposmode;
-        velmode = mvelmode;
-        orimode = morimode;
-    }
+
+/**
+\brief Refer to a record of a table, without copying it.
+
+\param table - records of the drive.
+\param record - row of the record.
+*/
+
+OXT::OXT(std::shared_ptr<const OXTTable> table, int record) : table(table), record(record)
+{
 }
 
 OXT::~OXT()
 {
     //dtor
 }
+
+int OXT::getRecord() const
+{
+    return record;
+}
+
+double OXT::get(OXTTable::Field field) const
+{
+    return table->get(field, record);
+}
+
+/**
+\brief Get speed of vehicle in m/s.
+*/
+
+float OXT::getSpeed() const
+{
+    return table->getSpeed(record);
+}
+
+/**
+\brief Get acceleration forward, left and up in m/s^2.
+*/
+
+glm::vec3 OXT::getAcceleration() const
+{
+    return table->getAcceleration(record);
+}
+
+/**
+\brief Get pose of vehicle relative to the first record of the drive.
+*/
+
+const glm::mat4& OXT::getPose() const
+{
+    return table->getPose(record);
+}
+
+/**
+\brief Get pose of the velodyne relative to the first record of the drive.
+*/
+
+glm::mat4 OXT::getVelodynePose() const
+{
+    return table->getVelodynePose(record);
+}
@@ -3,18 +3,35 @@
 
 #include <iostream>
 #include <string>
+#include <memory>
+#include <glm/glm.hpp>
+
+#include "OXTTable.h"
+
+/**
+\class OXT
+
+\brief GPS/IMU record of a frame, a row of the drive's OXTTable.
+
+*/
 
 class OXT
 {
     public:
-        OXT(std::string filename);
+        OXT(std::shared_ptr<const OXTTable> table, int record);
         ~OXT();
 
-        float lat, lon, alt, roll, pitch, yaw, vn, ve, vf, vl, vu, ax, ay, af, al, au, wx, wy, wz, wf, wl, wu, pos_accuracy, vel_accuracy;
-        int navstat, numsats, posmode, velmode, orimode;
+        int getRecord() const;
+        double get(OXTTable::Field field) const;
+        float getSpeed() const;
+        glm::vec3 getAcceleration() const;
+        const glm::mat4& getPose() const;
+        glm::mat4 getVelodynePose() const;
     protected:
 
     private:
+        std::shared_ptr<const OXTTable> table;
+        int record;         ///< Row of table.
 };
 
 #endif // OXT_H
@@ -0,0 +1,176 @@
+#include "OXTTable.h"
+
+constexpr double OXTTable::EARTH_RADIUS;
+
+// From calib_imu_to_velo.txt of 2011_09_26, inverted. Other dates differ by millimeters. glm
+// takes columns one after another.
+const glm::mat4 OXTTable::VELODYNE_TO_IMU = glm::inverse(glm::mat4(
+    9.999976e-01f, -7.854027e-04f, 2.024406e-03f, 0.0f,
+    7.553071e-04f, 9.998898e-01f, 1.482454e-02f, 0.0f,
+    -2.035826e-03f, -1.482298e-02f, 9.998881e-01f, 0.0f,
+    -8.086759e-01f, 3.195559e-01f, -7.997231e-01f, 1.0f));
+
+/**
+\brief Parse all records of a drive.
+
+\param records - content of each oxts data file, in record order.
+\param name - source of the records, for error messages.
+*/
+
+OXTTable::OXTTable(const std::vector<std::shared_ptr<const FileBuffer> >& records, std::string name)
+{
+    for (int i = 0; i < NUM_FIELDS; i++)
+        columns[i].reserve(records.size());
+    for (size_t i = 0; i < records.size(); i++)
+        parse(records[i]->getData(), records[i]->getSize(), name);
+    computePoses();
+}
+
+OXTTable::~OXTTable()
+{
+    //dtor
+}
+
+int OXTTable::getNumRecords() const
+{
+    return poses.size();
+}
+
+double OXTTable::get(Field field, int record) const
+{
+    return columns[field][record];
+}
+
+/**
+\brief Get view of a field of every record. The view is valid as long as this object lives.
+*/
+
+ArrayView<double> OXTTable::getColumn(Field field) const
+{
+    return ArrayView<double>(columns[field]);
+}
+
+/**
+\brief Get speed of vehicle in m/s.
+*/
+
+float OXTTable::getSpeed(int record) const
+{
+    double vf = columns[VF][record];
+    double vl = columns[VL][record];
+    double vu = columns[VU][record];
+    return sqrt(vf * vf + vl * vl + vu * vu);
+}
+
+/**
+\brief Get acceleration forward, left and up in m/s^2.
+*/
+
+glm::vec3 OXTTable::getAcceleration(int record) const
+{
+    return glm::vec3(columns[AF][record], columns[AL][record], columns[AU][record]);
+}
+
+/**
+\brief Get pose of vehicle relative to the first record.
+*/
+
+const glm::mat4& OXTTable::getPose(int record) const
+{
+    return poses[record];
+}
+
+/**
+\brief Get pose of the velodyne relative to the first record, mapping points of a sweep into
+the world frame of the drive.
+*/
+
+glm::mat4 OXTTable::getVelodynePose(int record) const
+{
+    return poses[record] * VELODYNE_TO_IMU;
+}
+
+/**
+\brief Parse one record of NUM_FIELDS space separated values.
+
+\param text - content of an oxts data file, not null terminated.
+\param size - number of bytes.
+\param name - source of the record, for error messages.
+*/
+
+void OXTTable::parse(const char* text, size_t size, const std::string& name)
+{
+    const char* cursor = text;
+    const char* end = text + size;
+    for (int i = 0; i < NUM_FIELDS; i++)
+    {
+        double value;
+        if (!FastFloat::parse(cursor, end, value))
+        {
+            printf("Error occurs when parsing record %d of %s\n", (int)columns[0].size(), name.c_str());
+            exit(1);
+        }
+        columns[i].push_back(value);
+    }
+}
+
+/**
+\brief Compute pose of every record, following convertOxtsToPose of the KITTI devkit.
+Projection and the relative transform are done in double, so poses stay precise far from
+the first record.
+*/
+
+void OXTTable::computePoses()
+{
+    int numRecords = columns[LAT].size();
+    poses.resize(numRecords);
+    if (numRecords == 0)
+        return;
+
+    double scale = cos(columns[LAT][0] * M_PI / 180);
+    double origin[3];
+    double originRotation[3][3];
+    for (int i = 0; i < numRecords; i++)
+    {
+        double t[3] = {
+            scale * columns[LON][i] * M_PI * EARTH_RADIUS / 180,
+            scale * EARTH_RADIUS * log(tan((90 + columns[LAT][i]) * M_PI / 360)),
+            columns[ALT][i]
+        };
+
+        // R = Rz(yaw) * Ry(pitch) * Rx(roll)
+        double cr = cos(columns[ROLL][i]), sr = sin(columns[ROLL][i]);
+        double cp = cos(columns[PITCH][i]), sp = sin(columns[PITCH][i]);
+        double cy = cos(columns[YAW][i]), sy = sin(columns[YAW][i]);
+        double r[3][3] = {
+            {cy * cp, cy * sp * sr - sy * cr, cy * sp * cr + sy * sr},
+            {sy * cp, sy * sp * sr + cy * cr, sy * sp * cr - cy * sr},
+            {-sp, cp * sr, cp * cr}
+        };
+
+        if (i == 0)
+        {
+            memcpy(origin, t, sizeof(origin));
+            memcpy(originRotation, r, sizeof(originRotation));
+        }
+
+        // Relative pose is inverse(first) * current: R0^T * R and R0^T * (t - t0).
+        glm::mat4& pose = poses[i];
+        pose = glm::mat4(1.0);
+        for (int row = 0; row < 3; row++)
+        {
+            for (int col = 0; col < 3; col++)
+            {
+                double sum = 0;
+                for (int k = 0; k < 3; k++)
+                    sum += originRotation[k][row] * r[k][col];
+                pose[col][row] = sum;
+            }
+
+            double sum = 0;
+            for (int k = 0; k < 3; k++)
+                sum += originRotation[k][row] * (t[k] - origin[k]);
+            pose[3][row] = sum;
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef OXTTABLE_H
+#define OXTTABLE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <glm/glm.hpp>
+
+#include "../utils/ArrayView.h"
+#include "../utils/FileBuffer.h"
+#include "../utils/FastFloat.h"
+
+/**
+\class OXTTable
+
+\brief Every GPS/IMU record of a drive, parsed once when the drive is opened.
+
+Each field is one column indexed by record. The ego pose of every record is computed up front
+the way the KITTI devkit does it: position projected with Mercator scaled at the first
+record, orientation from roll, pitch and yaw. Poses are in the IMU frame of the first record:
+x forward, y left, z up at the start of the drive.
+
+*/
+
+class OXTTable
+{
+    public:
+        enum Field
+        {
+            LAT, LON, ALT,                  ///< Degrees, degrees, meters.
+            ROLL, PITCH, YAW,               ///< Radians.
+            VN, VE,                         ///< Velocity north, east, m/s.
+            VF, VL, VU,                     ///< Velocity forward, left, up, m/s.
+            AX, AY, AZ,                     ///< Acceleration in vehicle frame, m/s^2.
+            AF, AL, AU,                     ///< Acceleration forward, left, up, m/s^2.
+            WX, WY, WZ,                     ///< Angular rate in vehicle frame, rad/s.
+            WF, WL, WU,                     ///< Angular rate forward, left, up, rad/s.
+            POS_ACCURACY, VEL_ACCURACY,
+            NAVSTAT, NUMSATS, POSMODE, VELMODE, ORIMODE,
+            NUM_FIELDS
+        };
+
+        static constexpr double EARTH_RADIUS = 6378137;     ///< Meters, used by Mercator projection.
+        static const glm::mat4 VELODYNE_TO_IMU;             ///< Velodyne mount on the vehicle.
+
+        OXTTable(const std::vector<std::shared_ptr<const FileBuffer> >& records, std::string name);
+        ~OXTTable();
+
+        int getNumRecords() const;
+        double get(Field field, int record) const;
+        ArrayView<double> getColumn(Field field) const;
+
+        float getSpeed(int record) const;
+        glm::vec3 getAcceleration(int record) const;
+        const glm::mat4& getPose(int record) const;
+        glm::mat4 getVelodynePose(int record) const;
+    protected:
+    private:
+        std::vector<double> columns[NUM_FIELDS];
+        std::vector<glm::mat4> poses;
+
+        void parse(const char* text, size_t size, const std::string& name);
+        void computePoses();
+};
+
+#endif // OXTTABLE_H
@@ -0,0 +1,183 @@
+#include "PointCodec.h"
+
+const char PointCodec::MAGIC[4] = {'K', 'V', 'P', 'C'};
+const uint32_t PointCodec::VERSION;
+const int PointCodec::NUM_CHANNELS;
+constexpr float PointCodec::REFLECTANCE_ERROR;
+constexpr float PointCodec::STEP_SCALE;
+const int32_t PointCodec::MAX_GRID_INDEX;
+
+/**
+\brief Check if bytes hold an encoded sweep rather than raw floats or text. Besides the magic
+the stream sizes must add up to the size, so raw floats are practically never mistaken for it.
+
+\param bytes - content of a sweep.
+\param size - number of bytes.
+*/
+
+bool PointCodec::isEncoded(const char* bytes, size_t size)
+{
+    if (size < sizeof(Header) || memcmp(bytes, MAGIC, sizeof(MAGIC)) != 0)
+        return false;
+
+    Header header;
+    memcpy(&header, bytes, sizeof(header));
+    uint64_t total = sizeof(header);
+    for (int c = 0; c < NUM_CHANNELS; c++)
+        total += header.streamSizes[c];
+    return header.version == VERSION && total == size;
+}
+
+/**
+\brief Get number of points of an encoded sweep.
+
+\param bytes - sweep recognized by isEncoded.
+\param size - number of bytes.
+*/
+
+size_t PointCodec::getNumPoints(const char* bytes, size_t size)
+{
+    Header header;
+    memcpy(&header, bytes, sizeof(header));
+    return header.numPoints;
+}
+
+/**
+\brief Encode a sweep.
+
+\param columns - x, y, z and reflectance of the points, in scan order.
+\param numPoints - number of points.
+\param maxError - largest allowed error of x, y, z in meters, 0 for lossless.
+\param out - receives encoded sweep.
+*/
+
+void PointCodec::encode(const float* const columns[NUM_CHANNELS], size_t numPoints, float maxError, std::vector<char>& out)
+{
+    Header header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.numPoints = numPoints;
+    header.step = maxError > 0 ? maxError * STEP_SCALE : 0;
+    header.reflectanceStep = maxError > 0 ? REFLECTANCE_ERROR * STEP_SCALE : 0;
+
+    // Values off the grid, non finite or too far out, leave the sweep for lossless mode.
+    for (int c = 0; c < NUM_CHANNELS && header.step > 0; c++)
+    {
+        double step = c < 3 ? header.step : header.reflectanceStep;
+        for (size_t i = 0; i < numPoints; i++)
+        {
+            if (!(fabs(columns[c][i] / step) < MAX_GRID_INDEX))
+            {
+                header.step = header.reflectanceStep = 0;
+                break;
+            }
+        }
+    }
+
+    std::vector<uint8_t> streams[NUM_CHANNELS];
+    for (int c = 0; c < NUM_CHANNELS; c++)
+    {
+        double step = c < 3 ? header.step : header.reflectanceStep;
+        std::vector<uint8_t> residuals;
+        residuals.reserve(header.numPoints * 2);
+
+        uint32_t prev = 0;
+        for (uint32_t i = 0; i < header.numPoints; i++)
+        {
+            float value = columns[c][i];
+            uint32_t cur;
+            if (step > 0)
+                cur = (uint32_t)(int32_t)llround(value / step);
+            else
+                memcpy(&cur, &value, 4);
+
+            // Unsigned difference wraps around, so it is exact for any pair of values.
+            putVarint(zigzag((int32_t)(cur - prev)), residuals);
+            prev = cur;
+        }
+
+        RansCoder::encode(residuals, streams[c]);
+        header.streamSizes[c] = streams[c].size();
+    }
+
+    out.assign((char*)&header, (char*)&header + sizeof(header));
+    for (int c = 0; c < NUM_CHANNELS; c++)
+        out.insert(out.end(), streams[c].begin(), streams[c].end());
+}
+
+/**
+\brief Decode a sweep written by encode.
+
+\param bytes - encoded sweep.
+\param size - number of bytes.
+\param columns - receive x, y, z and reflectance, getNumPoints floats each.
+\return false if sweep is corrupt.
+*/
+
+bool PointCodec::decode(const char* bytes, size_t size, float* const columns[NUM_CHANNELS])
+{
+    if (!isEncoded(bytes, size))
+        return false;
+
+    Header header;
+    memcpy(&header, bytes, sizeof(header));
+
+    // Channels are entropy decoded together, which keeps more of the CPU busy than one by one.
+    // A residual takes at most 5 varint bytes.
+    size_t streamSizes[NUM_CHANNELS];
+    for (int c = 0; c < NUM_CHANNELS; c++)
+        streamSizes[c] = header.streamSizes[c];
+    std::vector<uint8_t> residuals[NUM_CHANNELS];
+    if (!RansCoder::decode((const uint8_t*)bytes + sizeof(header), streamSizes, NUM_CHANNELS, (size_t)header.numPoints * 5, residuals))
+        return false;
+
+    for (int c = 0; c < NUM_CHANNELS; c++)
+    {
+        double step = c < 3 ? header.step : header.reflectanceStep;
+        const uint8_t* ptr = residuals[c].data();
+        const uint8_t* last = ptr + residuals[c].size();
+        uint32_t cur = 0;
+        for (uint32_t i = 0; i < header.numPoints; i++)
+        {
+            uint32_t v = 0;
+            for (int shift = 0; ; shift += 7)
+            {
+                if (ptr == last || shift > 28)
+                    return false;
+                uint8_t b = *ptr++;
+                v |= (uint32_t)(b & 0x7f) << shift;
+                if (!(b & 0x80))
+                    break;
+            }
+            cur += (uint32_t)unzigzag(v);
+
+            float value;
+            if (step > 0)
+                value = (int32_t)cur * step;
+            else
+                memcpy(&value, &cur, 4);
+            columns[c][i] = value;
+        }
+    }
+    return true;
+}
+
+uint32_t PointCodec::zigzag(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+int32_t PointCodec::unzigzag(uint32_t v)
+{
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+void PointCodec::putVarint(uint32_t v, std::vector<uint8_t>& out)
+{
+    while (v >= 0x80)
+    {
+        out.push_back((v & 0x7f) | 0x80);
+        v >>= 7;
+    }
+    out.push_back(v);
+}
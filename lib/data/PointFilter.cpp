@@ -0,0 +1,257 @@
+#include "PointFilter.h"
+
+constexpr float PointFilter::MAX_RANGE;
+constexpr float PointFilter::SENSOR_HEIGHT;
+constexpr float PointFilter::CAMERA_FOCAL;
+constexpr float PointFilter::CAMERA_WIDTH;
+constexpr float PointFilter::CAMERA_HEIGHT;
+const int PointFilter::MAX_STRIDE;
+const int PointFilter::MORTON_BITS;
+
+/**
+\brief Constructor.
+
+\param settings - stages to run, values out of range are clamped.
+*/
+
+PointFilter::PointFilter(const Settings& settings) : settings(settings)
+{
+    this->settings.minRange = std::max(this->settings.minRange, 0.0f);
+    this->settings.maxRange = std::max(this->settings.maxRange, 0.0f);
+    this->settings.voxelSize = std::max(this->settings.voxelSize, 0.0f);
+    this->settings.stride = std::min(std::max(this->settings.stride, 1), MAX_STRIDE);
+}
+
+PointFilter::~PointFilter()
+{
+    //dtor
+}
+
+/**
+\brief Get stages of the filter.
+*/
+
+const PointFilter::Settings& PointFilter::getSettings() const
+{
+    return settings;
+}
+
+/**
+\brief Check if any stage may drop or move points.
+*/
+
+bool PointFilter::isActive() const
+{
+    return settings.isProgressive || settings.minRange > 0 || settings.maxRange > 0 || settings.minHeight > -INFINITY ||
+           settings.maxHeight < INFINITY || settings.isCameraView || settings.voxelSize > 0 || settings.stride > 1;
+}
+
+/**
+\brief Drop points of a sweep, moving the ones kept to the front of the columns in the order
+they are drawn in.
+
+\param columns - x, y, z and reflectance in velodyne frame.
+\param numPoints - number of points.
+\return number of points kept.
+*/
+
+size_t PointFilter::apply(float* const columns[4], size_t numPoints) const
+{
+    numPoints = cropPoints(columns, numPoints);
+    if (settings.voxelSize > 0)
+        numPoints = voxelPoints(columns, numPoints);
+    if (settings.stride > 1)
+        numPoints = stridePoints(columns, numPoints);
+    if (settings.isProgressive)
+        orderPoints(columns, numPoints);
+    return numPoints;
+}
+
+/**
+\brief Run range, height and camera view stages in one pass.
+*/
+
+size_t PointFilter::cropPoints(float* const columns[4], size_t numPoints) const
+{
+    const float* x = columns[0];
+    const float* y = columns[1];
+    const float* z = columns[2];
+
+    float minRange2 = settings.minRange * settings.minRange;
+    float maxRange2 = settings.maxRange > 0 ? settings.maxRange * settings.maxRange : INFINITY;
+    float halfWidth = CAMERA_WIDTH / 2 / CAMERA_FOCAL;
+    float halfHeight = CAMERA_HEIGHT / 2 / CAMERA_FOCAL;
+
+    size_t kept = 0;
+    for (size_t i = 0; i < numPoints; i++)
+    {
+        float range2 = x[i] * x[i] + y[i] * y[i];
+        bool isKept = range2 >= minRange2 && range2 <= maxRange2 &&
+                      z[i] >= settings.minHeight && z[i] <= settings.maxHeight;
+        if (settings.isCameraView)
+            isKept = isKept && x[i] > 0 && fabsf(y[i]) <= x[i] * halfWidth && fabsf(z[i]) <= x[i] * halfHeight;
+
+        if (isKept)
+            movePoint(columns, i, kept++);
+    }
+    return kept;
+}
+
+/**
+\brief Keep the first point of each voxel. Voxels are found in an open addressing table of
+packed voxel coordinates, reused by the thread.
+*/
+
+size_t PointFilter::voxelPoints(float* const columns[4], size_t numPoints) const
+{
+    const uint64_t EMPTY = ~(uint64_t)0;
+    thread_local std::vector<uint64_t> table;
+
+    size_t capacity = 1024;
+    while (capacity < numPoints * 2)
+        capacity *= 2;
+    table.assign(capacity, EMPTY);
+    int shift = 64;
+    for (size_t c = capacity; c > 1; c >>= 1)
+        shift--;
+
+    float scale = 1 / settings.voxelSize;
+    size_t kept = 0;
+    for (size_t i = 0; i < numPoints; i++)
+    {
+        // 21 bits per axis cover +-100 km at 10 cm voxels, wrapping further out is harmless.
+        uint64_t key = 0;
+        for (int c = 0; c < 3; c++)
+            key |= ((uint64_t)(int64_t)floorf(columns[c][i] * scale) & 0x1FFFFF) << (c * 21);
+
+        size_t slot = (key * 0x9E3779B97F4A7C15ull) >> shift;
+        while (table[slot] != EMPTY && table[slot] != key)
+            slot = (slot + 1) & (capacity - 1);
+        if (table[slot] == key)
+            continue;
+
+        table[slot] = key;
+        movePoint(columns, i, kept++);
+    }
+    return kept;
+}
+
+/**
+\brief Keep every stride-th point.
+*/
+
+size_t PointFilter::stridePoints(float* const columns[4], size_t numPoints) const
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < numPoints; i += settings.stride)
+        movePoint(columns, i, kept++);
+    return kept;
+}
+
+/**
+\brief Put points in progressive order. Points are radix sorted by Morton code, then rank r of
+the sorted points goes to the position given by reversing the bits of r, skipping reversed
+ranks past the end. Any prefix thus takes evenly spaced points along the curve.
+*/
+
+void PointFilter::orderPoints(float* const columns[4], size_t numPoints) const
+{
+    thread_local std::vector<uint64_t> keys;
+    thread_local std::vector<uint64_t> sortedKeys;
+    thread_local std::vector<uint32_t> order;
+    thread_local std::vector<float> scratch;
+
+    // Code in the high half, index in the low half, so sorting moves both at once.
+    keys.resize(numPoints);
+    sortedKeys.resize(numPoints);
+    for (size_t i = 0; i < numPoints; i++)
+        keys[i] = (uint64_t)getMortonCode(columns[0][i], columns[1][i], columns[2][i]) << 32 | i;
+
+    // Least significant digit first, one axis worth of bits per pass, stable so equal codes keep
+    // scan order.
+    const uint64_t digitMask = (1 << MORTON_BITS) - 1;
+    for (int shift = 32; shift < 32 + 3 * MORTON_BITS; shift += MORTON_BITS)
+    {
+        size_t counts[(1 << MORTON_BITS) + 1] = {0};
+        for (size_t i = 0; i < numPoints; i++)
+            counts[((keys[i] >> shift) & digitMask) + 1]++;
+        for (uint64_t d = 0; d < digitMask; d++)
+            counts[d + 1] += counts[d];
+        for (size_t i = 0; i < numPoints; i++)
+            sortedKeys[counts[(keys[i] >> shift) & digitMask]++] = keys[i];
+        keys.swap(sortedKeys);
+    }
+
+    int bits = 0;
+    while (((size_t)1 << bits) < numPoints)
+        bits++;
+
+    // Reversed ranks are counted up by adding one at the top bit and carrying downwards.
+    order.resize(numPoints);
+    size_t next = 0;
+    size_t reversed = 0;
+    for (size_t r = 0; r < ((size_t)1 << bits); r++)
+    {
+        if (reversed < numPoints)
+            order[next++] = (uint32_t)keys[reversed];
+
+        size_t bit = (size_t)1 << bits >> 1;
+        while (bit > 0 && (reversed & bit))
+        {
+            reversed ^= bit;
+            bit >>= 1;
+        }
+        reversed |= bit;
+    }
+
+    scratch.resize(numPoints);
+    for (int c = 0; c < 4; c++)
+    {
+        for (size_t i = 0; i < numPoints; i++)
+            scratch[i] = columns[c][order[i]];
+        memcpy(columns[c], scratch.data(), numPoints * sizeof(float));
+    }
+}
+
+/**
+\brief Interleave cells of a point within MAX_RANGE into a Morton code, points further out
+fall in the border cells.
+*/
+
+uint32_t PointFilter::getMortonCode(float x, float y, float z)
+{
+    const float cells = 1 << MORTON_BITS;
+    const float scale = cells / (2 * MAX_RANGE);
+    uint32_t code = 0;
+    float v[3] = {x, y, z};
+    for (int c = 0; c < 3; c++)
+    {
+        float cell = (v[c] + MAX_RANGE) * scale;
+        if (!(cell >= 0))
+            cell = 0;
+        else if (cell > cells - 1)
+            cell = cells - 1;
+        code |= spreadBits((uint32_t)cell) << c;
+    }
+    return code;
+}
+
+/**
+\brief Spread the low 10 bits of a value to every third bit.
+*/
+
+uint32_t PointFilter::spreadBits(uint32_t v)
+{
+    v &= 0x3FF;
+    v = (v | (v << 16)) & 0x030000FF;
+    v = (v | (v << 8)) & 0x0300F00F;
+    v = (v | (v << 4)) & 0x030C30C3;
+    v = (v | (v << 2)) & 0x09249249;
+    return v;
+}
+
+void PointFilter::movePoint(float* const columns[4], size_t from, size_t to)
+{
+    for (int c = 0; c < 4; c++)
+        columns[c][to] = columns[c][from];
+}
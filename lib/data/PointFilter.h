@@ -0,0 +1,77 @@
+#ifndef POINTFILTER_H
+#define POINTFILTER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+/**
+\class PointFilter
+
+\brief Trims and orders velodyne sweeps on loader threads, before they are transformed and
+uploaded.
+
+Stages run in this order, each one off unless set in Settings:
+- Range, horizontal distance from the sensor between minRange and maxRange.
+- Height, z of velodyne frame between minHeight and maxHeight. The sensor is SENSOR_HEIGHT above ground.
+- Camera field of view, points in front of the sensor within the view of the KITTI color
+  cameras, ignoring the few centimeters between cameras and sensor.
+- Voxel grid, the first point of each voxel of voxelSize meters is kept.
+- Stride, every stride-th point left is kept.
+- Progressive order, on by default. Points are sorted along a Morton curve, then taken in
+  bit reversed order of their rank, so the first n points of the sweep are spread over the
+  whole curve for any n. Drawing a prefix of the sweep then shows all of it at lower density.
+
+Points keep their scan order unless ordered progressively. Every stage is deterministic, so a
+frame always gives the same points.
+
+*/
+
+class PointFilter
+{
+    public:
+        static constexpr float MAX_RANGE = 80;              ///< Approximation of max distance of points in KITTI velodyne setup.
+        static constexpr float SENSOR_HEIGHT = 1.73;        ///< Height of the velodyne above ground in meters.
+        static constexpr float CAMERA_FOCAL = 721.5;        ///< Focal length of rectified KITTI cameras in pixels.
+        static constexpr float CAMERA_WIDTH = 1242;
+        static constexpr float CAMERA_HEIGHT = 375;
+        static const int MAX_STRIDE = 16;
+        static const int MORTON_BITS = 10;                  ///< Bits per axis of Morton codes, cells of 16 cm within MAX_RANGE.
+
+        struct Settings
+        {
+            float minRange = 0;
+            float maxRange = 0;                 ///< 0 for no limit.
+            float minHeight = -INFINITY;
+            float maxHeight = INFINITY;
+            bool isCameraView = false;
+            float voxelSize = 0;                ///< 0 to keep every voxel.
+            int stride = 1;
+            bool isProgressive = true;
+        };
+
+        PointFilter(const Settings& settings);
+        ~PointFilter();
+
+        const Settings& getSettings() const;
+        bool isActive() const;
+        size_t apply(float* const columns[4], size_t numPoints) const;
+    protected:
+    private:
+        Settings settings;
+
+        size_t cropPoints(float* const columns[4], size_t numPoints) const;
+        size_t voxelPoints(float* const columns[4], size_t numPoints) const;
+        size_t stridePoints(float* const columns[4], size_t numPoints) const;
+        void orderPoints(float* const columns[4], size_t numPoints) const;
+
+        static uint32_t getMortonCode(float x, float y, float z);
+        static uint32_t spreadBits(uint32_t v);
+
+        static void movePoint(float* const columns[4], size_t from, size_t to);
+};
+
+#endif // POINTFILTER_H
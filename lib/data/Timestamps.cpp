@@ -0,0 +1,127 @@
+#include "Timestamps.h"
+
+/**
+\brief Constructor
+
+Loads sample times from a timestamps file. If the file can not be read, samples are
+assumed evenly spaced so playback still works on drives without timestamps.
+
+\param filename - path to timestamps.txt.
+\param numSamples - number of samples to fall back to.
+\param period - sample period in seconds to fall back to.
+*/
+
+Timestamps::Timestamps(std::string filename, int numSamples, double period)
+{
+    std::ifstream infile(filename);
+    std::string line;
+    while (infile.is_open() && std::getline(infile, line))
+    {
+        double seconds;
+        if (!parseLine(line, seconds))
+            continue;
+
+        // Timestamps cross midnight on a few drives.
+        while (!data.empty() && seconds < data.back() - 43200)
+            seconds += 86400;
+        data.push_back(seconds);
+    }
+
+    if (data.empty())
+    {
+        printf("Could not read timestamps: %s, assuming %.0f Hz.\n", filename.c_str(), 1 / period);
+        for (int i = 0; i < numSamples; i++)
+            data.push_back(i * period);
+    }
+}
+
+/**
+\brief Constructor from sample times already parsed, e.g. stored in a drive archive.
+
+\param times - sample times in seconds, ascending.
+*/
+
+Timestamps::Timestamps(const std::vector<double>& times) : data(times)
+{
+    if (data.empty())
+        data.push_back(0);
+}
+
+Timestamps::~Timestamps()
+{
+    //dtor
+}
+
+/**
+\brief Parse a "YYYY-MM-DD HH:MM:SS.fffffffff" line.
+
+\param line - line to parse.
+\param seconds - parsed time of day in seconds.
+\return True on success.
+*/
+
+bool Timestamps::parseLine(const std::string& line, double& seconds)
+{
+    int year, month, day, hour, minute;
+    double second;
+    if (sscanf(line.c_str(), "%d-%d-%d %d:%d:%lf", &year, &month, &day, &hour, &minute, &second) != 6)
+        return false;
+
+    seconds = hour * 3600.0 + minute * 60.0 + second;
+    return true;
+}
+
+int Timestamps::size() const
+{
+    return data.size();
+}
+
+/**
+\brief Get time of a sample.
+
+\param index - sample index, clamped into range.
+*/
+
+double Timestamps::get(int index) const
+{
+    if (index < 0)
+        index = 0;
+    if (index >= (int)data.size())
+        index = data.size() - 1;
+    return data[index];
+}
+
+double Timestamps::getStart() const
+{
+    return data.front();
+}
+
+double Timestamps::getEnd() const
+{
+    return data.back();
+}
+
+/**
+\brief Find sample closest in time.
+
+\param time - time in seconds.
+\return index of nearest sample.
+*/
+
+int Timestamps::nearest(double time) const
+{
+    int lo = 0;
+    int hi = data.size() - 1;
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (data[mid] < time)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo > 0 && time - data[lo - 1] < data[lo] - time)
+        lo--;
+    return lo;
+}
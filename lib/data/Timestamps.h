@@ -0,0 +1,37 @@
+#ifndef TIMESTAMPS_H
+#define TIMESTAMPS_H
+
+#include <stdio.h>
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <vector>
+
+/**
+\class Timestamps
+
+\brief Sample times of one sensor, read from its KITTI timestamps.txt. Times are kept in
+seconds since the start of the recording day so they can be compared across sensors.
+
+*/
+
+class Timestamps
+{
+    public:
+        Timestamps(std::string filename, int numSamples, double period);
+        Timestamps(const std::vector<double>& times);
+        ~Timestamps();
+
+        int size() const;
+        double get(int index) const;
+        double getStart() const;
+        double getEnd() const;
+        int nearest(double time) const;
+    protected:
+    private:
+        std::vector<double> data;   ///< Sample times in seconds, ascending.
+
+        static bool parseLine(const std::string& line, double& seconds);
+};
+
+#endif // TIMESTAMPS_H
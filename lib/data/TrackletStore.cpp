@@ -0,0 +1,365 @@
+#include "TrackletStore.h"
+
+const uint8_t TrackletStore::OCCLUSION_UNSET;
+const uint8_t TrackletStore::TRUNCATION_UNSET;
+
+/**
+\brief Read tracklet_labels.xml of a drive.
+
+\param filename - path of the XML file.
+*/
+
+TrackletStore::TrackletStore(std::string filename) : filename(filename)
+{
+    FILE* fin = fopen(filename.c_str(), "rb");
+    if (!fin)
+    {
+        printf(" Error, Couldn't find file: %s\n", filename.c_str());
+        exit(1);
+    }
+
+    fseeko(fin, 0, SEEK_END);
+    std::vector<char> text(ftello(fin) + 1, 0);
+    fseeko(fin, 0, SEEK_SET);
+    if (fread(&text[0], 1, text.size() - 1, fin) != text.size() - 1)
+        exitMalformed("truncated file");
+    fclose(fin);
+
+    std::vector<Pose> poses;
+    parse(&text[0], poses);
+    sortPoses(poses);
+}
+
+TrackletStore::~TrackletStore()
+{
+    //dtor
+}
+
+bool TrackletStore::exists(std::string filename)
+{
+    struct stat st;
+    return stat(filename.c_str(), &st) == 0;
+}
+
+int TrackletStore::getNumFrames() const
+{
+    return frameStarts.size() - 1;
+}
+
+int TrackletStore::getNumObjects() const
+{
+    return objectClasses.size();
+}
+
+int TrackletStore::getNumPoses() const
+{
+    return poseObjects.size();
+}
+
+const std::string& TrackletStore::getClassName(int classId) const
+{
+    return classNames[classId];
+}
+
+ArrayView<uint8_t> TrackletStore::getObjectClasses() const
+{
+    return ArrayView<uint8_t>(objectClasses);
+}
+
+ArrayView<glm::vec3> TrackletStore::getObjectSizes() const
+{
+    return ArrayView<glm::vec3>(objectSizes);
+}
+
+ArrayView<int> TrackletStore::getFirstFrames() const
+{
+    return ArrayView<int>(firstFrames);
+}
+
+/**
+\brief Get range of pose columns holding the objects of a frame. Frames without objects,
+including frames past the last tracklet, give an empty range.
+
+\param frameId - id of the frame.
+\param begin - receives first pose of the frame.
+\param end - receives one past last pose of the frame.
+*/
+
+void TrackletStore::getFrameRange(int frameId, int& begin, int& end) const
+{
+    if (frameId < 0 || frameId >= getNumFrames())
+    {
+        begin = end = 0;
+        return;
+    }
+    begin = frameStarts[frameId];
+    end = frameStarts[frameId + 1];
+}
+
+ArrayView<uint32_t> TrackletStore::getPoseObjects() const
+{
+    return ArrayView<uint32_t>(poseObjects);
+}
+
+ArrayView<glm::vec3> TrackletStore::getTranslations() const
+{
+    return ArrayView<glm::vec3>(translations);
+}
+
+ArrayView<glm::vec3> TrackletStore::getRotations() const
+{
+    return ArrayView<glm::vec3>(rotations);
+}
+
+ArrayView<uint8_t> TrackletStore::getStates() const
+{
+    return ArrayView<uint8_t>(states);
+}
+
+ArrayView<uint8_t> TrackletStore::getOcclusions() const
+{
+    return ArrayView<uint8_t>(occlusions);
+}
+
+ArrayView<uint8_t> TrackletStore::getTruncations() const
+{
+    return ArrayView<uint8_t>(truncations);
+}
+
+/**
+\brief Get boxes of a frame. The view is valid as long as this object lives.
+
+\param frameId - id of the frame.
+*/
+
+ArrayView<BoundingBox> TrackletStore::getBoxes(int frameId) const
+{
+    int begin, end;
+    getFrameRange(frameId, begin, end);
+    if (begin == end)
+        return ArrayView<BoundingBox>();
+    return ArrayView<BoundingBox>(&boxes[begin], end - begin);
+}
+
+/**
+\brief Parse the XML in one pass, without building a document tree. Elements are tracked by
+their path only, values are taken straight from leaf elements.
+
+\param text - null terminated content of the XML file.
+\param poses - receives poses of all objects, in file order.
+*/
+
+void TrackletStore::parse(const char* text, std::vector<Pose>& poses)
+{
+    std::vector<std::string> path;
+    std::string className;
+    glm::vec3 size(0);
+    int firstFrame = 0;
+    int numObjectPoses = 0;
+    Pose pose;
+
+    const char* cursor = text;
+    while ((cursor = strchr(cursor, '<')))
+    {
+        const char* tagEnd = strchr(cursor, '>');
+        if (!tagEnd)
+            exitMalformed("unterminated tag");
+
+        // Declarations and comments.
+        if (cursor[1] == '?' || cursor[1] == '!')
+        {
+            cursor = tagEnd + 1;
+            continue;
+        }
+
+        if (cursor[1] == '/')
+        {
+            if (path.empty())
+                exitMalformed("unbalanced closing tag");
+            bool isItem = path.back() == "item";
+            path.pop_back();
+            cursor = tagEnd + 1;
+
+            if (isItem && !path.empty() && path.back() == "poses")
+            {
+                poses.push_back(pose);
+            }
+            else if (isItem && !path.empty() && path.back() == "tracklets")
+            {
+                addObject(className, size, firstFrame);
+            }
+            continue;
+        }
+
+        std::string tag(cursor + 1, strcspn(cursor + 1, " \t\r\n/>"));
+        bool isEmpty = tagEnd[-1] == '/';
+        cursor = tagEnd + 1;
+        if (isEmpty)
+            continue;
+
+        // A leaf holds text only, its value ends at the closing tag.
+        const char* next = strchr(cursor, '<');
+        if (next && next[1] == '/')
+        {
+            bool isPose = path.size() >= 2 && path.back() == "item" && path[path.size() - 2] == "poses";
+            bool isObject = path.size() >= 2 && path.back() == "item" && path[path.size() - 2] == "tracklets";
+            if (isPose) {
+                setPoseValue(tag, cursor, pose);
+            } else if (isObject) {
+                if (tag == "objectType")
+                    className.assign(cursor, next - cursor);
+                else if (tag == "h")
+                    size.x = strtof(cursor, NULL);
+                else if (tag == "w")
+                    size.y = strtof(cursor, NULL);
+                else if (tag == "l")
+                    size.z = strtof(cursor, NULL);
+                else if (tag == "first_frame")
+                    firstFrame = atoi(cursor);
+            }
+
+            cursor = strchr(next, '>');
+            if (!cursor)
+                exitMalformed("unterminated tag");
+            cursor++;
+            continue;
+        }
+
+        if (tag == "item" && !path.empty() && path.back() == "tracklets")
+        {
+            className.clear();
+            size = glm::vec3(0);
+            firstFrame = 0;
+            numObjectPoses = 0;
+        }
+        else if (tag == "item" && !path.empty() && path.back() == "poses")
+        {
+            pose.object = objectClasses.size();
+            pose.frame = firstFrame + numObjectPoses++;
+            pose.translation = glm::vec3(0);
+            pose.rotation = glm::vec3(0);
+            pose.state = 0;
+            pose.occlusion = OCCLUSION_UNSET;
+            pose.truncation = TRUNCATION_UNSET;
+        }
+        path.push_back(tag);
+    }
+
+    if (!path.empty())
+        exitMalformed("unclosed element");
+}
+
+/**
+\brief Store a value of a pose. Values not shown by the viewer are skipped.
+
+\param tag - name of the leaf element.
+\param value - text of the leaf element.
+\param pose - pose being read.
+*/
+
+void TrackletStore::setPoseValue(const std::string& tag, const char* value, Pose& pose)
+{
+    if (tag == "tx") {
+        pose.translation.x = strtof(value, NULL);
+    } else if (tag == "ty") {
+        pose.translation.y = strtof(value, NULL);
+    } else if (tag == "tz") {
+        pose.translation.z = strtof(value, NULL);
+    } else if (tag == "rx") {
+        pose.rotation.x = strtof(value, NULL);
+    } else if (tag == "ry") {
+        pose.rotation.y = strtof(value, NULL);
+    } else if (tag == "rz") {
+        pose.rotation.z = strtof(value, NULL);
+    } else if (tag == "state") {
+        pose.state = atoi(value);
+    } else if (tag == "occlusion") {
+        int occlusion = atoi(value);
+        pose.occlusion = occlusion < 0 ? OCCLUSION_UNSET : occlusion;
+    } else if (tag == "truncation") {
+        int truncation = atoi(value);
+        pose.truncation = truncation == 99 ? TRUNCATION_UNSET : truncation;
+    }
+}
+
+/**
+\brief Append an object to object columns.
+
+\param className - object type, e.g. Car.
+\param size - height, width and length.
+\param firstFrame - first frame the object appears in.
+*/
+
+void TrackletStore::addObject(const std::string& className, const glm::vec3& size, int firstFrame)
+{
+    int classId = 0;
+    while (classId < (int)classNames.size() && classNames[classId] != className)
+        classId++;
+    if (classId == (int)classNames.size())
+    {
+        if (classNames.size() > 255)
+            exitMalformed("too many object types");
+        classNames.push_back(className);
+    }
+
+    objectClasses.push_back(classId);
+    objectSizes.push_back(size);
+    firstFrames.push_back(firstFrame);
+}
+
+/**
+\brief Fill pose columns with poses ordered by frame, keeping file order within a frame,
+and build the frame index.
+
+\param poses - poses of all objects, in file order.
+*/
+
+void TrackletStore::sortPoses(const std::vector<Pose>& poses)
+{
+    int numFrames = 0;
+    for (size_t i = 0; i < poses.size(); i++)
+    {
+        if (poses[i].frame < 0)
+            exitMalformed("negative frame");
+        numFrames = std::max(numFrames, poses[i].frame + 1);
+    }
+
+    frameStarts.assign(numFrames + 1, 0);
+    for (size_t i = 0; i < poses.size(); i++)
+        frameStarts[poses[i].frame + 1]++;
+    for (int i = 0; i < numFrames; i++)
+        frameStarts[i + 1] += frameStarts[i];
+
+    std::vector<uint32_t> order(poses.size());
+    std::vector<uint32_t> next(frameStarts.begin(), frameStarts.end() - 1);
+    for (size_t i = 0; i < poses.size(); i++)
+        order[next[poses[i].frame]++] = i;
+
+    poseObjects.reserve(poses.size());
+    translations.reserve(poses.size());
+    rotations.reserve(poses.size());
+    states.reserve(poses.size());
+    occlusions.reserve(poses.size());
+    truncations.reserve(poses.size());
+    boxes.reserve(poses.size());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        const Pose& pose = poses[order[i]];
+        poseObjects.push_back(pose.object);
+        translations.push_back(pose.translation);
+        rotations.push_back(pose.rotation);
+        states.push_back(pose.state);
+        occlusions.push_back(pose.occlusion);
+        truncations.push_back(pose.truncation);
+
+        const glm::vec3& size = objectSizes[pose.object];
+        boxes.push_back(BoundingBox(classNames[objectClasses[pose.object]].c_str(), glm::vec3(size.z, size.x, size.y),
+                                    pose.translation, pose.rotation));
+    }
+}
+
+void TrackletStore::exitMalformed(const char* reason)
+{
+    printf(" Error, Malformed tracklet file %s: %s\n", filename.c_str(), reason);
+    exit(1);
+}
@@ -0,0 +1,93 @@
+#ifndef TRACKLETSTORE_H
+#define TRACKLETSTORE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <sys/stat.h>
+#include <glm/glm.hpp>
+
+#include "../utils/ArrayView.h"
+#include "BoundingBox.h"
+
+/**
+\class TrackletStore
+
+\brief All tracklets of a drive, read once from tracklet_labels.xml.
+
+Data is kept in columns. Object columns have one entry per tracklet. Pose columns have one
+entry per object per frame, sorted by frame, so the objects of a frame are one contiguous
+range of every pose column. Boxes of a frame are therefore a slice, nothing is parsed or
+allocated per frame.
+
+*/
+
+class TrackletStore
+{
+    public:
+        static const uint8_t OCCLUSION_UNSET = 255;     ///< Stored as -1 in the XML.
+        static const uint8_t TRUNCATION_UNSET = 255;    ///< Stored as 99 in the XML.
+
+        TrackletStore(std::string filename);
+        ~TrackletStore();
+
+        static bool exists(std::string filename);
+
+        int getNumFrames() const;
+        int getNumObjects() const;
+        int getNumPoses() const;
+
+        const std::string& getClassName(int classId) const;
+        ArrayView<uint8_t> getObjectClasses() const;
+        ArrayView<glm::vec3> getObjectSizes() const;
+        ArrayView<int> getFirstFrames() const;
+
+        void getFrameRange(int frameId, int& begin, int& end) const;
+        ArrayView<uint32_t> getPoseObjects() const;
+        ArrayView<glm::vec3> getTranslations() const;
+        ArrayView<glm::vec3> getRotations() const;
+        ArrayView<uint8_t> getStates() const;
+        ArrayView<uint8_t> getOcclusions() const;
+        ArrayView<uint8_t> getTruncations() const;
+        ArrayView<BoundingBox> getBoxes(int frameId) const;
+    protected:
+    private:
+        struct Pose
+        {
+            uint32_t object;
+            int frame;
+            glm::vec3 translation;
+            glm::vec3 rotation;
+            uint8_t state;
+            uint8_t occlusion;
+            uint8_t truncation;
+        };
+
+        std::string filename;
+        std::vector<std::string> classNames;    ///< Object types, indexed by class id.
+
+        std::vector<uint8_t> objectClasses;     ///< Class id of each object.
+        std::vector<glm::vec3> objectSizes;     ///< Height, width, length of each object.
+        std::vector<int> firstFrames;           ///< First frame each object appears in.
+
+        std::vector<uint32_t> frameStarts;      ///< First pose of each frame, numFrames + 1 entries.
+        std::vector<uint32_t> poseObjects;      ///< Object of each pose.
+        std::vector<glm::vec3> translations;
+        std::vector<glm::vec3> rotations;
+        std::vector<uint8_t> states;
+        std::vector<uint8_t> occlusions;
+        std::vector<uint8_t> truncations;
+        std::vector<BoundingBox> boxes;         ///< Box of each pose, model matrix computed once.
+
+        void parse(const char* text, std::vector<Pose>& poses);
+        void setPoseValue(const std::string& tag, const char* value, Pose& pose);
+        void addObject(const std::string& className, const glm::vec3& size, int firstFrame);
+        void sortPoses(const std::vector<Pose>& poses);
+        void exitMalformed(const char* reason);
+};
+
+#endif // TRACKLETSTORE_H
@@ -2,20 +2,14 @@
 
 SubWindow* SubWindow::mInstance = NULL;
 
+const int SubWindow::NUM_CAMERA;
+
 SubWindow::SubWindow()
 {
-    for (int i = 0; i < NUM_CAMERA; i++)
-    {
-        float h = 1;
-        float w = 2;
-        float cx = -0.5 + 1 * i;
-        float cy = 0;
-
-        glm::mat4 subwindowModel = glm::translate(glm::mat4(1.0), glm::vec3(cx, cy, 0));
-
-        cameraImages[i].setSize(h, w);
-        cameraImages[i].setModelMatrix(subwindowModel);
-    }
+    ConfigLoader* conf = ConfigLoader::getInstance();
+    visibleCameras = conf->getCameraMask() & ((1 << NUM_CAMERA) - 1);
+    columns = conf->getCameraColumns();
+    layout();
 }
 
 SubWindow::~SubWindow()
@@ -36,15 +30,97 @@ void SubWindow::draw()
 {
     for (int i = 0; i < NUM_CAMERA; i++)
     {
-        cameraImages[i].draw();
+        if (visibleCameras & (1 << i))
+            cameraImages[i].draw();
+    }
+}
+
+/**
+\brief Show or hide a camera, the grid is laid out again.
+
+\param camera - KITTI camera number, 0 for image_00.
+*/
+
+void SubWindow::toggleCamera(int camera)
+{
+    if (camera < 0 || camera >= NUM_CAMERA)
+        return;
+
+    visibleCameras ^= 1 << camera;
+    layout();
+}
+
+/**
+\brief Get cameras shown, bit i is set for image_0i.
+*/
+
+uint32_t SubWindow::getVisibleCameras() const
+{
+    return visibleCameras;
+}
+
+/**
+\brief Get number of grid columns in use.
+*/
+
+int SubWindow::getNumColumns() const
+{
+    int numVisible = std::max(getNumVisible(), 1);
+    return columns > 0 ? std::min(columns, numVisible) : numVisible;
+}
+
+/**
+\brief Get number of grid rows in use, 0 if no camera is shown.
+*/
+
+int SubWindow::getNumRows() const
+{
+    return (getNumVisible() + getNumColumns() - 1) / getNumColumns();
+}
+
+int SubWindow::getNumVisible() const
+{
+    return __builtin_popcount(visibleCameras);
+}
+
+/**
+\brief Place shown cameras in grid cells, in clip space of the sub window viewport.
+*/
+
+void SubWindow::layout()
+{
+    int numColumns = getNumColumns();
+    int numRows = std::max(getNumRows(), 1);
+    float w = 2.0 / numColumns;
+    float h = 2.0 / numRows;
+
+    int cell = 0;
+    for (int i = 0; i < NUM_CAMERA; i++)
+    {
+        if (!(visibleCameras & (1 << i)))
+            continue;
+
+        float cx = -1 + w * (cell % numColumns + 0.5);
+        float cy = 1 - h * (cell / numColumns + 0.5);
+        glm::mat4 subwindowModel = glm::translate(glm::mat4(1.0), glm::vec3(cx, cy, 0));
+
+        // Wall width is along clip space x, height along y.
+        cameraImages[i].setSize(w, h);
+        cameraImages[i].setModelMatrix(subwindowModel);
+        cell++;
     }
 }
 
-void SubWindow::update(ImageData data)
+/**
+\brief Upload images of shown cameras. Cameras without image in the frame keep their last one.
+*/
+
+void SubWindow::update(std::shared_ptr<const ImageData> data)
 {
-    std::vector<sf::Image> images = data.getData();
-    for (int i = 0; i < std::min(4, (int)images.size()); i++)
+    const std::vector<std::shared_ptr<const CameraFrame> >& images = data->getData();
+    for (int i = 0; i < std::min(NUM_CAMERA, (int)images.size()); i++)
     {
-        cameraImages[i].loadTexture(images[i]);
+        if (images[i] && (visibleCameras & (1 << i)))
+            cameraImages[i].loadTexture(*images[i]);
     }
 }
@@ -18,6 +18,15 @@
 #include "../patterns/Observer.h"
 #include "../data/ImageData.h"
 #include "../layouts/CameraImage.h"
+#include "../loaders/ConfigLoader.h"
+
+/**
+\class SubWindow
+
+\brief Camera images shown in a grid below the 3D view. Any of the four KITTI cameras can be
+shown, they fill the grid row by row in camera order.
+
+*/
 
 class SubWindow : public Observer<ImageData>
 {
@@ -25,16 +34,26 @@ class SubWindow : public Observer<ImageData>
         static SubWindow* getInstance();
         ~SubWindow();
 
+        static const int NUM_CAMERA = 4;        ///< KITTI cameras, image_00 to image_03.
+
         void draw();
+        void toggleCamera(int camera);
+        uint32_t getVisibleCameras() const;
+        int getNumColumns() const;
+        int getNumRows() const;
     protected:
     private:
         SubWindow();
 
-        static const int NUM_CAMERA = 2;
         CameraImage cameraImages[NUM_CAMERA];
+        uint32_t visibleCameras;        ///< Bit i is set if image_0i is shown.
+        int columns;                    ///< Columns of grid, 0 for a single row.
+
+        int getNumVisible() const;
+        void layout();
 
         static SubWindow* mInstance;
 
-        void update(ImageData data);       ///< Implementation of observer pattern.
+        void update(std::shared_ptr<const ImageData> data);       ///< Implementation of observer pattern.
 };
 #endif // SubWindow_H
@@ -76,8 +76,9 @@ void BoxLoader::LoadDataToGraphicsCard()
 
 void BoxLoader::draw(GLuint PVMLoc, glm::mat4 projection, glm::mat4 view)
 {
-    if (!isShow) return;
+    if (!isShow || !boxList) return;
 
+    ArrayView<BoundingBox> boxes = boxList->getData();
     glLineWidth(3);
     for (int i = 0; i < boxes.size(); i++)
     {
@@ -96,9 +97,9 @@ void BoxLoader::draw(GLuint PVMLoc, glm::mat4 projection, glm::mat4 view)
     }
 }
 
-void BoxLoader::update(BoxList v) 
+void BoxLoader::update(std::shared_ptr<const BoxList> v) 
 {
-    boxes = v.getData();
+    boxList = v;
 }
 
 void BoxLoader::toggleDisplay()
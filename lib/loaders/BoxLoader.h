@@ -23,7 +23,7 @@ class BoxLoader : public Observer<BoxList>
         virtual ~BoxLoader();
         void draw(GLuint PVMLoc, glm::mat4 projection, glm::mat4 view);
         void LoadDataToGraphicsCard();
-        void update(BoxList v);
+        void update(std::shared_ptr<const BoxList> v);
         void toggleDisplay();
     protected:
 
@@ -34,7 +34,7 @@ class BoxLoader : public Observer<BoxList>
 
         bool isShow = false;
         std::vector<float> data;
-        std::vector<BoundingBox> boxes;
+        std::shared_ptr<const BoxList> boxList;     ///< Boxes of current frame, shared with DataLoader.
 
         GLfloat points[NUM_PTS * 4] = {
             -0.5, -0.5, -0.5, 1.0,
@@ -0,0 +1,180 @@
+#include "CameraCache.h"
+
+const int CameraCache::NUM_CAMERA;
+const int CameraCache::MAX_PENDING;
+const char* CameraCache::EXTENSION = "kvcf";
+
+/**
+\brief Constructor
+
+\param folder - cache folder, created on first write.
+*/
+
+CameraCache::CameraCache(std::string folder) : folder(folder)
+{
+    for (int i = 0; i < NUM_CAMERA; i++)
+        list(i);
+    writerThread = std::thread(&CameraCache::runWriter, this);
+}
+
+/**
+\brief Destructor, finishes the frame being written and drops the rest.
+*/
+
+CameraCache::~CameraCache()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStop = true;
+    }
+    cond.notify_one();
+    if (writerThread.joinable())
+        writerThread.join();
+}
+
+/**
+\brief Check if a frame is in the cache.
+
+\param camera - KITTI camera number.
+\param fileId - number of the image file.
+*/
+
+bool CameraCache::has(int camera, int fileId)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return getState(camera, fileId) == CACHED;
+}
+
+/**
+\brief Get path of a cached frame.
+
+\param camera - KITTI camera number.
+\param fileId - number of the image file.
+*/
+
+std::string CameraCache::getFilename(int camera, int fileId) const
+{
+    char filename[32];
+    sprintf(filename, "/image_%02d/%010d.%s", camera, fileId, EXTENSION);
+    return folder + filename;
+}
+
+/**
+\brief Queue a frame to be written. Frames already cached or queued are ignored.
+
+\param camera - KITTI camera number.
+\param fileId - number of the image file.
+\param frame - transcoded image.
+*/
+
+void CameraCache::put(int camera, int fileId, std::shared_ptr<const CameraFrame> frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        State& state = getState(camera, fileId);
+        if (state != ABSENT || jobs.size() >= MAX_PENDING || isStop)
+            return;
+        state = PENDING;
+        jobs.push_back({camera, fileId, frame});
+    }
+    cond.notify_one();
+}
+
+/**
+\brief Get state of a file id, growing the table as needed. Caller holds mutex.
+*/
+
+CameraCache::State& CameraCache::getState(int camera, int fileId)
+{
+    std::vector<State>& cameraStates = states[camera];
+    if (fileId >= cameraStates.size())
+        cameraStates.resize(fileId + 1, ABSENT);
+    return cameraStates[fileId];
+}
+
+/**
+\brief Mark frames of a camera found in the cache folder.
+
+\param camera - KITTI camera number.
+*/
+
+void CameraCache::list(int camera)
+{
+    char path[32];
+    sprintf(path, "/image_%02d", camera);
+    DIR *dir = opendir((folder + path).c_str());
+    if (dir == NULL)
+        return;
+
+    struct dirent *entry;
+    while ((entry = readdir(dir))) {
+        int fileId;
+        char extension[8];
+        if (sscanf(entry->d_name, "%d.%7s", &fileId, extension) == 2 && fileId >= 0 && std::string(extension) == EXTENSION)
+            getState(camera, fileId) = CACHED;
+    }
+    closedir(dir);
+}
+
+/**
+\brief Write a frame under a temporary name and move it in place once complete.
+
+\param job - frame to write.
+\return false if the frame could not be written.
+*/
+
+bool CameraCache::write(const Job& job) const
+{
+    char path[32];
+    sprintf(path, "/image_%02d", job.camera);
+    mkdir(folder.c_str(), 0755);
+    mkdir((folder + path).c_str(), 0755);
+
+    std::string filename = getFilename(job.camera, job.fileId);
+    std::string partial = filename + ".part";
+    FILE* fout = fopen(partial.c_str(), "wb");
+    if (!fout)
+        return false;
+
+    std::shared_ptr<const FileBuffer> bytes = job.frame->getBytes();
+    bool isWritten = fwrite(bytes->getData(), 1, bytes->getSize(), fout) == bytes->getSize();
+    isWritten = fclose(fout) == 0 && isWritten;
+    if (!isWritten || rename(partial.c_str(), filename.c_str()) != 0)
+    {
+        remove(partial.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+\brief Write queued frames until stopped. A frame that fails to write stays pending, so it
+is not retried during this playback.
+*/
+
+void CameraCache::runWriter()
+{
+    bool isReported = false;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        cond.wait(lock, [this]() { return isStop || !jobs.empty(); });
+        if (isStop)
+            return;
+
+        Job job = jobs.front();
+        jobs.pop_front();
+
+        lock.unlock();
+        bool isWritten = write(job);
+        if (!isWritten && !isReported)
+        {
+            printf("Could not write camera cache %s\n", folder.c_str());
+            isReported = true;
+        }
+        lock.lock();
+
+        if (isWritten)
+            getState(job.camera, job.fileId) = CACHED;
+    }
+}
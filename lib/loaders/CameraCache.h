@@ -0,0 +1,73 @@
+#ifndef CAMERACACHE_H
+#define CAMERACACHE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "../data/CameraFrame.h"
+
+/**
+\class CameraCache
+
+\brief Camera images transcoded to CameraFrame, stored in a folder next to the drive so later
+playbacks skip PNG decoding.
+
+Frames are written by a background thread the first time they are decoded. Files are named
+like the images they replace, `<folder>/image_02/0000000005.kvcf`, and appear only once
+complete. The folder is listed once on construction, lookups do not touch disk.
+
+*/
+
+class CameraCache
+{
+    public:
+        static const int NUM_CAMERA = 4;        ///< KITTI cameras image_00 to image_03.
+        static const int MAX_PENDING = 32;      ///< Frames waiting to be written, further frames are left for the next playback.
+        static const char* EXTENSION;
+
+        CameraCache(std::string folder);
+        ~CameraCache();
+
+        bool has(int camera, int fileId);
+        std::string getFilename(int camera, int fileId) const;
+        void put(int camera, int fileId, std::shared_ptr<const CameraFrame> frame);
+    protected:
+    private:
+        enum State : uint8_t
+        {
+            ABSENT,
+            PENDING,
+            CACHED
+        };
+
+        struct Job
+        {
+            int camera;
+            int fileId;
+            std::shared_ptr<const CameraFrame> frame;
+        };
+
+        std::string folder;
+        std::vector<State> states[NUM_CAMERA];      ///< State of each file id, guarded by mutex.
+        std::deque<Job> jobs;
+        std::mutex mutex;
+        std::condition_variable cond;
+        bool isStop = false;
+        std::thread writerThread;
+
+        State& getState(int camera, int fileId);
+        void list(int camera);
+        bool write(const Job& job) const;
+        void runWriter();
+};
+
+#endif // CAMERACACHE_H
@@ -61,6 +61,67 @@ void ConfigLoader::loadFile(std::string filename)
                 } else if (key == "drive")
                 {
                     drive = std::stoi(value);
+                } else if (key == "layout")
+                {
+                    layout = value;
+                } else if (key == "hot_cache_mb")
+                {
+                    hotCacheMB = std::stoi(value);
+                } else if (key == "warm_cache_mb")
+                {
+                    warmCacheMB = std::stoi(value);
+                } else if (key == "io")
+                {
+                    io = value;
+                } else if (key == "camera_cache")
+                {
+                    cameraCache = std::stoi(value) != 0;
+                } else if (key == "cameras")
+                {
+                    cameras = 0;
+                    std::istringstream list(value);
+                    std::string camera;
+                    while (std::getline(list, camera, ','))
+                        cameras |= 1 << (std::stoi(camera) & 3);
+                } else if (key == "camera_columns")
+                {
+                    cameraColumns = std::stoi(value);
+                } else if (key == "point_min_range")
+                {
+                    pointFilter.minRange = std::stof(value);
+                } else if (key == "point_max_range")
+                {
+                    pointFilter.maxRange = std::stof(value);
+                } else if (key == "point_min_height")
+                {
+                    pointFilter.minHeight = std::stof(value);
+                } else if (key == "point_max_height")
+                {
+                    pointFilter.maxHeight = std::stof(value);
+                } else if (key == "point_camera_view")
+                {
+                    pointFilter.isCameraView = std::stoi(value) != 0;
+                } else if (key == "point_voxel")
+                {
+                    pointFilter.voxelSize = std::stof(value);
+                } else if (key == "point_stride")
+                {
+                    pointFilter.stride = std::stoi(value);
+                } else if (key == "point_progressive")
+                {
+                    pointFilter.isProgressive = std::stoi(value) != 0;
+                } else if (key == "point_budget")
+                {
+                    pointBudget = std::stoi(value);
+                } else if (key == "point_sweeps")
+                {
+                    numSweeps = std::stoi(value);
+                } else if (key == "map")
+                {
+                    map = std::stoi(value) != 0;
+                } else if (key == "map_gpu_mb")
+                {
+                    mapGPUMB = std::stoi(value);
                 }
             }
         }
@@ -81,7 +142,150 @@ void ConfigLoader::getBasePath(char folderPath[])
         exit(1);
     }
 
-    sprintf(folderPath, "%s/%s/%s_drive_%04d_sync", path, date, date, drive);
+    sprintf(folderPath, "%s/%s/%s_drive_%04d_%s", path, date, date, drive, layout.c_str());
+}
+
+/**
+\brief Get KITTI root folder, holding one folder per date.
+*/
+
+std::string ConfigLoader::getRootPath() const
+{
+    if (!isLoaded)
+    {
+        printf("Unable to access root path because configuration is not loaded yet.\n");
+        exit(1);
+    }
+
+    return path;
+}
+
+/**
+\brief Select a drive of the root other than the one in conf.txt.
+
+\param driveDate - recording date, e.g. 2011_09_26.
+\param driveNumber - drive number of that date.
+\param driveLayout - "sync" or "extract".
+*/
+
+void ConfigLoader::setDrive(std::string driveDate, int driveNumber, std::string driveLayout)
+{
+    if (date)
+        free(date);
+
+    date = strdup(driveDate.c_str());
+    drive = driveNumber;
+    layout = driveLayout;
+}
+
+/**
+\brief Check if drive uses the unsynced "extract" layout, where each sensor keeps its own
+sample rate and velodyne sweeps are stored as text.
+*/
+
+bool ConfigLoader::isExtractLayout() const
+{
+    return layout == "extract";
+}
+
+/**
+\brief Get byte budget of the cache holding decoded frames.
+*/
+
+size_t ConfigLoader::getHotCacheBytes() const
+{
+    return (size_t)std::max(hotCacheMB, 0) << 20;
+}
+
+/**
+\brief Get byte budget of the cache holding raw sensor files as read from disk.
+*/
+
+size_t ConfigLoader::getWarmCacheBytes() const
+{
+    return (size_t)std::max(warmCacheMB, 0) << 20;
+}
+
+/**
+\brief Get name of the I/O backend sensor files are read with.
+*/
+
+std::string ConfigLoader::getIOBackend() const
+{
+    return io;
+}
+
+/**
+\brief Check if camera frames are cached on disk in GPU-ready form, so later playbacks skip
+image decoding.
+*/
+
+bool ConfigLoader::isCameraCache() const
+{
+    return cameraCache;
+}
+
+/**
+\brief Get cameras shown at start, bit i is set for image_0i.
+*/
+
+unsigned int ConfigLoader::getCameraMask() const
+{
+    return cameras;
+}
+
+/**
+\brief Get number of columns of the camera grid, 0 to put all cameras in one row.
+*/
+
+int ConfigLoader::getCameraColumns() const
+{
+    return std::max(cameraColumns, 0);
+}
+
+/**
+\brief Get stages velodyne sweeps are trimmed and ordered by at start.
+*/
+
+PointFilter::Settings ConfigLoader::getPointFilter() const
+{
+    return pointFilter;
+}
+
+/**
+\brief Get most cloud points drawn per frame, 0 for all.
+*/
+
+unsigned int ConfigLoader::getPointBudget() const
+{
+    return std::max(pointBudget, 0);
+}
+
+/**
+\brief Get number of velodyne sweeps drawn at start, the current one and those before it.
+*/
+
+int ConfigLoader::getNumSweeps() const
+{
+    return std::max(numSweeps, 1);
+}
+
+/**
+\brief Check if the map of the whole drive is built, if missing, and drawn at start.
+*/
+
+bool ConfigLoader::isMap() const
+{
+    return map;
+}
+
+/**
+\brief Get bytes of map nodes kept on the GPU.
+*/
+
+size_t ConfigLoader::getMapGPUBytes() const
+{
+    return (size_t)std::max(mapGPUMB, 1) << 20;
 }
 
 // void ConfigLoader::getVelodyneFile(char path[], int id)
@@ -7,6 +7,9 @@
 #include <string>
 #include <fstream>
 #include <string.h>
+#include <algorithm>
+
+#include "../data/PointFilter.h"
 
 class ConfigLoader
 {
@@ -18,6 +21,20 @@ class ConfigLoader
         void loadFile(std::string);
         void getBasePath(char folderPath[]);
         std::string getBasePathString(char folderPath[]);
+        std::string getRootPath() const;
+        void setDrive(std::string driveDate, int driveNumber, std::string driveLayout);
+        bool isExtractLayout() const;
+        size_t getHotCacheBytes() const;
+        size_t getWarmCacheBytes() const;
+        std::string getIOBackend() const;
+        bool isCameraCache() const;
+        unsigned int getCameraMask() const;
+        int getCameraColumns() const;
+        PointFilter::Settings getPointFilter() const;
+        unsigned int getPointBudget() const;
+        int getNumSweeps() const;
+        bool isMap() const;
+        size_t getMapGPUBytes() const;
     protected:
     private:
         ConfigLoader();
@@ -28,6 +45,18 @@ class ConfigLoader
         char* path = NULL;
         char* date = NULL;
         int drive = -1;
+        std::string layout = "sync";    ///< Drive layout, "sync" or "extract".
+        int hotCacheMB = 512;           ///< Budget for decoded frames.
+        int warmCacheMB = 1024;         ///< Budget for raw file bytes.
+        std::string io = "pread";       ///< I/O backend, "pread", "mmap", "uring" or "direct".
+        bool cameraCache = false;       ///< Keep transcoded camera frames next to the drive.
+        unsigned int cameras = 0xC;     ///< Cameras shown at start, bit i for image_0i.
+        int cameraColumns = 0;          ///< Columns of camera grid, 0 for a single row.
+        PointFilter::Settings pointFilter;  ///< Stages sweeps are trimmed by, none by default, and their order.
+        int pointBudget = 0;            ///< Most cloud points drawn per frame, 0 for all.
+        int numSweeps = 1;              ///< Sweeps drawn, the current one and those before it.
+        bool map = false;               ///< Build and draw the map of the whole drive.
+        int mapGPUMB = 512;             ///< Budget for map nodes on the GPU.
 };
 
 #endif // CONFIGLOADER_H
@@ -2,47 +2,129 @@
 
 DataLoader* DataLoader::mInstance = NULL;
 
-DataLoader::DataLoader()
+const int DataLoader::MIN_QUEUE_SIZE;
+const int DataLoader::MAX_QUEUE_SIZE;
+const int DataLoader::NUM_LOAD_THREADS;
+constexpr float DataLoader::MAX_TICK;
+constexpr double DataLoader::LATENCY_SMOOTHING;
+constexpr double DataLoader::LOAD_HEADROOM;
+constexpr double DataLoader::LATENCY_BUFFER;
+constexpr double DataLoader::MIN_BUFFER_SECONDS;
+constexpr double DataLoader::MAX_BUFFER_SECONDS;
+
+DataLoader::DataLoader() : isStop(false), generation(0), playbackSpeed(1), prefetchDepth(MIN_QUEUE_SIZE), frameStride(1), imageViewWidth(0), imageViewHeight(0), visibleCameras(0)
 {
-    char folderPath[400];
-    sprintf(folderPath, "%s/%s/%s_drive_%04d_sync/velodyne_points/data", path, date, date, drive);
+    ConfigLoader* conf = ConfigLoader::getInstance();
+    conf->getBasePath(basePath);
+    visibleCameras = conf->getCameraMask();
+    pointFilter = std::make_shared<const PointFilter>(conf->getPointFilter());
+    isExtract = conf->isExtractLayout();
+
+    io = IOBackend::create(conf->getIOBackend());
+
+    // A drive packed by kittiviz-pack next to its folder is read instead of the folder.
+    std::string archivePath = std::string(basePath) + ".kvpk";
+    if (DriveArchive::exists(archivePath)) {
+        archive = new DriveArchive(archivePath, io);
+        availableCameras = archive->getCameraMask();
+        printf("Reading packed drive %s\n", archivePath.c_str());
+
+        // Camera and OXT samples are matched to sweeps when packing, only velodyne time is needed.
+        numImages = archive->getNumFrames();
+        isExtract = archive->isTextVelodyne();
+        velodyneTimes = new Timestamps(archive->getTimes());
+        for (int i = 0; i < NUM_CAMERA; i++)
+            imageTimes[i] = NULL;
+        oxtTimes = NULL;
+    } else {
+        // Frames are the velodyne sweeps present, gaps in file numbering are skipped.
+        manifest = new DriveManifest(basePath, isExtract);
+        frameFiles = manifest->getPresent("velodyne_points/data");
+        numImages = frameFiles.size();
+        if (numImages == 0) {
+            printf("Wrong path: %s/velodyne_points/data\n", basePath);
+            exit(1);
+        }
+        velodyneTimes = new Timestamps(manifest->getPresentTimes("velodyne_points/data"));
+
+        // Other sensors are matched by time among their files present. Unsynced OXT runs at 100 Hz.
+        char folder[100];
+        for (int i = 0; i < NUM_CAMERA; i++) {
+            sprintf(folder, "image_%02d/data", i);
+            imageFiles[i] = manifest->getPresent(folder);
+            imageTimes[i] = new Timestamps(manifest->getPresentTimes(folder));
+            if (!imageFiles[i].empty())
+                availableCameras |= 1 << i;
+        }
 
-    DIR *dp = opendir(folderPath);
-    if (dp == NULL) {
-        printf("Wrong path: %s\n", folderPath);
-        exit(1);
+        oxtFiles = manifest->getPresent("oxts/data");
+        oxtTimes = new Timestamps(manifest->getPresentTimes("oxts/data"));
+
+        int numMissing = manifest->getNumMissing("velodyne_points/data");
+        if (numMissing > 0)
+            printf("Drive misses %d velodyne sweeps, skipping them.\n", numMissing);
     }
 
-    numImages = 0;
-    struct dirent *dirp;
-    while (dirp = readdir(dp)) {
-        // If current or parent directory, skip it
-        if(strcmp(dirp->d_name, ".") == 0 || strcmp(dirp->d_name, "..") == 0 )
-        {
-            continue;
-        }
-        numImages++;
+    loadOXTTable();
+
+    for (int i = 0; i < NUM_CAMERA; i++) {
+        if ((visibleCameras & (1 << i)) && !(availableCameras & (1 << i)))
+            printf("Drive has no image_%02d, its view stays empty.\n", i);
+    }
+
+    // Cached frames are keyed by image file number, or frame number in an archive.
+    if (conf->isCameraCache()) {
+        std::string cachePath = (archive ? archive->getFilename() : std::string(basePath)) + ".frames";
+        cameraCache = new CameraCache(cachePath);
+        printf("Caching camera frames in %s\n", cachePath.c_str());
+    }
+
+    // Tracklets straight from the XML of the drive replace per-frame files written by parser.py.
+    std::string trackletPath = std::string(basePath) + "/tracklet_labels.xml";
+    if (TrackletStore::exists(trackletPath)) {
+        tracklets = std::make_shared<TrackletStore>(trackletPath);
+        printf("Read %d tracklets from %s\n", tracklets->getNumObjects(), trackletPath.c_str());
     }
 
-    cloudpointQueue = new SafeQueue<CloudPoints>();
-    imageQueue = new SafeQueue<ImageData>();
-    bboxQueue = new SafeQueue<BoxList>();
-    oxtQueue = new SafeQueue<OXT>();
+    if (conf->isMap())
+        buildMap();
+
+    playbackClock.setRange(velodyneTimes->getStart(), velodyneTimes->getEnd());
+    if (numImages > 1 && velodyneTimes->getEnd() > velodyneTimes->getStart())
+        sensorRate = (numImages - 1) / (velodyneTimes->getEnd() - velodyneTimes->getStart());
+
+    frameQueue = new RingBuffer<FrameBundle>(MAX_QUEUE_SIZE);
+    frameCache = new FrameCache(conf->getHotCacheBytes(), conf->getWarmCacheBytes(), io);
+    scheduler = new LoadScheduler(NUM_LOAD_THREADS,
+                                  [this](int frameId, int gen) { return loadDataByThread(frameId, gen); },
+                                  [this]() { signalWorker(false); });
+    updatePrefetchPolicy();
 }
 
 DataLoader::~DataLoader()
 {
+    // The map builder reads through the I/O backend, it goes first.
+    delete mapBuilder;
+
     // Make sure worker thread is terminated.
     isStop = true;
+    signalWorker(true);
     if (workerThread.joinable()) {
         workerThread.join();
     }
 
     // Deallocate memory
-    delete cloudpointQueue;
-    delete imageQueue;
-    delete bboxQueue;
-    delete oxtQueue;
+    delete scheduler;
+    delete frameCache;
+    delete cameraCache;
+    delete archive;
+    delete manifest;
+    delete io;
+    delete frameQueue;
+    delete velodyneTimes;
+    for (int i = 0; i < NUM_CAMERA; i++)
+        delete imageTimes[i];
+    delete oxtTimes;
 }
 
 /**
@@ -60,37 +142,265 @@ DataLoader* DataLoader::getInstance() {
     return mInstance;
 }
 
+/**
+\brief Advance playback clock by elapsed wall time and display the frame closest to it.
+
+Called once per rendered frame, so playback speed does not depend on render frame rate.
+*/
+
 void DataLoader::nextID() {
+    double dt = std::min(tickClock.restart().asSeconds(), MAX_TICK);
     if (isPlayingVideo)
-        cnt = (cnt + 1) % (numImages * (60 / fps));
+        playbackClock.advance(dt);
 
-    if ((cnt % (60 / fps) == 0 && isPlayingVideo) || !isLoaded)
+    int target = velodyneTimes->nearest(playbackClock.getTime());
+    if (target != currentFrame || !isLoaded)
     {
-        notify();
-        isLoaded = true;
+        if (notify(target))
+            isLoaded = true;
     }
 }
 
 /**
 \brief Sets the boolean to play video or not.
 
+If prefetch was primed against the playback direction by a seek while paused, playback
+re-primes it from the current frame.
+
 \param b --- Draws the axes if true and not if false.
 
 */
 
 void DataLoader::setPlayingVideo(bool val) {
     isPlayingVideo = val;
+
+    if (isPlayingVideo && prefetchDirection != playbackClock.getDirection() && currentFrame >= 0)
+        seek(currentFrame);
 }
 
 /**
-\brief Sets frame rate.
+\brief Sets playback speed.
 
-\param nfps --- desired frame rate.
+\param speed --- drive seconds played per second, between PlaybackClock::MIN_SPEED and MAX_SPEED.
 
 */
 
-void DataLoader::setFPS(int nfps) {
-    fps = nfps;
+void DataLoader::setPlaybackSpeed(float speed) {
+    playbackClock.setSpeed(speed);
+    playbackSpeed = playbackClock.getSpeed();
+    signalWorker(true);
+}
+
+float DataLoader::getPlaybackSpeed() const {
+    return playbackClock.getSpeed();
+}
+
+/**
+\brief Sets playback direction.
+
+\param val --- plays backward if true.
+
+*/
+
+void DataLoader::setReverse(bool val) {
+    playbackClock.setReverse(val);
+
+    if (isPlayingVideo && prefetchDirection != playbackClock.getDirection())
+        seek(std::max(currentFrame, 0));
+}
+
+bool DataLoader::isReverse() const {
+    return playbackClock.isReverse();
+}
+
+/**
+\brief Set cameras shown, only their images are read and decoded. Showing a camera loads the
+current frame again.
+
+\param mask - bit i is set to show image_0i.
+*/
+
+void DataLoader::setVisibleCameras(uint32_t mask) {
+    uint32_t added = mask & ~visibleCameras;
+    visibleCameras = mask;
+    if ((added & availableCameras) && currentFrame >= 0)
+        seek(currentFrame);
+}
+
+/**
+\brief Get cameras whose images are loaded, those shown that the drive has.
+*/
+
+uint32_t DataLoader::getLoadedCameras() const {
+    return visibleCameras & availableCameras;
+}
+
+/**
+\brief Set stages velodyne sweeps are trimmed by. The current frame is loaded again, frames
+cached with other settings are decoded again from their raw files.
+
+\param settings - stages to run.
+*/
+
+void DataLoader::setPointFilter(const PointFilter::Settings& settings) {
+    {
+        std::lock_guard<std::mutex> lock(filterMutex);
+        pointFilter = std::make_shared<const PointFilter>(settings);
+    }
+    if (currentFrame >= 0)
+        seek(currentFrame);
+}
+
+/**
+\brief Get stages velodyne sweeps are trimmed by.
+*/
+
+PointFilter::Settings DataLoader::getPointFilter() {
+    return getPointFilterPtr()->getSettings();
+}
+
+/**
+\brief Get filter new sweeps are trimmed by, safe to call from loader threads.
+*/
+
+std::shared_ptr<const PointFilter> DataLoader::getPointFilterPtr() {
+    std::lock_guard<std::mutex> lock(filterMutex);
+    return pointFilter;
+}
+
+/**
+\brief Set size camera images are shown at, larger images are shrunk to it while loading.
+Frames already loaded for another size are loaded again.
+
+\param width - width of one camera view in pixels, 0 for full resolution.
+\param height - height of one camera view in pixels, 0 for full resolution.
+*/
+
+void DataLoader::setImageViewSize(int width, int height) {
+    if (width == imageViewWidth && height == imageViewHeight)
+        return;
+
+    imageViewWidth = width;
+    imageViewHeight = height;
+    if (currentFrame >= 0)
+        seek(currentFrame);
+}
+
+/**
+\brief Get current prefetch depth.
+
+\return number of frames worker keeps queued.
+*/
+
+int DataLoader::getPrefetchDepth() const {
+    return prefetchDepth;
+}
+
+/**
+\brief Get current frame stride.
+
+\return 1 if every frame is loaded, n if worker only loads every n-th frame to keep up.
+*/
+
+int DataLoader::getFrameStride() const {
+    return frameStride;
+}
+
+/**
+\brief Jump to a frame.
+
+Queued frames are flushed and loads still in flight for them are cancelled. The worker
+loads the target frame first, then prefetches in the direction of travel: forward while
+playing, otherwise in the direction of the jump so scrubbing backwards stays responsive.
+Must be called from the render thread since it consumes the frame queue.
+
+\param frameId - id of target frame, wrapped into the drive.
+*/
+
+void DataLoader::seek(int frameId) {
+    if (numImages <= 0)
+        return;
+
+    frameId = ((frameId % numImages) + numImages) % numImages;
+
+    // Flush before bumping generation, anything pushed in between is stale and dropped by notify().
+    flush();
+
+    // Cancel before the worker is woken, so the requests of the new generation it submits are kept.
+    scheduler->cancelAll();
+
+    {
+        std::lock_guard<std::mutex> lock(workerMutex);
+        generation++;
+        seekTarget = frameId;
+        if (isPlayingVideo)
+            prefetchDirection = playbackClock.getDirection();
+        else
+            prefetchDirection = frameId >= currentFrame ? 1 : -1;
+        isWakeRequested = true;
+    }
+    workerCond.notify_one();
+
+    // Display the target as soon as it arrives, even when paused.
+    playbackClock.setTime(velodyneTimes->get(frameId));
+    isLoaded = false;
+}
+
+/**
+\brief Get id of the frame currently displayed.
+
+\return frame id, -1 if nothing is displayed yet.
+*/
+
+int DataLoader::getCurrentFrame() const {
+    return currentFrame;
+}
+
+/**
+\brief Get total number of frames in the drive.
+*/
+
+int DataLoader::getNumFrames() const {
+    return numImages;
+}
+
+/**
+\brief Start building the map of the whole drive in background, unless it exists or is being
+built. Every sweep is read once, bypassing the frame cache. A build that failed is retried.
+*/
+
+void DataLoader::buildMap() {
+    if (mapBuilder)
+        return;
+    isMapOnDisk = DriveMap::exists(getMapFilename());
+    if (isMapOnDisk)
+        return;
+    mapBuilder = new MapBuilder(getMapFilename(), numImages,
+                                [this](int frameId) { return oxtTable->getVelodynePose(getOXTRecord(frameId)); },
+                                [this](int frameId, std::shared_ptr<const PointFilter> filter) { return loadMapSweep(frameId, filter); });
+}
+
+/**
+\brief Check if the map of the drive is complete on disk. The builder is dropped once done, so
+a failed build can be started again by buildMap.
+*/
+
+bool DataLoader::isMapReady() {
+    if (mapBuilder && mapBuilder->isDone())
+    {
+        delete mapBuilder;
+        mapBuilder = NULL;
+        isMapOnDisk = DriveMap::exists(getMapFilename());
+    }
+    return !mapBuilder && isMapOnDisk;
+}
+
+/**
+\brief Get path of the map of the drive, next to the drive folder.
+*/
+
+std::string DataLoader::getMapFilename() const {
+    return std::string(basePath) + ".kvmap";
 }
 
 /**
@@ -134,241 +444,667 @@ void DataLoader::attach(Observer<OXT>* observer) {
 }
 
 /**
-\brief Perform pop on all queues.
+\brief Drop the next frame in the queue.
 
 */
 
 void DataLoader::pop() {
-    if (cloudpointQueue->size() > 0) cloudpointQueue->pop();
-    if (bboxQueue->size() > 0) bboxQueue->pop();
-    if (imageQueue->size() > 0) imageQueue->pop();
-    if (oxtQueue->size() > 0) oxtQueue->pop();
+    FrameBundle bundle;
+    frameQueue->tryPop(bundle);
+}
+
+/**
+\brief Drop every frame in the queue.
+
+*/
+
+void DataLoader::flush() {
+    FrameBundle bundle;
+    while (frameQueue->tryPop(bundle)) {}
+}
+
+/**
+\brief Get how far a frame is ahead of another in prefetch direction.
+
+\param  frame - frame to measure.
+\param  reference - frame to measure from.
+\return number of frames, negative if behind, wrapping around the drive.
+*/
+
+int DataLoader::framesAhead(int frame, int reference) const {
+    int steps = (((frame - reference) * prefetchDirection) % numImages + numImages) % numImages;
+    if (steps > numImages / 2)
+        steps -= numImages;
+    return steps;
+}
+
+/**
+\brief Get number of the image file shown with a frame, the one closest in time to its sweep.
+In a drive archive images are stored per frame, so it is the frame number.
+
+\param  frameId - id of the frame.
+\param  camera - KITTI camera number, 0 for image_00.
+*/
+
+int DataLoader::getImageFile(int frameId, int camera) const {
+    if (archive)
+        return frameId;
+    return imageFiles[camera][imageTimes[camera]->nearest(velodyneTimes->get(frameId))];
 }
 
 /**
-\brief Notify all observers.
+\brief Notify all observers with a frame.
+
+This runs on the render thread and never blocks, if no frame is ready it returns.
+The latest queued frame not ahead of the target is dispatched, frames the playback clock
+already passed are dropped. When the worker skips frames, a target that falls between two
+loaded frames keeps the current frame on screen. If the target is out of reach of the
+queue, it is seeked to.
 
+\param  targetFrame - frame the playback clock asks for.
+\return True if a frame was dispatched.
 */
 
-void DataLoader::notify() {
-    if (minQueueSize() == 0) return;
+bool DataLoader::notify(int targetFrame) {
+    bool isPopped = false;
+    bool isDispatched = false;
+    int reach = (MAX_QUEUE_SIZE + 1) * frameStride;
+
+    FrameBundle* front;
+    while (!isDispatched && (front = frameQueue->front()) != NULL) {
+        if (!isStale(front)) {
+            int ahead = framesAhead(front->getFrameID(), targetFrame);
+            if (ahead > reach || -ahead > reach) {
+                seek(targetFrame);
+                return false;
+            }
+            if (ahead > 0)
+                break;
+        }
+
+        FrameBundle bundle;
+        frameQueue->tryPop(bundle);
+        isPopped = true;
+        if (isStale(&bundle))
+            continue;
+
+        // Drop frames the clock already passed, they would never be displayed.
+        FrameBundle* next = frameQueue->front();
+        bool isNextDue = next && !isStale(next) && framesAhead(next->getFrameID(), targetFrame) <= 0;
+        if (!isNextDue) {
+            dispatch(bundle);
+            isDispatched = true;
+        }
+    }
+
+    // Let worker check if queue drained below low-water mark.
+    if (isPopped)
+        signalWorker(false);
+    return isDispatched;
+}
+
+/**
+\brief Send a frame to all observers.
+
+All observers receive data of the same frame since it comes from a single bundle. Sensor
+data is shared, not copied, no matter how many observers there are.
+
+\param  bundle - frame to send.
+*/
+
+void DataLoader::dispatch(const FrameBundle& bundle) {
+    currentFrame = bundle.getFrameID();
 
-    BoxList boxes = bboxQueue->pop();
     for (int i = 0; i < bboxObservers.size(); i++) {
-        bboxObservers[i]->update(boxes);
+        bboxObservers[i]->update(bundle.getBoxList());
     }
 
-    CloudPoints cp = cloudpointQueue->pop();
     for (int i = 0; i < cloudpointObservers.size(); i++) {
-        cloudpointObservers[i]->update(cp);
+        cloudpointObservers[i]->update(bundle.getCloudPoints());
     }
 
-    ImageData imageData = imageQueue->pop();
     for (int i = 0; i < imageObservers.size(); i++) {
-        imageObservers[i]->update(imageData);
+        imageObservers[i]->update(bundle.getImageData());
     }
 
-    OXT oxt = oxtQueue->pop();
-    for (int i = 0; i < cloudpointObservers.size(); i++) {
-        oxtObservers[i]->update(oxt);
+    for (int i = 0; i < oxtObservers.size(); i++) {
+        oxtObservers[i]->update(bundle.getOXT());
     }
 }
 
 /**
-\brief Load data without thread
+\brief Read and parse every OXT record of the drive. All files, or all archive payloads, are
+requested as one batch.
+*/
 
+void DataLoader::loadOXTTable() {
+    std::vector<IOBackend::Buffer> records;
+    std::string name;
+    if (archive) {
+        std::vector<IOBackend::Range> ranges;
+        for (int i = 0; i < numImages; i++)
+            ranges.push_back(archive->getPayloadRange(i, DriveArchive::OXTS));
+        records = io->readRanges(archive->getFD(), ranges);
+        name = archive->getFilename();
+    } else {
+        char folderPath[500];
+        char filename[500];
+        sprintf(folderPath, "%s/oxts/data", basePath);
+        std::vector<std::string> filenames;
+        for (int i = 0; i < oxtFiles.size(); i++) {
+            sprintf(filename, "%s/%010d.txt", folderPath, oxtFiles[i]);
+            filenames.push_back(filename);
+        }
+        records = io->readBatch(filenames);
+        name = folderPath;
+    }
+
+    if (records.empty()) {
+        printf("No OXT records in %s\n", name.c_str());
+        exit(1);
+    }
+    oxtTable = std::make_shared<OXTTable>(records, name);
+}
+
+/**
+\brief Read the payload of every sensor of a frame.
+
+From a drive archive the whole frame is one read. From a drive folder, velodyne is the
+master timeline and other sensors use the file closest in time, which is the same index
+on synced drives. Only files listed in the drive manifest are read, a frame without a
+tracklet file gets no boxes. All files are requested as one batch.
+
+\param  frameId - id of the frame.
+\return payload of each sensor, indexed by DriveArchive::Sensor.
 */
 
-void DataLoader::loadData(const char* id) {
-    // Load cloudpoints
-    char filename0[400];
-    sprintf(filename0, "%s/%s/%s_drive_%04d_sync/velodyne_points/data/%s.bin", path, date, date, drive, id);
-    loadCloudpoints(cloudpointQueue, filename0);
+std::vector<FrameCache::FileBytes> DataLoader::readFrame(int frameId) {
+    if (archive) {
+        char key[32];
+        sprintf(key, "#%d", frameId);
+        FrameCache::FileBytes frame = frameCache->readRange(archive->getFilename() + key, archive->getFD(), archive->getFrameRange(frameId));
+        std::vector<FrameCache::FileBytes> packed = archive->split(frameId, frame);
+        std::vector<FrameCache::FileBytes> payloads(packed.begin(), packed.begin() + DriveArchive::CAMERA);
+        payloads.resize(DriveArchive::CAMERA + NUM_CAMERA);
+
+        // Images are part of the frame read, only shown ones are kept. Cached ones replace them so they are not decoded.
+        uint32_t cameras = getLoadedCameras();
+        std::vector<std::string> cached;
+        std::vector<int> slots;
+        for (int i = 0; i < NUM_CAMERA; i++) {
+            if (!(cameras & (1 << i)))
+                continue;
+            if (cameraCache && cameraCache->has(i, frameId)) {
+                cached.push_back(cameraCache->getFilename(i, frameId));
+                slots.push_back(DriveArchive::CAMERA + i);
+            } else {
+                payloads[DriveArchive::CAMERA + i] = packed[archive->getCameraSlot(i)];
+            }
+        }
+        if (!cached.empty()) {
+            std::vector<FrameCache::FileBytes> files = frameCache->readFiles(cached);
+            for (int i = 0; i < slots.size(); i++)
+                payloads[slots[i]] = files[i];
+        }
+        return payloads;
+    }
+
+    char filename[500];
+    std::vector<std::string> filenames(DriveArchive::CAMERA + NUM_CAMERA);
 
-    // Load tracklet
-    char filename1[400];
-    sprintf(filename1, "%s/%s/%s_drive_%04d_sync/tracklets/%s.txt", path, date, date, drive, id);
-    loadBBoxes(bboxQueue, filename1);
+    int fileId = frameFiles[frameId];
+    sprintf(filename, "%s/velodyne_points/data/%010d.%s", basePath, fileId, isExtract ? "txt" : "bin");
+    filenames[DriveArchive::VELODYNE] = filename;
 
-    // Load images
-    std::vector<std::string> filenames;
-    for (int i = 0; i < 2; i++) {
-        char filename[400];
-        sprintf(filename, "%s/%s/%s_drive_%04d_sync/image_%02d/data/%s.png", path, date, date, drive, i + 2, id);
-        filenames.push_back(std::string (filename));
+    const DriveManifest::SensorFiles* trackletFiles = manifest->getSensor("tracklets");
+    if (!tracklets && trackletFiles && fileId < trackletFiles->sizes.size() && trackletFiles->sizes[fileId] != DriveManifest::MISSING) {
+        sprintf(filename, "%s/tracklets/%010d.txt", basePath, fileId);
+        filenames[DriveArchive::TRACKLET] = filename;
     }
-    loadTexture(imageQueue, filenames);
 
-    // Load oxts
-    char filename3[400];
-    sprintf(filename3, "%s/%s/%s_drive_%04d_sync/oxts/data/%s.txt", path, date, date, drive, id);
-    loadOXT(oxtQueue, filename3);
+    uint32_t cameras = getLoadedCameras();
+    for (int i = 0; i < NUM_CAMERA; i++) {
+        if (!(cameras & (1 << i)))
+            continue;
+        int imageId = getImageFile(frameId, i);
+        if (cameraCache && cameraCache->has(i, imageId)) {
+            filenames[DriveArchive::CAMERA + i] = cameraCache->getFilename(i, imageId);
+        } else {
+            sprintf(filename, "%s/image_%02d/data/%010d.png", basePath, i, imageId);
+            filenames[DriveArchive::CAMERA + i] = filename;
+        }
+    }
+
+    // Sensors served from drive-wide tables have no file, their slot stays empty.
+    std::vector<std::string> batch;
+    std::vector<int> slots;
+    for (int i = 0; i < filenames.size(); i++) {
+        if (!filenames[i].empty()) {
+            batch.push_back(filenames[i]);
+            slots.push_back(i);
+        }
+    }
+
+    std::vector<FrameCache::FileBytes> files = frameCache->readFiles(batch);
+    std::vector<FrameCache::FileBytes> payloads(filenames.size());
+    for (int i = 0; i < slots.size(); i++)
+        payloads[slots[i]] = files[i];
+    return payloads;
 }
 
 /**
-\brief Load data using thread
+\brief Load data of a frame without thread
 
+\param  frameId - id of the frame to load.
+\param  gen - seek generation the load belongs to.
+\return bundle holding all sensor data of the frame.
 */
 
-void DataLoader::loadDataByThread(const char* id) {
-    std::vector<std::thread*> t;
+FrameBundle DataLoader::loadData(int frameId, int gen) {
+    FrameBundle bundle(frameId, gen);
+    if (getCachedFrame(frameId, gen, bundle))
+        return bundle;
 
-    // Load cloudpoints
-    char filename0[400];
-    sprintf(filename0, "%s/%s/%s_drive_%04d_sync/velodyne_points/data/%s.bin", path, date, date, drive, id);
-    std::string newFilename0(filename0, 400);
-    std::thread thread0 = std::thread(DataLoader::loadCloudpoints, std::ref(cloudpointQueue), newFilename0);
-    t.push_back(&thread0);
+    std::vector<FrameCache::FileBytes> payloads = readFrame(frameId);
+    std::vector<FrameCache::FileBytes> images(payloads.begin() + DriveArchive::CAMERA, payloads.begin() + DriveArchive::CAMERA + NUM_CAMERA);
 
-    // Load tracklet
-    char filename1[400];
-    sprintf(filename1, "%s/%s/%s_drive_%04d_sync/tracklets/%s.txt", path, date, date, drive, id);
-    std::string newFilename1(filename1, 400);
-    std::thread thread1 = std::thread(DataLoader::loadBBoxes, std::ref(bboxQueue), newFilename1);
-    t.push_back(&thread1);
+    loadCloudpoints(this, &bundle, payloads[DriveArchive::VELODYNE]);
+    loadBBoxes(this, &bundle, payloads[DriveArchive::TRACKLET]);
+    loadTexture(this, &bundle, images);
+    loadOXT(this, &bundle);
 
-    // Load images
-    std::vector<std::string> filenames;
-    for (int i = 0; i < 2; i++) {
-        char filename[400];
-        sprintf(filename, "%s/%s/%s_drive_%04d_sync/image_%02d/data/%s.png", path, date, date, drive, i + 2, id);
-        filenames.push_back(std::string(filename));
-    }
-    std::thread thread2 = std::thread(DataLoader::loadTexture, std::ref(imageQueue), filenames);
-    t.push_back(&thread2);
+    frameCache->putFrame(bundle);
+    return bundle;
+}
 
-    // Load oxts
-    char filename3[400];
-    sprintf(filename3, "%s/%s/%s_drive_%04d_sync/oxts/data/%s.txt", path, date, date, drive, id);
-    std::string newFilename(filename3);
-    std::thread thread3 = std::thread(DataLoader::loadOXT, std::ref(oxtQueue), filename3);
-    t.push_back(&thread3);
+/**
+\brief Load data of a frame using thread
+
+All sensor files are read first, then each sensor is decoded by its own thread into its
+own slot of the bundle. Frames still in the cache are returned without touching disk.
+
+\param  frameId - id of the frame to load.
+\param  gen - seek generation the load belongs to.
+\return bundle holding all sensor data of the frame.
+*/
+
+FrameBundle DataLoader::loadDataByThread(int frameId, int gen) {
+    FrameBundle bundle(frameId, gen);
+    if (getCachedFrame(frameId, gen, bundle) || isStale(&bundle))
+        return bundle;
+
+    std::vector<FrameCache::FileBytes> payloads = readFrame(frameId);
+    std::vector<FrameCache::FileBytes> images(payloads.begin() + DriveArchive::CAMERA, payloads.begin() + DriveArchive::CAMERA + NUM_CAMERA);
+
+    std::vector<std::thread> t;
+    t.push_back(std::thread(DataLoader::loadCloudpoints, this, &bundle, payloads[DriveArchive::VELODYNE]));
+    t.push_back(std::thread(DataLoader::loadBBoxes, this, &bundle, payloads[DriveArchive::TRACKLET]));
+    t.push_back(std::thread(DataLoader::loadTexture, this, &bundle, images));
+    loadOXT(this, &bundle);
 
     // Join threads
     for (int i = 0; i < t.size(); i++) {
-        if (t[i]->joinable())
-            t[i]->join();
+        if (t[i].joinable())
+            t[i].join();
     }
+
+    frameCache->putFrame(bundle);
+    return bundle;
 }
 
 /**
-\brief Threaded function to oxt;
+\brief Pick the OXT record of a frame from the drive table.
 
-\param  queue - The queue to put data into.
-\param  filename - name of cloudpoint file.
+\param  dl - reference to main DataLoader object, used to skip cancelled loads.
+\param  bundle - The bundle to put data into.
 */
 
-void* DataLoader::loadOXT(SafeQueue<OXT>* queue, std::string filename) {
-    if (queue->size() == QUEUE_SIZE) {
-        queue->pop();
+void DataLoader::loadOXT(DataLoader* dl, FrameBundle* bundle) {
+    if (dl->isStale(bundle)) return;
+    bundle->setOXT(std::make_shared<OXT>(dl->oxtTable, dl->getOXTRecord(bundle->getFrameID())));
+}
+
+/**
+\brief Get the OXT record of a frame. Records are matched to velodyne time in a drive folder
+and stored per frame in a drive archive.
+*/
+
+int DataLoader::getOXTRecord(int frameId) const {
+    int record = archive ? frameId : oxtTimes->nearest(velodyneTimes->get(frameId));
+    return std::min(record, oxtTable->getNumRecords() - 1);
+}
+
+/**
+\brief Read and decode the sweep of a frame for the map builder, on its thread.
+
+\param  frameId - id of the frame.
+\param  filter - stages the sweep is trimmed by.
+*/
+
+std::shared_ptr<const CloudPoints> DataLoader::loadMapSweep(int frameId, std::shared_ptr<const PointFilter> filter) {
+    IOBackend::Buffer bytes;
+    if (archive) {
+        bytes = io->readRanges(archive->getFD(), {archive->getPayloadRange(frameId, DriveArchive::VELODYNE)})[0];
+    } else {
+        char filename[500];
+        sprintf(filename, "%s/velodyne_points/data/%010d.%s", basePath, frameFiles[frameId], isExtract ? "txt" : "bin");
+        bytes = io->read(filename);
     }
-    queue->push(OXT(filename));
+    return std::make_shared<CloudPoints>(bytes->getData(), bytes->getSize(), isExtract, filter);
 }
 
 
 /**
-\brief Threaded function to load cloudpoints;
+\brief Threaded function to decode cloudpoints;
+
+\param  dl - reference to main DataLoader object, used to skip cancelled loads.
+\param  bundle - The bundle to put data into.
+\param  bytes - content of cloudpoint file.
+*/
+
+void DataLoader::loadCloudpoints(DataLoader* dl, FrameBundle* bundle, FrameCache::FileBytes bytes) {
+    if (dl->isStale(bundle)) return;
+    std::shared_ptr<CloudPoints> cp = std::make_shared<CloudPoints>(bytes->getData(), bytes->getSize(), dl->isExtract, dl->getPointFilterPtr());
+    cp->setFrameID(bundle->getFrameID());
+    bundle->setCloudPoints(cp);
+}
+
+/**
+\brief Threaded function to decode bboxes. With a tracklet store the boxes are a slice of
+it and bytes is unused.
 
-\param  queue - The queue to put data into.
-\param  filename - name of cloudpoint file.
+\param  dl - reference to main DataLoader object, used to skip cancelled loads.
+\param  bundle - The bundle to put data into.
+\param  bytes - content of tracklet file.
 */
 
-void* DataLoader::loadCloudpoints(SafeQueue<CloudPoints>* queue, std::string filename) {
-    if (queue->size() == QUEUE_SIZE) {
-        queue->pop();
+void DataLoader::loadBBoxes(DataLoader* dl, FrameBundle* bundle, FrameCache::FileBytes bytes) {
+    if (dl->isStale(bundle)) return;
+    if (dl->tracklets) {
+        int fileId = dl->archive ? dl->archive->getFileID(bundle->getFrameID()) : dl->frameFiles[bundle->getFrameID()];
+        bundle->setBoxList(std::make_shared<BoxList>(dl->tracklets, fileId));
+        return;
     }
-    queue->push(CloudPoints(filename));
+    if (!bytes) {
+        bundle->setBoxList(std::make_shared<BoxList>("", 0));
+        return;
+    }
+    bundle->setBoxList(std::make_shared<BoxList>(bytes->getData(), bytes->getSize()));
 }
 
 /**
-\brief Threaded function to load bboxes.
+\brief Threaded function to decode texture;
 
-\param  queue - The queue to put data into.
-\param  filename - name of tracklet file.
+\param  dl - reference to main DataLoader object, used to skip cancelled loads.
+\param  bundle - The bundle to put data into.
+\param  files - content of image files.
 */
 
-void* DataLoader::loadBBoxes(SafeQueue<BoxList>* queue, std::string filename) {
-    if (queue->size() == QUEUE_SIZE) {
-        queue->pop();
+void DataLoader::loadTexture(DataLoader* dl, FrameBundle* bundle, std::vector<FrameCache::FileBytes> files)
+{
+    if (dl->isStale(bundle)) return;
+    int viewWidth = dl->imageViewWidth;
+    int viewHeight = dl->imageViewHeight;
+    std::vector<std::shared_ptr<const CameraFrame> > decoded;
+    bundle->setImageData(std::make_shared<ImageData>(files, viewWidth, viewHeight, dl->cameraCache ? &decoded : NULL));
+
+    // Images decoded from PNG are handed to the camera cache at full resolution, which writes them in background.
+    for (int i = 0; i < decoded.size(); i++) {
+        if (decoded[i])
+            dl->cameraCache->put(i, dl->getImageFile(bundle->getFrameID(), i), decoded[i]);
     }
-    queue->push(BoxList(filename));
 }
 
 /**
-\brief Threaded function to load texture;
+\brief Get number of complete frames waiting in queue.
+
+\return number of frames in queue.
+*/
+
+int DataLoader::queueSize()
+{
+    return frameQueue->size();
+}
+
+/**
+\brief Get queue level at which worker starts refilling.
+*/
+
+int DataLoader::lowWaterMark() const
+{
+    return prefetchDepth / 2;
+}
+
+/**
+\brief Add a load time sample to the smoothed per-frame load latency.
+
+\param  seconds - wall time it took to load one frame.
+*/
+
+void DataLoader::recordLoadLatency(double seconds)
+{
+    loadLatency = LATENCY_SMOOTHING * seconds + (1 - LATENCY_SMOOTHING) * loadLatency;
+}
+
+/**
+\brief Adapt prefetch depth and frame stride to load latency and playback speed.
 
-\param  queue - The queue to put data into.
-\param  filename - name of cloudpoint file.
+If a frame takes longer to load than playback spends on it, the worker only loads every
+n-th frame, so it never decodes frames that would be dropped anyway. The queue holds
+enough loaded frames to ride out a few slow loads: slow storage or fast playback get a
+deeper queue, fast storage a shallow one.
 */
 
-void* DataLoader::loadTexture(SafeQueue<ImageData>* queue, std::vector<std::string> filenames)
+void DataLoader::updatePrefetchPolicy()
 {
+    double rate = sensorRate * playbackSpeed;       // Frames per second the clock passes.
+    int stride = std::max(1, (int)ceil(loadLatency * rate * LOAD_HEADROOM));
+    stride = std::min(stride, std::max(1, numImages / 4));
+
+    double bufferSeconds = std::min(std::max(LATENCY_BUFFER * loadLatency, MIN_BUFFER_SECONDS), MAX_BUFFER_SECONDS);
+    int depth = (int)ceil(rate / stride * bufferSeconds) + 1;
+
+    prefetchDepth = std::min(std::max(depth, MIN_QUEUE_SIZE), MAX_QUEUE_SIZE);
+    frameStride = stride;
+}
+
+/**
+\brief Look up a decoded frame, skipping frames whose images were decoded for another view
+size or lack a camera now shown.
+
+\param  frameId - id of the frame.
+\param  gen - seek generation the load belongs to.
+\param  bundle - receives the frame on hit.
+\return true if the frame can be shown as is.
+*/
+
+bool DataLoader::getCachedFrame(int frameId, int gen, FrameBundle& bundle)
+{
+    if (!frameCache->getFrame(frameId, gen, bundle))
+        return false;
+    std::shared_ptr<const ImageData> images = bundle.getImageData();
+    uint32_t cameras = getLoadedCameras();
+    bool isFiltered = bundle.getCloudPoints()->getFilter() == getPointFilterPtr();
+    if (isFiltered && images->isViewSize(imageViewWidth, imageViewHeight) && (images->getCameraMask() & cameras) == cameras)
+        return true;
+
+    bundle = FrameBundle(frameId, gen);
+    return false;
+}
+
+/**
+\brief Check if a bundle was requested before the latest seek.
 
-    if (queue->size() == QUEUE_SIZE)
-        queue->pop();
+\param  bundle - bundle to check.
+\return True if the bundle must be dropped.
+*/
 
-    queue->push(ImageData(filenames));
+bool DataLoader::isStale(const FrameBundle* bundle) const
+{
+    return bundle->getGeneration() != generation;
 }
 
 /**
-\brief Get minimum number of item in all queues.
+\brief Wake up worker thread so it re-checks queue levels.
+
+The worker mutex is taken before notifying so a wake up can not slip in between
+the worker checking its condition and going to sleep.
 
-\return minSize - minimum items in all queue.
+\param  forceWake - if true, worker runs a refill pass even if queues are above low-water mark.
 */
 
+void DataLoader::signalWorker(bool forceWake)
+{
+    {
+        std::lock_guard<std::mutex> lock(workerMutex);
+        if (forceWake)
+            isWakeRequested = true;
+    }
+    workerCond.notify_one();
+}
+
+/**
+\brief Wrap a frame id into the drive, playback loops around both ends.
+*/
+
+int DataLoader::wrapFrame(int frameId) const
+{
+    return ((frameId % numImages) + numImages) % numImages;
+}
+
+/**
+\brief Request the frames the worker will publish next from the scheduler.
+
+The frame to publish next goes first, as SEEK right after a jump. Frames due before the
+queue drains to its low-water mark are near prefetch, the rest of the window is
+speculative. Requests outside the window, e.g. left over from an older frame stride,
+are cancelled.
+
+\param  startID - frame to publish next.
+\param  direction - direction worker walks frames in, 1 or -1.
+\param  gen - seek generation the loads belong to.
+\param  isSeek - true if startID is the target of a jump.
+*/
 
-int DataLoader::minQueueSize()
+void DataLoader::schedulePrefetch(int startID, int direction, int gen, bool isSeek)
 {
-    int minSize = std::max(cloudpointQueue->size(), oxtQueue->size());
-    minSize = std::min(minSize, bboxQueue->size());
-    minSize = std::min(minSize, imageQueue->size());
+    int stride = frameStride;
+    int count = std::max(1, prefetchDepth - queueSize());
+    int near = std::max(1, lowWaterMark());
+
+    std::vector<int> window;
+    int frame = startID;
+    for (int i = 0; i < count; i++)
+    {
+        LoadScheduler::Priority priority = LoadScheduler::SPECULATIVE;
+        if (i == 0)
+            priority = isSeek ? LoadScheduler::SEEK : LoadScheduler::NEAR_PREFETCH;
+        else if (i < near)
+            priority = LoadScheduler::NEAR_PREFETCH;
+
+        scheduler->submit(frame, gen, priority);
+        window.push_back(frame);
+        frame = wrapFrame(frame + direction * stride);
+    }
+    scheduler->retain(window);
+}
 
-    return minSize;
+/**
+\brief Print loader request latencies of each priority class and I/O throughput.
+*/
+
+void DataLoader::printStats()
+{
+    scheduler->printStats();
+    io->printStats();
 }
 
 /**
 \brief Public API for runThreadWorker function.
+
+Frames are not preloaded here, the worker starts filling the queue right away and the
+first frame is displayed as soon as it is ready.
 */
 
 void DataLoader::runWorker()
 {
     if (!workerThread.joinable())
     {
-        for (int i = 0; i < QUEUE_SIZE; i++)
-        {
-            char id[300];
-            sprintf(id, "%010d", i);
-            const char* constId = &id[0];\
-            loadDataByThread(constId);\
-        }
-
         DataLoader* itself = this;
-        int num = QUEUE_SIZE;
-        workerThread = std::thread(DataLoader::runWorkerThread, itself, std::ref(isStop), numImages, num);
+        workerThread = std::thread(DataLoader::runWorkerThread, itself, std::ref(isStop), numImages, 0);
     }
 }
 
 /**
 \brief Run data loader worker thread which will fill all queues to reduce latency.
 
+The thread sleeps until the consumer drains the queue down to the low-water mark, or until
+it is woken up by stop, seek or playback speed change. It then keeps the scheduler busy
+with the prefetch window and publishes loaded frames in playback order until the queue
+holds prefetch depth frames. If the consumer runs dry while the worker waits for a frame,
+that frame is raised to VISIBLE. Depth and frame stride are re-evaluated after every
+frame. A seek aborts the refill pass and restarts it from the seek target.
+
 \param  dl - reference to main DataLoader object.
 \param  isStop - reference boolean used to gracefully terminate thread.
 \param  numImages - Maximum image id.
 \param  startIndex - Start index of image id.
 */
 
-void* DataLoader::runWorkerThread(DataLoader* dl, bool& isStop, int numImages, int startID)
+void* DataLoader::runWorkerThread(DataLoader* dl, std::atomic<bool>& isStop, int numImages, int startID)
 {
     int cnt = startID;
+    int direction = 1;
+    bool isSeek = true;
     while (!isStop) {
-        int minSize = dl->minQueueSize();
-        if (minSize <= MIN_FILL)
+        int gen;
+        {
+            std::unique_lock<std::mutex> lock(dl->workerMutex);
+            dl->workerCond.wait(lock, [&]() {
+                return isStop || dl->isWakeRequested || dl->queueSize() <= dl->lowWaterMark();
+            });
+            dl->isWakeRequested = false;
+
+            if (dl->seekTarget >= 0)
+            {
+                cnt = dl->seekTarget;
+                dl->seekTarget = -1;
+                isSeek = true;
+            }
+            direction = dl->prefetchDirection;
+            gen = dl->generation;
+        }
+        dl->updatePrefetchPolicy();
+
+        while (!isStop && gen == dl->generation && dl->queueSize() < dl->prefetchDepth)
         {
-            char id[300];
-            sprintf(id, "%010d", cnt);
-            const char* constId = &id[0];
-            dl->loadData(constId);
-            cnt = (cnt + 1) % numImages;
+            dl->schedulePrefetch(cnt, direction, gen, isSeek);
+
+            FrameBundle bundle;
+            double loadSeconds = 0;
+            bool isTaken = false;
+            {
+                std::unique_lock<std::mutex> lock(dl->workerMutex);
+                while (!isStop && gen == dl->generation && !(isTaken = dl->scheduler->take(cnt, gen, bundle, &loadSeconds)))
+                {
+                    // Display is waiting for this very frame.
+                    if (!isSeek && dl->queueSize() == 0)
+                        dl->scheduler->submit(cnt, gen, LoadScheduler::VISIBLE);
+                    dl->workerCond.wait(lock);
+                }
+            }
+            if (!isTaken)
+                break;
+
+            if (bundle.isComplete() && !dl->isStale(&bundle))
+                dl->frameQueue->tryPush(std::move(bundle));
+
+            // Loads run in parallel, so each one costs playback only a share of its time.
+            dl->recordLoadLatency(loadSeconds / dl->scheduler->getNumPrefetchThreads());
+            dl->updatePrefetchPolicy();
+
+            cnt = dl->wrapFrame(cnt + direction * dl->frameStride);
+            isSeek = false;
         }
     }
 }
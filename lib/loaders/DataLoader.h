@@ -11,18 +11,35 @@
 #include <queue>
 #include <vector>
 #include <thread>
-#include <dirent.h>
+#include <chrono>
+#include <math.h>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
 #include <sys/types.h>
 
 #include "PointsLoader.h"
 #include "BoxLoader.h"
+#include "ConfigLoader.h"
+#include "FrameCache.h"
+#include "LoadScheduler.h"
+#include "DriveArchive.h"
+#include "DriveManifest.h"
+#include "CameraCache.h"
+#include "MapBuilder.h"
 
 #include "../layouts/SubWindow.h"
-#include "../utils/SafeQueue.h"
+#include "../utils/RingBuffer.h"
+#include "../utils/PlaybackClock.h"
+#include "../data/Timestamps.h"
 #include "../data/OXT.h"
+#include "../data/OXTTable.h"
 #include "../data/BoxList.h"
+#include "../data/TrackletStore.h"
 #include "../data/CloudPoints.h"
+#include "../data/PointFilter.h"
 #include "../data/ImageData.h"
+#include "../data/FrameBundle.h"
 #include "../objects/Gauge.h"
 
 class DataLoader
@@ -31,14 +48,37 @@ class DataLoader
         ~DataLoader();
 
         static DataLoader* getInstance();
-        static const int QUEUE_SIZE = 20;
-        static const int MIN_FILL = 10;
+        static const int MIN_QUEUE_SIZE = 4;      ///< Smallest prefetch depth in frames.
+        static const int MAX_QUEUE_SIZE = 64;     ///< Largest prefetch depth in frames, also capacity of frame queue.
+
+        static const int NUM_CAMERA = 4;      ///< KITTI cameras, image_00 to image_03.
 
         void nextID();
         void update();
-        void setFPS(int nfps);
         void setPlayingVideo(bool val);
 
+        void setPlaybackSpeed(float speed);
+        float getPlaybackSpeed() const;
+        void setReverse(bool val);
+        bool isReverse() const;
+
+        void setImageViewSize(int width, int height);
+        void setVisibleCameras(uint32_t mask);
+        void setPointFilter(const PointFilter::Settings& settings);
+        PointFilter::Settings getPointFilter();
+
+        int getPrefetchDepth() const;
+        int getFrameStride() const;
+        void printStats();
+
+        void seek(int frameId);
+        int getCurrentFrame() const;
+        int getNumFrames() const;
+
+        void buildMap();
+        bool isMapReady();
+        std::string getMapFilename() const;
+
         void attach(Observer<CloudPoints>*);
         void attach(Observer<OXT>*);
         void attach(Observer<BoxList>*);
@@ -49,45 +89,106 @@ class DataLoader
     private:
         DataLoader();
 
-        char path[100] = "/media/nghia/TOSHIBA EXT/datasets/kitti";
-        char date[20] = "2011_09_26";
-        int drive = 1;
+        static const int NUM_LOAD_THREADS = 3;      ///< Frames loaded concurrently, one thread is reserved for urgent frames.
+
+        static constexpr float MAX_TICK = 0.25;     ///< Longest wall time a single tick may advance playback by.
+
+        static constexpr double LATENCY_SMOOTHING = 0.2;    ///< Weight of newest sample in load latency average.
+        static constexpr double LOAD_HEADROOM = 1.2;        ///< Loads must finish this much faster than playback consumes frames.
+        static constexpr double LATENCY_BUFFER = 4;         ///< Prefetch covers this many load latencies of playback...
+        static constexpr double MIN_BUFFER_SECONDS = 0.5;   ///< ...but at least this long...
+        static constexpr double MAX_BUFFER_SECONDS = 3;     ///< ...and at most this long.
+
+        char basePath[400];         ///< Drive folder, from ConfigLoader.
+        bool isExtract = false;     ///< Flag for unsynced "extract" drive layout.
 
-        int cnt = 0;
         int numImages = 0;          ///< Total number of frames in a video.
-        int fps = 10;                ///< Frequency.
+        double sensorRate = 10;     ///< Frames per second of the recording.
         bool isPlayingVideo = false;    ///< Flag indicating if broadcasting image id.
         bool isLoaded = false;          ///< Flag indicating if data is loaded.
-        bool isStop = false;
+        int currentFrame = -1;          ///< Id of the frame currently displayed.
+        std::atomic<bool> isStop;       ///< Flag used to gracefully terminate worker thread.
+        std::atomic<int> generation;    ///< Bumped on every seek, loads from older generations are dropped.
+
+        PlaybackClock playbackClock;            ///< Drive time driving frame selection.
+        sf::Clock tickClock;                    ///< Wall time since last tick.
+        Timestamps* velodyneTimes;              ///< Master timeline, one sample per frame.
+        Timestamps* imageTimes[NUM_CAMERA];     ///< NULL when reading a drive archive.
+        Timestamps* oxtTimes;                   ///< NULL when reading a drive archive.
 
         static DataLoader* mInstance;
         std::thread workerThread;
+        std::mutex workerMutex;                 ///< Guards worker sleep/wake state.
+        std::condition_variable workerCond;     ///< Signaled when worker should re-check queue level.
+        bool isWakeRequested = false;           ///< Flag forcing worker to wake up regardless of queue level.
+        int seekTarget = -1;                    ///< Frame worker must load next, -1 if no seek is pending.
+        int prefetchDirection = 1;              ///< Direction worker walks frames in, 1 or -1.
+
+        double loadLatency = 0.05;              ///< Smoothed wall time to load one frame, worker thread only.
+        std::atomic<float> playbackSpeed;       ///< Copy of playback speed readable by worker.
+        std::atomic<int> prefetchDepth;         ///< High-water mark in frames, low-water mark is half of it.
+        std::atomic<int> frameStride;           ///< Worker loads every frameStride-th frame when it can not keep up.
+        std::atomic<int> imageViewWidth;        ///< Size camera images are decoded for, 0 for full resolution.
+        std::atomic<int> imageViewHeight;
+        std::atomic<uint32_t> visibleCameras;   ///< Cameras shown, bit i for image_0i.
+        uint32_t availableCameras = 0;          ///< Cameras the drive has images of.
+        std::mutex filterMutex;                 ///< Guards pointFilter, read by loader threads.
+        std::shared_ptr<const PointFilter> pointFilter;     ///< Trims new sweeps, replaced as a whole when changed.
 
         std::vector<Observer<CloudPoints>*> cloudpointObservers;
         std::vector<Observer<ImageData>*> imageObservers;
         std::vector<Observer<BoxList>*> bboxObservers;
         std::vector<Observer<OXT>*> oxtObservers;
 
-        SafeQueue<CloudPoints>* cloudpointQueue;
-        SafeQueue<ImageData>* imageQueue;
-        SafeQueue<BoxList>* bboxQueue;
-        SafeQueue<OXT>* oxtQueue;
-
-        void notify();
+        RingBuffer<FrameBundle>* frameQueue;    ///< Complete frames handed from worker to render thread, at most prefetchDepth.
+        IOBackend* io;                          ///< Reads sensor files, selected by `io` in conf.txt.
+        DriveArchive* archive = NULL;           ///< Packed drive, NULL when reading the drive folder.
+        DriveManifest* manifest = NULL;         ///< Files of drive folder, NULL when reading a drive archive.
+        std::vector<int> frameFiles;            ///< Velodyne file id of each frame, drive folder only.
+        std::vector<int> imageFiles[NUM_CAMERA];    ///< File id of each image time, drive folder only.
+        std::vector<int> oxtFiles;              ///< File id of each OXT record, drive folder only.
+        std::shared_ptr<const TrackletStore> tracklets;     ///< From tracklet_labels.xml, NULL to read per-frame tracklet files.
+        std::shared_ptr<const OXTTable> oxtTable;           ///< Every OXT record of the drive, one per frame in a drive archive.
+        FrameCache* frameCache;                 ///< Recently loaded frames and files, so replaying and scrubbing skip disk.
+        CameraCache* cameraCache = NULL;        ///< Transcoded camera frames on disk, NULL unless enabled in conf.txt.
+        MapBuilder* mapBuilder = NULL;          ///< Builds the map of the drive, NULL unless being built.
+        bool isMapOnDisk = false;               ///< Map was found or built, checked only when asked for or once built.
+        LoadScheduler* scheduler;               ///< Loader threads, serving frames by priority.
+
+        bool notify(int targetFrame);
+        void dispatch(const FrameBundle& bundle);
 
         void pop();
-
-        void loadData(const char* id);
-        void loadDataByThread(const char* id);
-
-        int minQueueSize();
-
-        static void* loadCloudpoints(SafeQueue<CloudPoints>*, std::string);
-        static void* loadTexture(SafeQueue<ImageData>*, std::vector<std::string> filenames);
-        static void* loadBBoxes(SafeQueue<BoxList>* queue, std::string filename);
-        static void* loadOXT(SafeQueue<OXT>* queue, std::string filename);
-
-        static void* runWorkerThread(DataLoader* dl, bool& isStop, int numImages, int startID);
+        void flush();
+
+        int framesAhead(int frame, int reference) const;
+        int getImageFile(int frameId, int camera) const;
+        uint32_t getLoadedCameras() const;
+        std::shared_ptr<const PointFilter> getPointFilterPtr();
+        void loadOXTTable();
+        int getOXTRecord(int frameId) const;
+        std::shared_ptr<const CloudPoints> loadMapSweep(int frameId, std::shared_ptr<const PointFilter> filter);
+
+        std::vector<FrameCache::FileBytes> readFrame(int frameId);
+        FrameBundle loadData(int frameId, int gen);
+        FrameBundle loadDataByThread(int frameId, int gen);
+
+        int queueSize();
+        int lowWaterMark() const;
+        void recordLoadLatency(double seconds);
+        void updatePrefetchPolicy();
+        bool isStale(const FrameBundle* bundle) const;
+        bool getCachedFrame(int frameId, int gen, FrameBundle& bundle);
+        void signalWorker(bool forceWake);
+        void schedulePrefetch(int startID, int direction, int gen, bool isSeek);
+        int wrapFrame(int frameId) const;
+
+        static void loadCloudpoints(DataLoader* dl, FrameBundle* bundle, FrameCache::FileBytes bytes);
+        static void loadTexture(DataLoader* dl, FrameBundle* bundle, std::vector<FrameCache::FileBytes> files);
+        static void loadBBoxes(DataLoader* dl, FrameBundle* bundle, FrameCache::FileBytes bytes);
+        static void loadOXT(DataLoader* dl, FrameBundle* bundle);
+
+        static void* runWorkerThread(DataLoader* dl, std::atomic<bool>& isStop, int numImages, int startID);
 };
 
 #endif // DATALOADER_H
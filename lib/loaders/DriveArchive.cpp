@@ -0,0 +1,217 @@
+#include "DriveArchive.h"
+
+const char DriveArchive::MAGIC[4] = {'K', 'V', 'P', 'K'};
+const uint32_t DriveArchive::VERSION;
+const uint32_t DriveArchive::MIN_VERSION;
+const uint32_t DriveArchive::MAX_CAMERAS;
+const uint32_t DriveArchive::FLAG_TEXT_VELODYNE;
+const uint32_t DriveArchive::FLAG_ENCODED_VELODYNE;
+const uint64_t DriveArchive::PAYLOAD_ALIGNMENT;
+
+/**
+\brief Constructor
+
+Opens archive through the I/O backend and reads header, timestamps and index.
+Terminates if archive is not valid.
+
+\param filename - path of the archive.
+\param io - backend used to open the archive.
+*/
+
+DriveArchive::DriveArchive(std::string filename, IOBackend* io) : filename(filename)
+{
+    size_t size;
+    fd = io->openArchive(filename, size);
+
+    readMetadata(&header, sizeof(header), 0);
+    bool isValid = memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version >= MIN_VERSION &&
+                   header.version <= VERSION && header.numCameras <= MAX_CAMERAS;
+    if (isValid && header.version == 1)
+        header.cameras = ((1u << header.numCameras) - 1) << 2;
+    if (!isValid || (uint32_t)__builtin_popcount(header.cameras) != header.numCameras || (header.cameras >> MAX_CAMERAS) != 0)
+    {
+        printf("Not a drive archive or unsupported version: %s\n", filename.c_str());
+        exit(1);
+    }
+
+    times.resize(header.numFrames);
+    index.resize((size_t)header.numFrames * getNumSensors());
+    readMetadata(times.data(), times.size() * sizeof(double), header.timesOffset);
+    fileIds.resize(header.numFrames);
+    if (header.version >= 3)
+        readMetadata(fileIds.data(), fileIds.size() * sizeof(uint32_t), header.timesOffset + times.size() * sizeof(double));
+    else
+    {
+        for (int i = 0; i < fileIds.size(); i++)
+            fileIds[i] = i;
+    }
+    readMetadata(index.data(), index.size() * sizeof(Entry), header.indexOffset);
+
+    for (int i = 0; i < index.size(); i++)
+    {
+        if (index[i].offset + index[i].size > size)
+        {
+            printf("Drive archive is truncated: %s\n", filename.c_str());
+            exit(1);
+        }
+    }
+}
+
+DriveArchive::~DriveArchive()
+{
+    close(fd);
+}
+
+/**
+\brief Check if an archive file exists.
+
+\param filename - path of the archive.
+*/
+
+bool DriveArchive::exists(std::string filename)
+{
+    struct stat st;
+    return stat(filename.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+}
+
+/**
+\brief Read a part of the archive that is not frame data. Done with plain pread, since the
+descriptor may be opened with O_DIRECT, which only allows aligned reads, a temporary
+descriptor is used.
+*/
+
+void DriveArchive::readMetadata(void* data, size_t size, uint64_t offset)
+{
+    FILE* fin = fopen(filename.c_str(), "rb");
+    if (!fin || fseeko(fin, offset, SEEK_SET) != 0 || fread(data, 1, size, fin) != size)
+    {
+        printf("Could not read drive archive: %s\n", filename.c_str());
+        exit(1);
+    }
+    fclose(fin);
+}
+
+std::string DriveArchive::getFilename() const
+{
+    return filename;
+}
+
+int DriveArchive::getFD() const
+{
+    return fd;
+}
+
+int DriveArchive::getNumFrames() const
+{
+    return header.numFrames;
+}
+
+int DriveArchive::getNumCameras() const
+{
+    return header.numCameras;
+}
+
+/**
+\brief Get packed cameras, bit i is set if image_0i is packed.
+*/
+
+uint32_t DriveArchive::getCameraMask() const
+{
+    return header.cameras;
+}
+
+/**
+\brief Get sensor index of a camera in a frame.
+
+\param camera - KITTI camera number, 0 for image_00.
+\return CAMERA plus number of packed cameras before it, -1 if the camera is not packed.
+*/
+
+int DriveArchive::getCameraSlot(int camera) const
+{
+    if (camera < 0 || camera >= 32 || !(header.cameras & (1u << camera)))
+        return -1;
+    return CAMERA + __builtin_popcount(header.cameras & ((1u << camera) - 1));
+}
+
+int DriveArchive::getNumSensors() const
+{
+    return CAMERA + header.numCameras;
+}
+
+/**
+\brief Get number of the velodyne file a frame was packed from, tracklets are numbered alike.
+
+\param frameId - id of the frame.
+*/
+
+int DriveArchive::getFileID(int frameId) const
+{
+    return fileIds[frameId];
+}
+
+bool DriveArchive::isTextVelodyne() const
+{
+    return header.flags & FLAG_TEXT_VELODYNE;
+}
+
+/**
+\brief Get velodyne time of every frame.
+*/
+
+const std::vector<double>& DriveArchive::getTimes() const
+{
+    return times;
+}
+
+/**
+\brief Get byte range holding all sensors of a frame.
+
+\param frameId - id of the frame.
+*/
+
+IOBackend::Range DriveArchive::getFrameRange(int frameId) const
+{
+    const Entry* entries = &index[(size_t)frameId * getNumSensors()];
+    IOBackend::Range range;
+    range.offset = entries[0].offset;
+    range.size = entries[getNumSensors() - 1].offset + entries[getNumSensors() - 1].size - range.offset;
+    return range;
+}
+
+/**
+\brief Get byte range of a single sensor payload of a frame.
+
+\param frameId - id of the frame.
+\param sensor - a Sensor, CAMERA + i for camera i.
+*/
+
+IOBackend::Range DriveArchive::getPayloadRange(int frameId, int sensor) const
+{
+    const Entry& entry = index[(size_t)frameId * getNumSensors() + sensor];
+    IOBackend::Range range;
+    range.offset = entry.offset;
+    range.size = entry.size;
+    return range;
+}
+
+/**
+\brief Split a frame read with getFrameRange into the payload of each sensor. Payloads point
+into the frame buffer and keep it alive, nothing is copied.
+
+\param frameId - id of the frame.
+\param frame - content of the frame range.
+\return payload of each sensor, indexed by Sensor.
+*/
+
+std::vector<IOBackend::Buffer> DriveArchive::split(int frameId, IOBackend::Buffer frame) const
+{
+    const Entry* entries = &index[(size_t)frameId * getNumSensors()];
+    std::vector<IOBackend::Buffer> payloads;
+    for (int i = 0; i < getNumSensors(); i++)
+    {
+        char* data = const_cast<char*>(frame->getData()) + (entries[i].offset - entries[0].offset);
+        payloads.push_back(std::make_shared<FileBuffer>(data, entries[i].size, [frame]() {}));
+    }
+    return payloads;
+}
@@ -0,0 +1,105 @@
+#ifndef DRIVEARCHIVE_H
+#define DRIVEARCHIVE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <sys/stat.h>
+
+#include "../utils/IOBackend.h"
+
+/**
+\class DriveArchive
+
+\brief A whole drive packed into one file by kittiviz-pack, read in place of the drive folder.
+
+Layout, all integers little endian:
+- Header.
+- Velodyne timestamps, one double per frame, seconds of day.
+- Velodyne file number of each frame, one u32 per frame, right after the timestamps. Frames
+  are the sweeps a drive has, the numbers keep tracklets matched across missing sweeps.
+- Frames. Each frame starts at a PAYLOAD_ALIGNMENT boundary and holds the payload of every
+  sensor back to back, in Sensor order. Payloads are the unmodified KITTI files, except for
+  sweeps when FLAG_ENCODED_VELODYNE is set, which are encoded by PointCodec. Camera and
+  OXT samples are already matched to the velodyne sweep of the frame.
+- Index, one Entry per sensor per frame, frame major.
+
+Version 1 archives are still read, their cameras start at image_02. Versions 1 and 2 have no
+file numbers, frame i is file i.
+
+A frame is thus read with one large sequential read.
+
+*/
+
+class DriveArchive
+{
+    public:
+        enum Sensor
+        {
+            VELODYNE,       ///< Sweep, binary floats or text on extract drives.
+            TRACKLET,       ///< Tracklet boxes as written by parser.py, may be empty.
+            OXTS,           ///< GPS/IMU record.
+            CAMERA          ///< PNGs of packed cameras follow in camera order, see getCameraSlot.
+        };
+
+        static const char MAGIC[4];
+        static const uint32_t VERSION = 3;
+        static const uint32_t MIN_VERSION = 1;              ///< Version 1 packs cameras from image_02 on, without camera mask.
+        static const uint32_t MAX_CAMERAS = 4;              ///< KITTI cameras image_00 to image_03.
+        static const uint32_t FLAG_TEXT_VELODYNE = 1;       ///< Sweeps are text, from an extract drive.
+        static const uint32_t FLAG_ENCODED_VELODYNE = 2;    ///< Sweeps are encoded by PointCodec.
+        static const uint64_t PAYLOAD_ALIGNMENT = 4096;     ///< Frames start at multiples of this.
+
+        struct Header
+        {
+            char magic[4];
+            uint32_t version;
+            uint32_t numFrames;
+            uint32_t numCameras;
+            uint32_t flags;
+            uint32_t cameras;       ///< Bit i is set if image_0i is packed.
+            uint64_t timesOffset;
+            uint64_t indexOffset;
+        };
+
+        struct Entry
+        {
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        DriveArchive(std::string filename, IOBackend* io);
+        ~DriveArchive();
+
+        static bool exists(std::string filename);
+
+        std::string getFilename() const;
+        int getFD() const;
+        int getNumFrames() const;
+        int getNumCameras() const;
+        uint32_t getCameraMask() const;
+        int getCameraSlot(int camera) const;
+        int getNumSensors() const;
+        int getFileID(int frameId) const;
+        bool isTextVelodyne() const;
+        const std::vector<double>& getTimes() const;
+
+        IOBackend::Range getFrameRange(int frameId) const;
+        IOBackend::Range getPayloadRange(int frameId, int sensor) const;
+        std::vector<IOBackend::Buffer> split(int frameId, IOBackend::Buffer frame) const;
+    protected:
+    private:
+        std::string filename;
+        int fd;                         ///< Open archive, flags chosen by I/O backend.
+        Header header;
+        std::vector<double> times;      ///< Velodyne time of each frame.
+        std::vector<uint32_t> fileIds;  ///< Velodyne file number of each frame.
+        std::vector<Entry> index;       ///< numFrames * getNumSensors() entries.
+
+        void readMetadata(void* data, size_t size, uint64_t offset);
+};
+
+#endif // DRIVEARCHIVE_H
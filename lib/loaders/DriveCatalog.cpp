@@ -0,0 +1,329 @@
+#include "DriveCatalog.h"
+
+const char* DriveCatalog::SENSOR_NAMES[NUM_SENSORS] = {"velodyne", "oxts", "image_00", "image_01", "image_02", "image_03"};
+const char* DriveCatalog::INDEX_NAME = "kittiviz.catalog";
+
+/**
+\brief Get drive folder name, e.g. 2011_09_26_drive_0001_sync.
+*/
+
+std::string DriveCatalog::Drive::getName() const
+{
+    char name[100];
+    sprintf(name, "%s_drive_%04d_%s", date.c_str(), drive, layout.c_str());
+    return name;
+}
+
+bool DriveCatalog::Drive::hasSensor(Sensor sensor) const
+{
+    return sensors & (1 << sensor);
+}
+
+/**
+\brief Constructor
+
+Reads the index of a KITTI root if there is one.
+
+\param root - folder holding one folder per date.
+*/
+
+DriveCatalog::DriveCatalog(std::string root) : root(root)
+{
+    isRead = read();
+}
+
+DriveCatalog::~DriveCatalog()
+{
+    //dtor
+}
+
+/**
+\brief Check if the index was read or the root was scanned.
+*/
+
+bool DriveCatalog::isLoaded() const
+{
+    return isRead;
+}
+
+/**
+\brief Summarize every drive of the root, several drives at a time.
+
+\param numThreads - drives scanned concurrently.
+*/
+
+void DriveCatalog::scan(int numThreads)
+{
+    drives = listDrives();
+
+    std::atomic<int> next(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < std::max(numThreads, 1); i++)
+    {
+        threads.push_back(std::thread([this, &next]() {
+            int index;
+            while ((index = next++) < (int)drives.size())
+                summarize(drives[index]);
+        }));
+    }
+    for (int i = 0; i < threads.size(); i++)
+        threads[i].join();
+
+    isRead = true;
+}
+
+/**
+\brief Write the index to the root.
+*/
+
+void DriveCatalog::write() const
+{
+    std::string filename = root + "/" + INDEX_NAME;
+    std::string partial = filename + ".part";
+    FILE* fout = fopen(partial.c_str(), "w");
+    if (!fout)
+    {
+        printf("Could not create %s\n", partial.c_str());
+        exit(1);
+    }
+
+    fprintf(fout, "# date drive layout frames missing seconds sensors tracklets packed bytes\n");
+    for (int i = 0; i < drives.size(); i++)
+    {
+        const Drive& drive = drives[i];
+        std::string sensors;
+        for (int s = 0; s < NUM_SENSORS; s++)
+        {
+            if (!drive.hasSensor((Sensor)s))
+                continue;
+            if (!sensors.empty())
+                sensors += ",";
+            sensors += SENSOR_NAMES[s];
+        }
+        if (sensors.empty())
+            sensors = "-";
+
+        fprintf(fout, "%s %d %s %d %d %.3f %s %d %d %llu\n", drive.date.c_str(), drive.drive, drive.layout.c_str(),
+                drive.numFrames, drive.numMissing, drive.duration, sensors.c_str(), drive.hasTracklets, drive.isPacked,
+                (unsigned long long)drive.bytes);
+    }
+
+    if (fclose(fout) != 0 || rename(partial.c_str(), filename.c_str()) != 0)
+    {
+        printf("Could not write %s\n", filename.c_str());
+        exit(1);
+    }
+}
+
+/**
+\brief Get drives matching a filter, in index order.
+
+\param filter - conditions a drive must meet.
+*/
+
+std::vector<DriveCatalog::Drive> DriveCatalog::find(const Filter& filter) const
+{
+    std::vector<Drive> found;
+    for (int i = 0; i < drives.size(); i++)
+    {
+        const Drive& drive = drives[i];
+        if ((!filter.date.empty() && drive.date != filter.date) || drive.numFrames < filter.minFrames ||
+            (filter.needsTracklets && !drive.hasTracklets) || (filter.needsPacked && !drive.isPacked) ||
+            (drive.sensors & filter.sensors) != filter.sensors)
+            continue;
+        found.push_back(drive);
+    }
+    return found;
+}
+
+/**
+\brief Split a drive folder name like 2011_09_26_drive_0001_sync.
+
+\param name - folder name.
+\param drive - receives date, drive number and layout.
+\return false if name is not a drive folder name.
+*/
+
+bool DriveCatalog::parseName(const std::string& name, Drive& drive)
+{
+    const std::string marker = "_drive_";
+    size_t dateLength = 10;
+    if (name.size() <= dateLength + marker.size() + 5 || name.compare(dateLength, marker.size(), marker) != 0)
+        return false;
+
+    const char* number = name.c_str() + dateLength + marker.size();
+    char* end;
+    long value = strtol(number, &end, 10);
+    if (end == number || *end != '_' || end[1] == 0)
+        return false;
+
+    drive.date = name.substr(0, dateLength);
+    drive.drive = value;
+    drive.layout = end + 1;
+    return true;
+}
+
+/**
+\brief Print one line per drive.
+*/
+
+void DriveCatalog::print(const std::vector<Drive>& drives)
+{
+    printf("%-32s %7s %7s %8s %9s %9s  %s\n", "drive", "frames", "missing", "seconds", "tracklets", "MB", "sensors");
+    for (int i = 0; i < drives.size(); i++)
+    {
+        const Drive& drive = drives[i];
+        std::string sensors;
+        for (int s = 0; s < NUM_SENSORS; s++)
+        {
+            if (drive.hasSensor((Sensor)s))
+                sensors += std::string(sensors.empty() ? "" : ",") + SENSOR_NAMES[s];
+        }
+        printf("%-32s %7d %7d %8.1f %9s %9.1f  %s%s\n", drive.getName().c_str(), drive.numFrames, drive.numMissing,
+               drive.duration, drive.hasTracklets ? "yes" : "no", drive.bytes / (1024.0 * 1024.0), sensors.c_str(),
+               drive.isPacked ? " (packed)" : "");
+    }
+    printf("%d drives\n", (int)drives.size());
+}
+
+/**
+\brief Read the index of the root.
+
+\return false if there is no index.
+*/
+
+bool DriveCatalog::read()
+{
+    FILE* fin = fopen((root + "/" + INDEX_NAME).c_str(), "r");
+    if (!fin)
+        return false;
+
+    char line[1024];
+    while (fgets(line, sizeof(line), fin))
+    {
+        if (line[0] == '#')
+            continue;
+
+        Drive drive;
+        char date[64], layout[64], sensors[256];
+        int hasTracklets, isPacked;
+        unsigned long long bytes;
+        if (sscanf(line, "%63s %d %63s %d %d %lf %255s %d %d %llu", date, &drive.drive, layout, &drive.numFrames,
+                   &drive.numMissing, &drive.duration, sensors, &hasTracklets, &isPacked, &bytes) != 10)
+            continue;
+
+        drive.date = date;
+        drive.layout = layout;
+        drive.hasTracklets = hasTracklets;
+        drive.isPacked = isPacked;
+        drive.bytes = bytes;
+        drive.sensors = 0;
+        for (char* name = strtok(sensors, ","); name; name = strtok(NULL, ","))
+        {
+            for (int s = 0; s < NUM_SENSORS; s++)
+            {
+                if (strcmp(name, SENSOR_NAMES[s]) == 0)
+                    drive.sensors |= 1 << s;
+            }
+        }
+        drives.push_back(drive);
+    }
+    fclose(fin);
+    return true;
+}
+
+/**
+\brief List drive folders of the root, sorted by name. Only two levels of folders are
+listed, drive contents are left to the scan threads.
+*/
+
+std::vector<DriveCatalog::Drive> DriveCatalog::listDrives() const
+{
+    std::vector<std::string> names;
+    DIR *rootDir = opendir(root.c_str());
+    if (rootDir == NULL)
+    {
+        printf("Wrong path: %s\n", root.c_str());
+        exit(1);
+    }
+
+    struct dirent *dateEntry;
+    while ((dateEntry = readdir(rootDir))) {
+        std::string date = dateEntry->d_name;
+        if (date[0] == '.' || !isDirectory(root + "/" + date))
+            continue;
+
+        DIR *dateDir = opendir((root + "/" + date).c_str());
+        if (dateDir == NULL)
+            continue;
+        struct dirent *driveEntry;
+        while ((driveEntry = readdir(dateDir))) {
+            Drive drive;
+            std::string name = driveEntry->d_name;
+            if (parseName(name, drive) && drive.date == date && isDirectory(root + "/" + date + "/" + name))
+                names.push_back(name);
+        }
+        closedir(dateDir);
+    }
+    closedir(rootDir);
+
+    std::sort(names.begin(), names.end());
+    std::vector<Drive> found(names.size());
+    for (int i = 0; i < names.size(); i++)
+        parseName(names[i], found[i]);
+    return found;
+}
+
+/**
+\brief Fill in frame counts, sensors and sizes of a drive from its manifest.
+
+\param drive - drive with date, number and layout set.
+*/
+
+void DriveCatalog::summarize(Drive& drive) const
+{
+    std::string path = root + "/" + drive.date + "/" + drive.getName();
+    DriveManifest manifest(path, drive.layout == "extract");
+
+    std::vector<double> times = manifest.getPresentTimes("velodyne_points/data");
+    drive.numFrames = times.size();
+    drive.numMissing = manifest.getNumMissing("velodyne_points/data");
+    drive.duration = times.size() > 1 ? times.back() - times.front() : 0;
+
+    const char* folders[NUM_SENSORS] = {"velodyne_points/data", "oxts/data", "image_00/data", "image_01/data", "image_02/data", "image_03/data"};
+    drive.sensors = 0;
+    drive.bytes = 0;
+    for (int s = 0; s < NUM_SENSORS; s++)
+    {
+        const DriveManifest::SensorFiles* files = manifest.getSensor(folders[s]);
+        if (!files)
+            continue;
+        bool hasFiles = false;
+        for (int i = 0; i < files->sizes.size(); i++)
+        {
+            if (files->sizes[i] == DriveManifest::MISSING)
+                continue;
+            hasFiles = true;
+            drive.bytes += files->sizes[i];
+        }
+        if (hasFiles)
+            drive.sensors |= 1 << s;
+    }
+
+    uint64_t xmlSize = getFileSize(path + "/tracklet_labels.xml");
+    drive.hasTracklets = xmlSize > 0 || !manifest.getPresent("tracklets").empty();
+    drive.bytes += xmlSize;
+    drive.isPacked = getFileSize(path + ".kvpk") > 0;
+}
+
+bool DriveCatalog::isDirectory(const std::string& path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+uint64_t DriveCatalog::getFileSize(const std::string& path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 ? st.st_size : 0;
+}
@@ -0,0 +1,100 @@
+#ifndef DRIVECATALOG_H
+#define DRIVECATALOG_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "DriveManifest.h"
+
+/**
+\class DriveCatalog
+
+\brief Summary of every drive under a KITTI root, kept in one index file `kittiviz.catalog`
+in the root.
+
+Scanning the root opens every drive through its DriveManifest, several drives at a time,
+which also caches the manifest of each drive. Drives can then be listed and filtered from
+the index alone, and opened without listing their folders.
+
+Index layout: a header line, then one line per drive with date, drive number, layout,
+frames, missing frames, duration in seconds, comma separated sensors, tracklet flag,
+packed flag and bytes on disk.
+
+*/
+
+class DriveCatalog
+{
+    public:
+        enum Sensor
+        {
+            VELODYNE,
+            OXTS,
+            IMAGE_00,       ///< Camera i is IMAGE_00 + i.
+            IMAGE_01,
+            IMAGE_02,
+            IMAGE_03,
+            NUM_SENSORS
+        };
+
+        struct Drive
+        {
+            std::string date;           ///< E.g. 2011_09_26.
+            int drive;
+            std::string layout;         ///< "sync" or "extract".
+            int numFrames;              ///< Velodyne sweeps present.
+            int numMissing;             ///< Velodyne sweeps missing between present ones.
+            double duration;            ///< Seconds from first to last sweep.
+            uint32_t sensors;           ///< Bit i is set if Sensor i has files.
+            bool hasTracklets;          ///< tracklet_labels.xml or tracklets folder present.
+            bool isPacked;              ///< Drive archive present.
+            uint64_t bytes;             ///< Size of all sensor files.
+
+            std::string getName() const;
+            bool hasSensor(Sensor sensor) const;
+        };
+
+        struct Filter
+        {
+            std::string date;           ///< Empty for any date.
+            int minFrames = 0;
+            bool needsTracklets = false;
+            bool needsPacked = false;
+            uint32_t sensors = 0;       ///< Bits of sensors that must be present.
+        };
+
+        static const char* SENSOR_NAMES[NUM_SENSORS];
+        static const char* INDEX_NAME;
+
+        DriveCatalog(std::string root);
+        ~DriveCatalog();
+
+        bool isLoaded() const;
+        void scan(int numThreads);
+        void write() const;
+
+        std::vector<Drive> find(const Filter& filter) const;
+        static bool parseName(const std::string& name, Drive& drive);
+        static void print(const std::vector<Drive>& drives);
+    protected:
+    private:
+        std::string root;
+        std::vector<Drive> drives;
+        bool isRead = false;
+
+        bool read();
+        std::vector<Drive> listDrives() const;
+        void summarize(Drive& drive) const;
+        static bool isDirectory(const std::string& path);
+        static uint64_t getFileSize(const std::string& path);
+};
+
+#endif // DRIVECATALOG_H
@@ -0,0 +1,358 @@
+#include "DriveManifest.h"
+
+const char DriveManifest::MAGIC[4] = {'K', 'V', 'M', 'F'};
+const uint32_t DriveManifest::VERSION;
+const uint64_t DriveManifest::MISSING;
+const int DriveManifest::NUM_CAMERA;
+const int DriveManifest::MAX_MISSING;
+
+/**
+\brief Constructor
+
+Reads the cached manifest of a drive, or scans the drive and caches the result when there
+is no cache or a sensor folder changed since.
+
+\param drivePath - drive folder.
+\param isExtract - true for unsynced "extract" drives, whose OXT runs at 100 Hz.
+*/
+
+DriveManifest::DriveManifest(std::string drivePath, bool isExtract) : drivePath(drivePath), filename(drivePath + ".manifest")
+{
+    if (read() && isCurrent())
+        return;
+
+    printf("Scanning drive %s\n", drivePath.c_str());
+    scan(isExtract);
+    write();
+}
+
+DriveManifest::~DriveManifest()
+{
+    //dtor
+}
+
+/**
+\brief Get files of a sensor.
+
+\param folder - folder of the sensor relative to drive, e.g. "oxts/data".
+\return NULL if the drive has no such folder.
+*/
+
+const DriveManifest::SensorFiles* DriveManifest::getSensor(const std::string& folder) const
+{
+    for (int i = 0; i < sensors.size(); i++)
+    {
+        if (sensors[i].folder == folder)
+            return &sensors[i];
+    }
+    return NULL;
+}
+
+/**
+\brief Get ids of files a sensor has, ascending.
+
+\param folder - folder of the sensor relative to drive.
+*/
+
+std::vector<int> DriveManifest::getPresent(const std::string& folder) const
+{
+    std::vector<int> ids;
+    const SensorFiles* files = getSensor(folder);
+    for (int i = 0; files && i < files->sizes.size(); i++)
+    {
+        if (files->sizes[i] != MISSING)
+            ids.push_back(i);
+    }
+    return ids;
+}
+
+/**
+\brief Get times of files a sensor has, in the order of getPresent.
+
+\param folder - folder of the sensor relative to drive.
+*/
+
+std::vector<double> DriveManifest::getPresentTimes(const std::string& folder) const
+{
+    std::vector<double> times;
+    const SensorFiles* files = getSensor(folder);
+    for (int i = 0; files && i < files->sizes.size(); i++)
+    {
+        if (files->sizes[i] != MISSING)
+            times.push_back(files->times[i]);
+    }
+    return times;
+}
+
+/**
+\brief Get number of ids below the largest one that have no file.
+
+\param folder - folder of the sensor relative to drive.
+*/
+
+int DriveManifest::getNumMissing(const std::string& folder) const
+{
+    const SensorFiles* files = getSensor(folder);
+    if (!files)
+        return 0;
+    return files->sizes.size() - getPresent(folder).size();
+}
+
+int64_t DriveManifest::getModified(const std::string& path)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0)
+        return -1;
+    return (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+int64_t DriveManifest::getSize(const std::string& path)
+{
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0)
+        return -1;
+    return st.st_size;
+}
+
+/**
+\brief Get sensor folders a drive may have, relative to drive folder.
+*/
+
+std::vector<std::string> DriveManifest::getFolders() const
+{
+    std::vector<std::string> folders;
+    folders.push_back("velodyne_points/data");
+    folders.push_back("oxts/data");
+    folders.push_back("tracklets");
+    for (int i = 0; i < NUM_CAMERA; i++)
+    {
+        char folder[32];
+        sprintf(folder, "image_%02d/data", i);
+        folders.push_back(folder);
+    }
+    return folders;
+}
+
+/**
+\brief Get timestamps of a sensor, they sit next to the data folder.
+
+\param folder - folder of the sensor relative to drive.
+\return path of timestamps.txt, empty for tracklets, which have none.
+*/
+
+std::string DriveManifest::getTimesFile(const std::string& folder) const
+{
+    std::string sensor = folder.substr(0, folder.find('/'));
+    return folder == sensor ? "" : drivePath + "/" + sensor + "/timestamps.txt";
+}
+
+/**
+\brief Read cached manifest with a single read.
+
+Layout: magic, version (u32), number of sensors (u32), then per sensor: folder length (u32)
+and characters, folder modification time (i64), timestamps.txt modification time (i64) and
+size (i64), number of ids (u32), size of each id (u64), time of each id (f64).
+
+\return false if there is no valid cache.
+*/
+
+bool DriveManifest::read()
+{
+    FILE* fin = fopen(filename.c_str(), "rb");
+    if (!fin)
+        return false;
+
+    fseeko(fin, 0, SEEK_END);
+    std::vector<char> data(ftello(fin));
+    fseeko(fin, 0, SEEK_SET);
+    bool isRead = !data.empty() && fread(&data[0], 1, data.size(), fin) == data.size();
+    fclose(fin);
+    if (!isRead)
+        return false;
+
+    const char* cursor = &data[0];
+    const char* end = cursor + data.size();
+    uint32_t version, numSensors;
+    if (end - cursor < 12 || memcmp(cursor, MAGIC, sizeof(MAGIC)) != 0)
+        return false;
+    memcpy(&version, cursor + 4, 4);
+    memcpy(&numSensors, cursor + 8, 4);
+    cursor += 12;
+    if (version != VERSION)
+        return false;
+
+    sensors.clear();
+    for (uint32_t i = 0; i < numSensors; i++)
+    {
+        SensorFiles files;
+        uint32_t length, count;
+        if (end - cursor < 4)
+            return false;
+        memcpy(&length, cursor, 4);
+        cursor += 4;
+        if ((uint64_t)(end - cursor) < (uint64_t)length + 28)
+            return false;
+        files.folder.assign(cursor, length);
+        cursor += length;
+        memcpy(&files.modified, cursor, 8);
+        memcpy(&files.timesModified, cursor + 8, 8);
+        memcpy(&files.timesSize, cursor + 16, 8);
+        memcpy(&count, cursor + 24, 4);
+        cursor += 28;
+
+        if ((uint64_t)(end - cursor) < (uint64_t)count * 16)
+            return false;
+        files.sizes.resize(count);
+        files.times.resize(count);
+        memcpy(files.sizes.data(), cursor, count * 8);
+        memcpy(files.times.data(), cursor + count * 8, count * 8);
+        cursor += count * 16;
+        sensors.push_back(files);
+    }
+    return cursor == end;
+}
+
+/**
+\brief Check if no sensor folder appeared, disappeared or changed since the scan, and no
+timestamps.txt was edited or replaced.
+*/
+
+bool DriveManifest::isCurrent() const
+{
+    std::vector<std::string> folders = getFolders();
+    for (int i = 0; i < folders.size(); i++)
+    {
+        int64_t modified = getModified(drivePath + "/" + folders[i]);
+        const SensorFiles* files = getSensor(folders[i]);
+        if (files ? files->modified != modified : modified >= 0)
+            return false;
+
+        std::string timesFile = getTimesFile(folders[i]);
+        if (files && !timesFile.empty() &&
+            (files->timesModified != getModified(timesFile) || files->timesSize != getSize(timesFile)))
+            return false;
+    }
+    return true;
+}
+
+/**
+\brief List every sensor folder of the drive.
+
+\param isExtract - true for unsynced "extract" drives, whose OXT runs at 100 Hz.
+*/
+
+void DriveManifest::scan(bool isExtract)
+{
+    sensors.clear();
+    std::vector<std::string> folders = getFolders();
+    for (int i = 0; i < folders.size(); i++)
+    {
+        std::string sensor = folders[i].substr(0, folders[i].find('/'));
+        std::string timesFile = getTimesFile(folders[i]);
+        double period = sensor == "oxts" && isExtract ? 0.01 : 0.1;
+
+        SensorFiles files;
+        if (scanFolder(folders[i], timesFile, period, files))
+            sensors.push_back(files);
+    }
+}
+
+/**
+\brief List files of a sensor folder.
+
+\param folder - folder relative to drive.
+\param timesFile - timestamps of the sensor, empty if it has none.
+\param period - sample period assumed when timestamps are missing.
+\param files - receives files of the sensor.
+\return false if the folder does not exist.
+*/
+
+bool DriveManifest::scanFolder(const std::string& folder, const std::string& timesFile, double period, SensorFiles& files)
+{
+    std::string path = drivePath + "/" + folder;
+    files.folder = folder;
+    files.modified = getModified(path);
+    files.timesModified = timesFile.empty() ? -1 : getModified(timesFile);
+    files.timesSize = timesFile.empty() ? -1 : getSize(timesFile);
+
+    DIR *dp = opendir(path.c_str());
+    if (dp == NULL)
+        return false;
+
+    std::vector<std::pair<long, uint64_t> > listed;
+    struct dirent *dirp;
+    while ((dirp = readdir(dp))) {
+        // Only "%010d.<ext>" names are sensor files.
+        char* end;
+        long id = strtol(dirp->d_name, &end, 10);
+        if (end - dirp->d_name != 10 || *end != '.' || id < 0)
+            continue;
+
+        struct stat st;
+        if (stat((path + "/" + dirp->d_name).c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+            continue;
+
+        listed.push_back(std::make_pair(id, (uint64_t)st.st_size));
+    }
+    closedir(dp);
+
+    // Ids run from 0 with few gaps, so a stray name such as 9999999999.bin can not size the folder.
+    for (int i = 0; i < listed.size(); i++)
+    {
+        long id = listed[i].first;
+        if (id >= (long)listed.size() + MAX_MISSING)
+        {
+            printf("Skipping %s/%010ld, far past the %d files listed\n", folder.c_str(), id, (int)listed.size());
+            continue;
+        }
+        if (id >= files.sizes.size())
+            files.sizes.resize(id + 1, MISSING);
+        files.sizes[id] = listed[i].second;
+    }
+
+    files.times.resize(files.sizes.size());
+    if (!timesFile.empty())
+    {
+        Timestamps times(timesFile, files.sizes.size(), period);
+        for (int i = 0; i < files.times.size(); i++)
+            files.times[i] = i < times.size() ? times.get(i) : times.getEnd() + (i - times.size() + 1) * period;
+    }
+    return true;
+}
+
+/**
+\brief Cache manifest next to the drive. A drive on read-only storage is scanned on every
+open instead.
+*/
+
+void DriveManifest::write() const
+{
+    std::vector<char> data(MAGIC, MAGIC + sizeof(MAGIC));
+    uint32_t header[2] = {VERSION, (uint32_t)sensors.size()};
+    data.insert(data.end(), (char*)header, (char*)header + sizeof(header));
+    for (int i = 0; i < sensors.size(); i++)
+    {
+        const SensorFiles& files = sensors[i];
+        uint32_t length = files.folder.size();
+        uint32_t count = files.sizes.size();
+        data.insert(data.end(), (char*)&length, (char*)&length + 4);
+        data.insert(data.end(), files.folder.begin(), files.folder.end());
+        data.insert(data.end(), (char*)&files.modified, (char*)&files.modified + 8);
+        data.insert(data.end(), (char*)&files.timesModified, (char*)&files.timesModified + 8);
+        data.insert(data.end(), (char*)&files.timesSize, (char*)&files.timesSize + 8);
+        data.insert(data.end(), (char*)&count, (char*)&count + 4);
+        data.insert(data.end(), (char*)files.sizes.data(), (char*)(files.sizes.data() + count));
+        data.insert(data.end(), (char*)files.times.data(), (char*)(files.times.data() + count));
+    }
+
+    std::string partial = filename + ".part";
+    FILE* fout = fopen(partial.c_str(), "wb");
+    bool isWritten = fout && fwrite(&data[0], 1, data.size(), fout) == data.size();
+    if (fout && fclose(fout) != 0)
+        isWritten = false;
+    if (!isWritten || rename(partial.c_str(), filename.c_str()) != 0)
+    {
+        printf("Could not cache drive manifest %s\n", filename.c_str());
+        remove(partial.c_str());
+    }
+}
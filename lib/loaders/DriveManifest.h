@@ -0,0 +1,74 @@
+#ifndef DRIVEMANIFEST_H
+#define DRIVEMANIFEST_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "../data/Timestamps.h"
+
+/**
+\class DriveManifest
+
+\brief Files of every sensor of a drive folder, so the drive is opened without listing folders.
+
+The manifest is built by scanning the drive once and cached next to the drive folder with
+`.manifest` appended. Later opens read the cache with one read and only check the
+modification time of each sensor folder and the modification time and size of each
+timestamps.txt, a change triggers a rescan.
+
+Files are identified by the number in their `%010d` name. For every sensor, ids from 0 to
+the largest one found have a size and a time, ids without a file are marked missing.
+
+*/
+
+class DriveManifest
+{
+    public:
+        static const char MAGIC[4];
+        static const uint32_t VERSION = 2;
+        static const uint64_t MISSING = UINT64_MAX;     ///< Size of an id without a file.
+        static const int NUM_CAMERA = 4;                ///< Camera folders image_00 to image_03.
+        static const int MAX_MISSING = 1000;            ///< Missing ids allowed in a folder, higher ids are stray files.
+
+        struct SensorFiles
+        {
+            std::string folder;             ///< Relative to drive, e.g. "image_02/data".
+            int64_t modified;               ///< Modification time of folder when scanned.
+            int64_t timesModified;          ///< Modification time of timestamps.txt when scanned, -1 if none.
+            int64_t timesSize;              ///< Size of timestamps.txt when scanned, -1 if none.
+            std::vector<uint64_t> sizes;    ///< Size of each id, MISSING if there is no file.
+            std::vector<double> times;      ///< Time of each id, from timestamps.txt of the sensor.
+        };
+
+        DriveManifest(std::string drivePath, bool isExtract);
+        ~DriveManifest();
+
+        const SensorFiles* getSensor(const std::string& folder) const;
+        std::vector<int> getPresent(const std::string& folder) const;
+        std::vector<double> getPresentTimes(const std::string& folder) const;
+        int getNumMissing(const std::string& folder) const;
+    protected:
+    private:
+        std::string drivePath;
+        std::string filename;               ///< Cache file.
+        std::vector<SensorFiles> sensors;
+
+        static int64_t getModified(const std::string& path);
+        static int64_t getSize(const std::string& path);
+        std::vector<std::string> getFolders() const;
+        std::string getTimesFile(const std::string& folder) const;
+
+        bool read();
+        bool isCurrent() const;
+        void scan(bool isExtract);
+        bool scanFolder(const std::string& folder, const std::string& timesFile, double period, SensorFiles& files);
+        void write() const;
+};
+
+#endif // DRIVEMANIFEST_H
@@ -0,0 +1,102 @@
+#include "DriveMap.h"
+
+const char DriveMap::MAGIC[4] = {'K', 'V', 'M', 'P'};
+const uint32_t DriveMap::VERSION;
+const int DriveMap::GRID_BITS;
+const int DriveMap::GRID;
+const int DriveMap::MAX_COORD;
+
+/**
+\brief Constructor
+
+Opens map and reads header and node index. Terminates if map is not valid.
+
+\param filename - path of the map.
+*/
+
+DriveMap::DriveMap(std::string filename) : filename(filename)
+{
+    fd = open(filename.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0 || pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+        memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION)
+    {
+        printf("Not a drive map or unsupported version: %s\n", filename.c_str());
+        exit(1);
+    }
+
+    size_t indexSize = (size_t)header.numNodes * sizeof(Node);
+    nodes.resize(header.numNodes);
+    if (header.nodesOffset + indexSize > (uint64_t)st.st_size || header.root >= header.numNodes ||
+        pread(fd, nodes.data(), indexSize, header.nodesOffset) != (ssize_t)indexSize)
+    {
+        printf("Drive map is truncated: %s\n", filename.c_str());
+        exit(1);
+    }
+
+    for (int i = 0; i < nodes.size(); i++)
+    {
+        if (nodes[i].offset + (uint64_t)nodes[i].numPoints * 3 * sizeof(uint16_t) > header.nodesOffset)
+        {
+            printf("Drive map is truncated: %s\n", filename.c_str());
+            exit(1);
+        }
+    }
+}
+
+DriveMap::~DriveMap()
+{
+    close(fd);
+}
+
+/**
+\brief Check if a map file exists. Maps are renamed into place once complete.
+
+\param filename - path of the map.
+*/
+
+bool DriveMap::exists(std::string filename)
+{
+    struct stat st;
+    return stat(filename.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+}
+
+std::string DriveMap::getFilename() const
+{
+    return filename;
+}
+
+int DriveMap::getNumNodes() const
+{
+    return nodes.size();
+}
+
+int DriveMap::getRoot() const
+{
+    return header.root;
+}
+
+uint64_t DriveMap::getNumPoints() const
+{
+    return header.numPoints;
+}
+
+const DriveMap::Node& DriveMap::getNode(int node) const
+{
+    return nodes[node];
+}
+
+/**
+\brief Read points of a node. Safe to call from any thread.
+
+\param node - index of the node.
+\param points - receives three coordinates per point.
+\return false if the read failed.
+*/
+
+bool DriveMap::readPoints(int node, std::vector<uint16_t>& points) const
+{
+    size_t size = (size_t)nodes[node].numPoints * 3 * sizeof(uint16_t);
+    points.resize(nodes[node].numPoints * 3);
+    return pread(fd, points.data(), size, nodes[node].offset) == (ssize_t)size;
+}
@@ -0,0 +1,83 @@
+#ifndef DRIVEMAP_H
+#define DRIVEMAP_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/**
+\class DriveMap
+
+\brief Every sweep of a drive fused into one point cloud, stored as an octree in a file next to
+the drive and built by MapBuilder.
+
+Nodes refine additively: a node holds about one point per cell of a GRID^3 grid over its cube,
+and its children hold points left over, so drawing a node and any of its descendants never
+repeats a point. Coordinates are in the world frame of the drive, the IMU pose of the first OXT
+record: x forward, y left, z up at the start of the drive.
+
+Layout, all integers little endian:
+- Header.
+- Points of every node back to back, three uint16 per point, scaled so 0 and MAX_COORD are the
+  low and high corners of the node cube.
+- Index, one Node per node.
+
+*/
+
+class DriveMap
+{
+    public:
+        static const char MAGIC[4];
+        static const uint32_t VERSION = 1;
+        static const int GRID_BITS = 6;
+        static const int GRID = 1 << GRID_BITS;     ///< Cells per axis a node samples its points on.
+        static const int MAX_COORD = 65535;
+
+        struct Header
+        {
+            char magic[4];
+            uint32_t version;
+            uint32_t numNodes;
+            uint32_t root;              ///< Index of root node.
+            uint64_t numPoints;
+            uint64_t nodesOffset;
+            float origin[3];            ///< Low corner of root cube.
+            float size;                 ///< Edge of root cube in meters.
+        };
+
+        struct Node
+        {
+            float origin[3];            ///< Low corner of node cube.
+            float size;                 ///< Edge of node cube in meters.
+            uint64_t offset;            ///< First byte of points.
+            uint32_t numPoints;
+            uint32_t level;             ///< 0 for root.
+            int32_t children[8];        ///< Node of each octant, bit c of octant set for upper half of axis c, -1 if empty.
+        };
+
+        DriveMap(std::string filename);
+        ~DriveMap();
+
+        static bool exists(std::string filename);
+
+        std::string getFilename() const;
+        int getNumNodes() const;
+        int getRoot() const;
+        uint64_t getNumPoints() const;
+        const Node& getNode(int node) const;
+        bool readPoints(int node, std::vector<uint16_t>& points) const;
+    protected:
+    private:
+        std::string filename;
+        int fd;
+        Header header;
+        std::vector<Node> nodes;
+};
+
+#endif // DRIVEMAP_H
@@ -0,0 +1,121 @@
+#include "FrameCache.h"
+
+FrameCache::FrameCache(size_t hotBudget, size_t warmBudget, IOBackend* io) : hot(hotBudget), warm(warmBudget), io(io)
+{
+    //ctor
+}
+
+FrameCache::~FrameCache()
+{
+    //dtor
+}
+
+/**
+\brief Look up a decoded frame.
+
+\param  frameId - id of the frame.
+\param  generation - seek generation the returned bundle is requested in.
+\param  bundle - receives the frame on hit.
+\return true if frame was in hot tier.
+*/
+
+bool FrameCache::getFrame(int frameId, int generation, FrameBundle& bundle)
+{
+    FrameBundle cached;
+    if (!hot.get(frameId, cached))
+        return false;
+
+    // Sensor data is immutable once loaded, so the new bundle shares it with the cached one.
+    bundle = FrameBundle(frameId, generation);
+    bundle.setCloudPoints(cached.getCloudPoints());
+    bundle.setBoxList(cached.getBoxList());
+    bundle.setImageData(cached.getImageData());
+    bundle.setOXT(cached.getOXT());
+    return true;
+}
+
+/**
+\brief Keep a decoded frame in hot tier.
+
+\param  bundle - complete frame to keep.
+*/
+
+void FrameCache::putFrame(const FrameBundle& bundle)
+{
+    if (!bundle.isComplete())
+        return;
+
+    hot.put(bundle.getFrameID(), bundle, bundle.getByteSize());
+}
+
+/**
+\brief Get content of a sensor file, from warm tier if it was read before.
+
+\param  filename - path of the file.
+\return bytes of the file.
+*/
+
+FrameCache::FileBytes FrameCache::readFile(const std::string& filename)
+{
+    FileBytes bytes;
+    if (warm.get(filename, bytes))
+        return bytes;
+
+    bytes = io->read(filename);
+    warm.put(filename, bytes, bytes->getSize());
+    return bytes;
+}
+
+/**
+\brief Get content of several sensor files. Files missing from warm tier are read in one
+batch.
+
+\param  filenames - paths of the files.
+\return bytes of each file, in the same order.
+*/
+
+std::vector<FrameCache::FileBytes> FrameCache::readFiles(const std::vector<std::string>& filenames)
+{
+    std::vector<FileBytes> files(filenames.size());
+    std::vector<std::string> missing;
+    std::vector<int> missingIndex;
+    for (int i = 0; i < filenames.size(); i++)
+    {
+        if (!warm.get(filenames[i], files[i]))
+        {
+            missing.push_back(filenames[i]);
+            missingIndex.push_back(i);
+        }
+    }
+
+    if (!missing.empty())
+    {
+        std::vector<FileBytes> loaded = io->readBatch(missing);
+        for (int i = 0; i < loaded.size(); i++)
+        {
+            files[missingIndex[i]] = loaded[i];
+            warm.put(missing[i], loaded[i], loaded[i]->getSize());
+        }
+    }
+    return files;
+}
+
+/**
+\brief Get a range of an open archive, from warm tier if it was read before.
+
+\param  key - name of the range in cache, unique across archives.
+\param  fd - archive opened by the I/O backend.
+\param  range - byte range to read.
+\return bytes of the range.
+*/
+
+FrameCache::FileBytes FrameCache::readRange(const std::string& key, int fd, const IOBackend::Range& range)
+{
+    FileBytes bytes;
+    if (warm.get(key, bytes))
+        return bytes;
+
+    bytes = io->readRanges(fd, std::vector<IOBackend::Range>(1, range))[0];
+    warm.put(key, bytes, bytes->getSize());
+    return bytes;
+}
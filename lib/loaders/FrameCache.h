@@ -0,0 +1,45 @@
+#ifndef FRAMECACHE_H
+#define FRAMECACHE_H
+
+#include <stdio.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "../utils/LRUCache.h"
+#include "../utils/IOBackend.h"
+#include "../data/FrameBundle.h"
+
+/**
+\class FrameCache
+
+\brief Two tier cache of a drive. The hot tier keeps decoded frames so revisiting a recent
+frame costs nothing, the warm tier keeps raw sensor files as read from disk so older frames
+only need decoding. Each tier is bounded by its own byte budget.
+
+*/
+
+class FrameCache
+{
+    public:
+        typedef IOBackend::Buffer FileBytes;
+
+        FrameCache(size_t hotBudget, size_t warmBudget, IOBackend* io);
+        ~FrameCache();
+
+        bool getFrame(int frameId, int generation, FrameBundle& bundle);
+        void putFrame(const FrameBundle& bundle);
+
+        FileBytes readFile(const std::string& filename);
+        std::vector<FileBytes> readFiles(const std::vector<std::string>& filenames);
+        FileBytes readRange(const std::string& key, int fd, const IOBackend::Range& range);
+
+    protected:
+    private:
+        LRUCache<int, FrameBundle> hot;             ///< Decoded frames by frame id.
+        LRUCache<std::string, FileBytes> warm;      ///< Raw file contents by filename.
+        IOBackend* io;                              ///< Reads files missing from warm tier.
+};
+
+#endif // FRAMECACHE_H
@@ -0,0 +1,268 @@
+#include "LoadScheduler.h"
+
+const int LoadScheduler::NUM_URGENT_THREADS;
+const int LoadScheduler::STATS_WINDOW;
+
+LoadScheduler::LoadScheduler(int numThreads, LoadFunction load, CompleteFunction onComplete) : load(load), onComplete(onComplete), numCancelled(0)
+{
+    for (int i = 0; i < NUM_PRIORITIES; i++)
+        numCompleted[i] = 0;
+
+    numThreads = std::max(numThreads, NUM_URGENT_THREADS + 1);
+    for (int i = 0; i < numThreads; i++)
+        threads.push_back(std::thread(&LoadScheduler::runThread, this, i));
+}
+
+LoadScheduler::~LoadScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStop = true;
+    }
+    cond.notify_all();
+
+    for (int i = 0; i < threads.size(); i++) {
+        if (threads[i].joinable())
+            threads[i].join();
+    }
+}
+
+/**
+\brief Request a frame, or change priority of an earlier request for it.
+
+A request from an older generation is replaced, its result is dropped when it completes.
+
+\param  frameId - id of the frame to load.
+\param  generation - seek generation the load belongs to.
+\param  priority - class the request is served in.
+*/
+
+void LoadScheduler::submit(int frameId, int generation, Priority priority)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::map<int, Request>::iterator it = requests.find(frameId);
+        if (it != requests.end() && it->second.generation == generation)
+        {
+            it->second.priority = priority;
+        } else
+        {
+            Request& request = requests[frameId];
+            request.generation = generation;
+            request.priority = priority;
+            request.sequence = nextSequence++;
+            request.isRunning = false;
+            request.isDone = false;
+            request.submitted = std::chrono::steady_clock::now();
+            request.loadSeconds = 0;
+            request.bundle = FrameBundle();
+        }
+    }
+    cond.notify_all();
+}
+
+/**
+\brief Collect a finished request.
+
+\param  frameId - id of the frame.
+\param  generation - seek generation the frame is wanted in.
+\param  bundle - receives the loaded frame.
+\param  loadSeconds - if not NULL, receives the time the load took without queueing.
+\return true if the request was done, it is removed from the scheduler.
+*/
+
+bool LoadScheduler::take(int frameId, int generation, FrameBundle& bundle, double* loadSeconds)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<int, Request>::iterator it = requests.find(frameId);
+    if (it == requests.end() || !it->second.isDone || it->second.generation != generation)
+        return false;
+
+    bundle = std::move(it->second.bundle);
+    if (loadSeconds)
+        *loadSeconds = it->second.loadSeconds;
+    requests.erase(it);
+    return true;
+}
+
+/**
+\brief Drop a request. A load already running finishes but its result is discarded.
+
+\param  frameId - id of the frame.
+*/
+
+void LoadScheduler::cancel(int frameId)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<int, Request>::iterator it = requests.find(frameId);
+    if (it != requests.end())
+        erase(it);
+}
+
+/**
+\brief Drop every request, used when a seek makes the whole prefetch window useless.
+*/
+
+void LoadScheduler::cancelAll()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    while (!requests.empty())
+        erase(requests.begin());
+}
+
+/**
+\brief Drop every request not in a list, used when the prefetch window moves.
+
+\param  frameIds - frames to keep.
+*/
+
+void LoadScheduler::retain(const std::vector<int>& frameIds)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<int, Request>::iterator it = requests.begin();
+    while (it != requests.end())
+    {
+        std::map<int, Request>::iterator cur = it++;
+        if (std::find(frameIds.begin(), frameIds.end(), cur->first) == frameIds.end())
+            erase(cur);
+    }
+}
+
+/**
+\brief Get number of threads serving prefetch requests in parallel.
+*/
+
+int LoadScheduler::getNumPrefetchThreads() const
+{
+    return threads.size() - NUM_URGENT_THREADS;
+}
+
+/**
+\brief Print request latencies of each class.
+*/
+
+void LoadScheduler::printStats()
+{
+    static const char* names[NUM_PRIORITIES] = {"visible", "seek", "near prefetch", "speculative"};
+
+    std::lock_guard<std::mutex> lock(mutex);
+    printf("Loader latency (last %d per class), %lu requests cancelled:\n", STATS_WINDOW, numCancelled);
+    for (int i = 0; i < NUM_PRIORITIES; i++)
+    {
+        if (latencies[i].empty())
+        {
+            printf("  %-14s %6lu done\n", names[i], numCompleted[i]);
+            continue;
+        }
+
+        std::vector<double> sorted(latencies[i].begin(), latencies[i].end());
+        std::sort(sorted.begin(), sorted.end());
+        double mean = 0;
+        for (int j = 0; j < sorted.size(); j++)
+            mean += sorted[j];
+        mean /= sorted.size();
+
+        printf("  %-14s %6lu done, mean %7.1f ms, p95 %7.1f ms, max %7.1f ms\n", names[i], numCompleted[i],
+               mean * 1000, sorted[(sorted.size() - 1) * 95 / 100] * 1000, sorted.back() * 1000);
+    }
+}
+
+/**
+\brief Loader thread. Threads below NUM_URGENT_THREADS only take VISIBLE and SEEK requests.
+
+\param  index - index of the thread in pool.
+*/
+
+void LoadScheduler::runThread(int index)
+{
+    bool urgentOnly = index < NUM_URGENT_THREADS;
+    while (true)
+    {
+        int frameId;
+        int generation;
+        unsigned long sequence;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait(lock, [&]() { return isStop || pickRequest(urgentOnly, frameId); });
+            if (isStop)
+                return;
+
+            Request& request = requests[frameId];
+            request.isRunning = true;
+            generation = request.generation;
+            sequence = request.sequence;
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        FrameBundle bundle = load(frameId, generation);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        bool isPublished = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::map<int, Request>::iterator it = requests.find(frameId);
+            if (it != requests.end() && it->second.sequence == sequence)
+            {
+                Request& request = it->second;
+                request.isRunning = false;
+                request.isDone = true;
+                request.bundle = std::move(bundle);
+                request.loadSeconds = std::chrono::duration<double>(end - start).count();
+
+                std::chrono::duration<double> elapsed = end - request.submitted;
+                latencies[request.priority].push_back(elapsed.count());
+                if (latencies[request.priority].size() > STATS_WINDOW)
+                    latencies[request.priority].pop_front();
+                numCompleted[request.priority]++;
+                isPublished = true;
+            }
+        }
+
+        // Called without holding the lock, the callback may take locks that are held while
+        // calling into the scheduler.
+        if (isPublished)
+            onComplete();
+    }
+}
+
+/**
+\brief Find the queued request to serve next: highest class first, oldest first within a class.
+
+Must be called with mutex held.
+
+\param  urgentOnly - only consider VISIBLE and SEEK requests.
+\param  frameId - receives id of the picked frame.
+\return true if a request was found.
+*/
+
+bool LoadScheduler::pickRequest(bool urgentOnly, int& frameId)
+{
+    const Request* best = NULL;
+    for (std::map<int, Request>::iterator it = requests.begin(); it != requests.end(); ++it)
+    {
+        const Request& request = it->second;
+        if (request.isRunning || request.isDone)
+            continue;
+        if (urgentOnly && request.priority > SEEK)
+            continue;
+
+        if (!best || request.priority < best->priority ||
+            (request.priority == best->priority && request.sequence < best->sequence))
+        {
+            best = &request;
+            frameId = it->first;
+        }
+    }
+    return best != NULL;
+}
+
+/**
+\brief Remove a request. Must be called with mutex held.
+*/
+
+void LoadScheduler::erase(std::map<int, Request>::iterator it)
+{
+    if (!it->second.isDone)
+        numCancelled++;
+    requests.erase(it);
+}
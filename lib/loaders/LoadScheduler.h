@@ -0,0 +1,89 @@
+#ifndef LOADSCHEDULER_H
+#define LOADSCHEDULER_H
+
+#include <stdio.h>
+#include <vector>
+#include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <condition_variable>
+
+#include "../data/FrameBundle.h"
+
+/**
+\class LoadScheduler
+
+\brief Pool of loader threads serving frame requests by priority class. Requests can be
+reprioritized or cancelled while queued, and the first threads of the pool only serve
+urgent classes so a frame the user waits for never queues behind prefetch.
+
+*/
+
+class LoadScheduler
+{
+    public:
+        enum Priority
+        {
+            VISIBLE,            ///< Frame the display is stalled on.
+            SEEK,               ///< Target of a jump.
+            NEAR_PREFETCH,      ///< Frames due before the queue runs dry.
+            SPECULATIVE,        ///< Rest of the prefetch window.
+            NUM_PRIORITIES
+        };
+
+        typedef std::function<FrameBundle(int frameId, int generation)> LoadFunction;
+        typedef std::function<void()> CompleteFunction;
+
+        LoadScheduler(int numThreads, LoadFunction load, CompleteFunction onComplete);
+        ~LoadScheduler();
+
+        void submit(int frameId, int generation, Priority priority);
+        bool take(int frameId, int generation, FrameBundle& bundle, double* loadSeconds = NULL);
+        void cancel(int frameId);
+        void cancelAll();
+        void retain(const std::vector<int>& frameIds);
+
+        int getNumPrefetchThreads() const;
+
+        void printStats();
+    protected:
+    private:
+        static const int NUM_URGENT_THREADS = 1;    ///< Threads reserved for VISIBLE and SEEK requests.
+        static const int STATS_WINDOW = 256;        ///< Latency samples kept per class.
+
+        struct Request
+        {
+            int generation;
+            Priority priority;
+            unsigned long sequence;     ///< Submission order, also identifies the request once running.
+            bool isRunning;
+            bool isDone;
+            std::chrono::steady_clock::time_point submitted;
+            double loadSeconds;         ///< Time the load itself took, without queueing.
+            FrameBundle bundle;
+        };
+
+        LoadFunction load;
+        CompleteFunction onComplete;
+
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::condition_variable cond;       ///< Signaled when a request is queued or on stop.
+        bool isStop = false;
+        unsigned long nextSequence = 0;
+
+        std::map<int, Request> requests;                ///< Requests by frame id.
+        std::deque<double> latencies[NUM_PRIORITIES];   ///< Recent submit to done times in seconds.
+        unsigned long numCompleted[NUM_PRIORITIES];
+        unsigned long numCancelled;
+
+        void runThread(int index);
+        bool pickRequest(bool urgentOnly, int& frameId);
+        void erase(std::map<int, Request>::iterator it);
+};
+
+#endif // LOADSCHEDULER_H
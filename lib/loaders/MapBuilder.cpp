@@ -0,0 +1,594 @@
+#include "MapBuilder.h"
+
+constexpr float MapBuilder::MIN_RANGE;
+constexpr float MapBuilder::CHUNK_SIZE;
+constexpr float MapBuilder::MIN_SPACING;
+const int MapBuilder::MAX_LEVEL;
+const size_t MapBuilder::LEAF_CAPACITY;
+const size_t MapBuilder::MAX_CHUNK_POINTS;
+const size_t MapBuilder::PARTITION_POINTS;
+
+/**
+\brief Constructor, starts building in background.
+
+\param filename - path of the map.
+\param numFrames - number of frames of the drive.
+\param getPose - gives velodyne pose of a frame, called from the builder thread.
+\param getSweep - reads and filters the sweep of a frame, called from the builder thread.
+*/
+
+MapBuilder::MapBuilder(std::string filename, int numFrames, PoseFunction getPose, SweepFunction getSweep) :
+    filename(filename), folder(filename + ".chunks"), numFrames(numFrames), getPose(getPose), getSweep(getSweep),
+    isStop(false), isFinished(false)
+{
+    // Only the range limit applies, sweeps are fused in scan order.
+    PointFilter::Settings settings;
+    settings.minRange = MIN_RANGE;
+    settings.maxRange = PointFilter::MAX_RANGE;
+    settings.isProgressive = false;
+    filter = std::make_shared<const PointFilter>(settings);
+
+    builderThread = std::thread(&MapBuilder::run, this);
+}
+
+/**
+\brief Destructor, abandons an unfinished map.
+*/
+
+MapBuilder::~MapBuilder()
+{
+    isStop = true;
+    if (builderThread.joinable())
+        builderThread.join();
+}
+
+/**
+\brief Check if the builder is done, whether the map was written or not.
+*/
+
+bool MapBuilder::isDone() const
+{
+    return isFinished;
+}
+
+void MapBuilder::run()
+{
+    printf("Building map %s in background\n", filename.c_str());
+    auto start = std::chrono::steady_clock::now();
+
+    std::string partial = filename + ".part";
+    mkdir(folder.c_str(), 0755);
+    fout = fopen(partial.c_str(), "wb");
+    bool isBuilt = fout && build();
+    if (fout && fclose(fout) != 0)
+        isBuilt = false;
+
+    removeFolder();
+
+    if (isBuilt && rename(partial.c_str(), filename.c_str()) == 0)
+    {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("Built map %s, %llu points in %d nodes, %.0f s\n", filename.c_str(),
+               (unsigned long long)header.numPoints, header.numNodes, seconds);
+    }
+    else
+    {
+        if (!isStop)
+            printf("Could not build map %s\n", filename.c_str());
+        remove(partial.c_str());
+    }
+    isFinished = true;
+}
+
+/**
+\brief Run every pass, writing points as nodes are built, then the index and header.
+
+\return false if stopped or a file could not be written.
+*/
+
+bool MapBuilder::build()
+{
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DriveMap::MAGIC, sizeof(DriveMap::MAGIC));
+    header.version = DriveMap::VERSION;
+    computeBounds();
+    if (fwrite(&header, sizeof(header), 1, fout) != 1)
+        return false;
+
+    if (!partition() || !buildChunks())
+        return false;
+    buildTop();
+
+    header.numNodes = nodes.size();
+    header.nodesOffset = ftello(fout);
+    if (!nodes.empty() && fwrite(nodes.data(), sizeof(DriveMap::Node), nodes.size(), fout) != nodes.size())
+        return false;
+
+    return !isWriteFailed && fseeko(fout, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, fout) == 1;
+}
+
+/**
+\brief Fit the root cube around the path of the velodyne, widened by the range of sweeps, and
+pick the level of chunks.
+*/
+
+void MapBuilder::computeBounds()
+{
+    glm::vec3 low(INFINITY);
+    glm::vec3 high(-INFINITY);
+    for (int i = 0; i < numFrames; i++)
+    {
+        glm::mat4 pose = getPose(i);
+        for (int c = 0; c < 3; c++)
+        {
+            low[c] = std::min(low[c], pose[3][c] - PointFilter::MAX_RANGE);
+            high[c] = std::max(high[c], pose[3][c] + PointFilter::MAX_RANGE);
+        }
+    }
+
+    header.size = std::max(std::max(high[0] - low[0], high[1] - low[1]), high[2] - low[2]);
+    for (int c = 0; c < 3; c++)
+        header.origin[c] = (low[c] + high[c] - header.size) / 2;
+
+    chunkLevel = 0;
+    while (getNodeSize(chunkLevel) > CHUNK_SIZE && chunkLevel < MAX_LEVEL)
+        chunkLevel++;
+}
+
+/**
+\brief Move every sweep into the world frame and append its points to the files of the chunks
+they fall in.
+
+\return false if stopped or a chunk could not be written.
+*/
+
+bool MapBuilder::partition()
+{
+    std::map<uint64_t, std::vector<glm::vec3> > buffers;
+    std::vector<float> vertices;
+    size_t numBuffered = 0;
+    for (int i = 0; i < numFrames && !isStop && !isWriteFailed; i++)
+    {
+        std::shared_ptr<const CloudPoints> sweep = getSweep(i, filter);
+        glm::mat4 pose = getPose(i);
+
+        float matrix[12];
+        for (int row = 0; row < 3; row++)
+        {
+            for (int col = 0; col < 4; col++)
+                matrix[row * 4 + col] = pose[col][row];
+        }
+
+        size_t numPoints = sweep->getNumPoints();
+        vertices.resize(numPoints * 4);
+        PointTransform::transform(sweep->getColumn(CloudPoints::X), sweep->getColumn(CloudPoints::Y),
+                                  sweep->getColumn(CloudPoints::Z), numPoints, matrix, vertices.data());
+
+        // Points in scan order mostly fall in the chunk of the point before.
+        std::vector<glm::vec3>* buffer = NULL;
+        uint64_t bufferKey = 0;
+        uint32_t cell[3];
+        for (size_t j = 0; j < numPoints; j++)
+        {
+            glm::vec3 p(vertices[j * 4], vertices[j * 4 + 1], vertices[j * 4 + 2]);
+            if (!isInside(p))
+                continue;
+            getCell(p, chunkLevel, cell);
+            uint64_t key = packCell(cell);
+            if (!buffer || key != bufferKey)
+            {
+                buffer = &buffers[key];
+                bufferKey = key;
+                Chunk& chunk = chunks[key];
+                chunk.level = chunkLevel;
+                memcpy(chunk.cell, cell, sizeof(cell));
+            }
+            buffer->push_back(p);
+        }
+
+        numBuffered += numPoints;
+        if (numBuffered >= PARTITION_POINTS)
+        {
+            appendChunks(buffers);
+            numBuffered = 0;
+        }
+        if ((i + 1) % 500 == 0)
+            printf("Map: read %d of %d sweeps\n", i + 1, numFrames);
+    }
+    appendChunks(buffers);
+    return !isStop && !isWriteFailed;
+}
+
+void MapBuilder::appendChunks(std::map<uint64_t, std::vector<glm::vec3> >& buffers)
+{
+    for (auto it = buffers.begin(); it != buffers.end(); ++it)
+    {
+        Chunk& chunk = chunks[it->first];
+        if (!appendChunk(getChunkFilename(chunk), it->second))
+            isWriteFailed = true;
+        chunk.numPoints += it->second.size();
+    }
+    buffers.clear();
+}
+
+/**
+\brief Build the octree of every chunk, splitting chunks too large to build in memory.
+
+\return false if stopped or a node could not be written.
+*/
+
+bool MapBuilder::buildChunks()
+{
+    std::vector<Chunk> pending;
+    for (auto it = chunks.begin(); it != chunks.end(); ++it)
+        pending.push_back(it->second);
+
+    size_t numBuilt = 0;
+    while (!pending.empty() && !isStop && !isWriteFailed)
+    {
+        Chunk chunk = pending.back();
+        pending.pop_back();
+        if (chunk.numPoints > MAX_CHUNK_POINTS && chunk.level < MAX_LEVEL)
+            splitChunk(chunk, pending);
+        else
+            buildChunk(chunk);
+        remove(getChunkFilename(chunk).c_str());
+
+        if (++numBuilt % 100 == 0)
+            printf("Map: built %d chunks, %d left\n", (int)numBuilt, (int)pending.size());
+    }
+    return !isStop && !isWriteFailed;
+}
+
+/**
+\brief Build the octree of a chunk in memory. Nodes below the chunk root are written, the root
+is kept for buildTop.
+*/
+
+void MapBuilder::buildChunk(const Chunk& chunk)
+{
+    std::vector<glm::vec3> points;
+    if (!readChunk(getChunkFilename(chunk), points))
+    {
+        isWriteFailed = true;
+        return;
+    }
+
+    ChunkRoot& root = roots[CellKey(chunk.level, packCell(chunk.cell))];
+    for (int i = 0; i < 8; i++)
+        root.children[i] = -1;
+    if (points.size() <= LEAF_CAPACITY)
+    {
+        root.points.swap(points);
+        return;
+    }
+
+    std::vector<glm::vec3> rest[8];
+    samplePoints(chunk.level, points, root.points, rest, true);
+    points = std::vector<glm::vec3>();
+    buildChildren(chunk.level, chunk.cell, rest, root.children);
+}
+
+/**
+\brief Split the file of a chunk into files of its eight octants, reading it a block at a time.
+
+\param chunk - chunk to split.
+\param children - receives the octants holding points.
+*/
+
+void MapBuilder::splitChunk(const Chunk& chunk, std::vector<Chunk>& children)
+{
+    Chunk octants[8];
+    for (int i = 0; i < 8; i++)
+    {
+        octants[i].level = chunk.level + 1;
+        for (int c = 0; c < 3; c++)
+            octants[i].cell[c] = chunk.cell[c] * 2 + ((i >> c) & 1);
+        octants[i].numPoints = 0;
+    }
+
+    FILE* fin = fopen(getChunkFilename(chunk).c_str(), "rb");
+    if (!fin)
+    {
+        isWriteFailed = true;
+        return;
+    }
+
+    std::vector<glm::vec3> block(PARTITION_POINTS);
+    std::vector<glm::vec3> rest[8];
+    size_t numRead;
+    while ((numRead = fread(block.data(), sizeof(glm::vec3), block.size(), fin)) > 0)
+    {
+        uint32_t cell[3];
+        for (size_t i = 0; i < numRead; i++)
+        {
+            getCell(block[i], chunk.level + 1, cell);
+            rest[(cell[0] & 1) | (cell[1] & 1) << 1 | (cell[2] & 1) << 2].push_back(block[i]);
+        }
+        for (int i = 0; i < 8; i++)
+        {
+            if (!rest[i].empty() && !appendChunk(getChunkFilename(octants[i]), rest[i]))
+                isWriteFailed = true;
+            octants[i].numPoints += rest[i].size();
+            rest[i].clear();
+        }
+    }
+    fclose(fin);
+
+    for (int i = 0; i < 8; i++)
+    {
+        if (octants[i].numPoints > 0)
+            children.push_back(octants[i]);
+    }
+}
+
+/**
+\brief Build nodes above the chunks from the points of every chunk root, then write the chunk
+roots with the points left over.
+*/
+
+void MapBuilder::buildTop()
+{
+    std::vector<glm::vec3> points;
+    for (auto it = roots.begin(); it != roots.end(); ++it)
+    {
+        points.insert(points.end(), it->second.points.begin(), it->second.points.end());
+        it->second.points = std::vector<glm::vec3>();
+
+        uint64_t packed = it->first.second;
+        for (int level = it->first.first - 1; level >= 0; level--)
+        {
+            int shift = it->first.first - level;
+            uint32_t cell[3] = {(uint32_t)(packed & 0xFFFFF) >> shift, (uint32_t)(packed >> 20 & 0xFFFFF) >> shift,
+                                (uint32_t)(packed >> 40 & 0xFFFFF) >> shift};
+            ancestors.insert(CellKey(level, packCell(cell)));
+        }
+    }
+
+    // A drive without points still gets a root, so the map opens.
+    uint32_t cell[3] = {0, 0, 0};
+    int32_t root = buildUpper(0, cell, points);
+    if (root < 0)
+    {
+        int32_t children[8] = {-1, -1, -1, -1, -1, -1, -1, -1};
+        root = writeNode(0, cell, points, children);
+    }
+    header.root = root;
+}
+
+/**
+\brief Build a node and its descendants within a chunk.
+
+\param level - level of the node.
+\param cell - cell of the node at its level.
+\param points - points in the node, cleared.
+\return index of the node.
+*/
+
+int32_t MapBuilder::buildNode(int level, const uint32_t cell[3], std::vector<glm::vec3>& points)
+{
+    int32_t children[8] = {-1, -1, -1, -1, -1, -1, -1, -1};
+    if (points.size() <= LEAF_CAPACITY)
+        return writeNode(level, cell, points, children);
+
+    // Past the finest spacing points sharing a cell are dropped rather than refined.
+    bool isRefined = level < MAX_LEVEL && getNodeSize(level) / DriveMap::GRID >= MIN_SPACING;
+    std::vector<glm::vec3> kept;
+    std::vector<glm::vec3> rest[8];
+    samplePoints(level, points, kept, rest, isRefined);
+    points = std::vector<glm::vec3>();
+
+    buildChildren(level, cell, rest, children);
+    return writeNode(level, cell, kept, children);
+}
+
+/**
+\brief Build a node above the chunks. Chunk roots are written with the points reaching them,
+along with the children built with their chunk.
+
+\return index of the node, -1 if it holds no points and no chunk.
+*/
+
+int32_t MapBuilder::buildUpper(int level, const uint32_t cell[3], std::vector<glm::vec3>& points)
+{
+    CellKey key(level, packCell(cell));
+    auto root = roots.find(key);
+    if (root != roots.end())
+        return writeNode(level, cell, points, root->second.children);
+    if (!ancestors.count(key))
+        return points.empty() ? -1 : buildNode(level, cell, points);
+
+    std::vector<glm::vec3> kept;
+    std::vector<glm::vec3> rest[8];
+    samplePoints(level, points, kept, rest, true);
+    points = std::vector<glm::vec3>();
+
+    int32_t children[8];
+    for (int i = 0; i < 8; i++)
+    {
+        uint32_t child[3];
+        for (int c = 0; c < 3; c++)
+            child[c] = cell[c] * 2 + ((i >> c) & 1);
+        children[i] = buildUpper(level + 1, child, rest[i]);
+    }
+    return writeNode(level, cell, kept, children);
+}
+
+void MapBuilder::buildChildren(int level, const uint32_t cell[3], std::vector<glm::vec3> rest[8], int32_t children[8])
+{
+    for (int i = 0; i < 8; i++)
+    {
+        uint32_t child[3];
+        for (int c = 0; c < 3; c++)
+            child[c] = cell[c] * 2 + ((i >> c) & 1);
+        children[i] = rest[i].empty() ? -1 : buildNode(level + 1, child, rest[i]);
+    }
+}
+
+/**
+\brief Keep the first point in each cell of the sampling grid of a node, and sort the others
+into the octants of the node.
+
+\param level - level of the node.
+\param points - points in the node.
+\param kept - receives the points kept.
+\param rest - receives the other points by octant.
+\param isKeepingRest - false to drop the other points.
+*/
+
+void MapBuilder::samplePoints(int level, std::vector<glm::vec3>& points, std::vector<glm::vec3>& kept,
+                              std::vector<glm::vec3> rest[8], bool isKeepingRest) const
+{
+    const int GRID = DriveMap::GRID;
+    thread_local std::vector<uint64_t> isOccupied;
+    isOccupied.assign(GRID * GRID * GRID / 64, 0);
+
+    // Grid cells are cells GRID_BITS levels down, so their top bit is the octant.
+    uint32_t cell[3];
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        getCell(points[i], level + DriveMap::GRID_BITS, cell);
+        uint32_t local[3];
+        for (int c = 0; c < 3; c++)
+            local[c] = cell[c] & (GRID - 1);
+
+        uint32_t index = (local[2] * GRID + local[1]) * GRID + local[0];
+        if (!(isOccupied[index / 64] & (uint64_t)1 << (index % 64)))
+        {
+            isOccupied[index / 64] |= (uint64_t)1 << (index % 64);
+            kept.push_back(points[i]);
+        }
+        else if (isKeepingRest)
+        {
+            int octant = (local[0] >> (DriveMap::GRID_BITS - 1)) | (local[1] >> (DriveMap::GRID_BITS - 1)) << 1 |
+                         (local[2] >> (DriveMap::GRID_BITS - 1)) << 2;
+            rest[octant].push_back(points[i]);
+        }
+    }
+}
+
+/**
+\brief Write points of a node quantized to its cube, and add it to the index.
+
+\return index of the node.
+*/
+
+int32_t MapBuilder::writeNode(int level, const uint32_t cell[3], const std::vector<glm::vec3>& points, const int32_t children[8])
+{
+    DriveMap::Node node;
+    node.size = getNodeSize(level);
+    for (int c = 0; c < 3; c++)
+        node.origin[c] = header.origin[c] + (double)cell[c] * node.size;
+    node.offset = ftello(fout);
+    node.numPoints = points.size();
+    node.level = level;
+    memcpy(node.children, children, sizeof(node.children));
+
+    std::vector<uint16_t> coords(points.size() * 3);
+    float scale = DriveMap::MAX_COORD / node.size;
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            float v = (points[i][c] - node.origin[c]) * scale + 0.5f;
+            coords[i * 3 + c] = (uint16_t)std::min(std::max(v, 0.0f), (float)DriveMap::MAX_COORD);
+        }
+    }
+    if (!coords.empty() && fwrite(coords.data(), sizeof(uint16_t), coords.size(), fout) != coords.size())
+        isWriteFailed = true;
+
+    header.numPoints += points.size();
+    nodes.push_back(node);
+    return nodes.size() - 1;
+}
+
+bool MapBuilder::isInside(const glm::vec3& p) const
+{
+    for (int c = 0; c < 3; c++)
+    {
+        if (!(p[c] >= header.origin[c] && p[c] < header.origin[c] + header.size))
+            return false;
+    }
+    return true;
+}
+
+/**
+\brief Find the cell holding a point among the cells of a level, 2^level per axis. Done in
+double with power of two scales, so the cell of a level is exactly the cell of the level below
+shifted by one, and points are sorted the same way at every level.
+*/
+
+void MapBuilder::getCell(const glm::vec3& p, int level, uint32_t cell[3]) const
+{
+    double cells = (double)((uint64_t)1 << level);
+    for (int c = 0; c < 3; c++)
+    {
+        double t = ((double)p[c] - header.origin[c]) / header.size;
+        cell[c] = (uint32_t)std::min(std::max(floor(t * cells), 0.0), cells - 1);
+    }
+}
+
+float MapBuilder::getNodeSize(int level) const
+{
+    return header.size / (float)((uint64_t)1 << level);
+}
+
+std::string MapBuilder::getChunkFilename(const Chunk& chunk) const
+{
+    char name[64];
+    sprintf(name, "/%d_%u_%u_%u.bin", chunk.level, chunk.cell[0], chunk.cell[1], chunk.cell[2]);
+    return folder + name;
+}
+
+/**
+\brief Remove the chunk folder along with chunks left by a stopped build.
+*/
+
+void MapBuilder::removeFolder() const
+{
+    DIR* dir = opendir(folder.c_str());
+    if (!dir)
+        return;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (entry->d_name[0] != '.')
+            remove((folder + "/" + entry->d_name).c_str());
+    }
+    closedir(dir);
+    rmdir(folder.c_str());
+}
+
+/**
+\brief Pack a cell of up to MAX_LEVEL into 20 bits per axis.
+*/
+
+uint64_t MapBuilder::packCell(const uint32_t cell[3])
+{
+    return (uint64_t)cell[0] | (uint64_t)cell[1] << 20 | (uint64_t)cell[2] << 40;
+}
+
+bool MapBuilder::readChunk(const std::string& filename, std::vector<glm::vec3>& points)
+{
+    struct stat st;
+    FILE* fin = fopen(filename.c_str(), "rb");
+    if (!fin || fstat(fileno(fin), &st) != 0)
+    {
+        if (fin)
+            fclose(fin);
+        return false;
+    }
+    points.resize(st.st_size / sizeof(glm::vec3));
+    bool isRead = fread(points.data(), sizeof(glm::vec3), points.size(), fin) == points.size();
+    fclose(fin);
+    return isRead;
+}
+
+bool MapBuilder::appendChunk(const std::string& filename, const std::vector<glm::vec3>& points)
+{
+    FILE* file = fopen(filename.c_str(), "ab");
+    bool isWritten = file && fwrite(points.data(), sizeof(glm::vec3), points.size(), file) == points.size();
+    if (file && fclose(file) != 0)
+        isWritten = false;
+    return isWritten;
+}
@@ -0,0 +1,126 @@
+#ifndef MAPBUILDER_H
+#define MAPBUILDER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <glm/glm.hpp>
+
+#include "DriveMap.h"
+#include "../data/CloudPoints.h"
+#include "../data/PointFilter.h"
+#include "../utils/PointTransform.h"
+
+/**
+\class MapBuilder
+
+\brief Builds the DriveMap of a drive in a background thread, reading each sweep once.
+
+Sweeps are placed in the world frame of the drive by the velodyne pose of their frame, so
+moving objects leave trails. The drive rarely fits in memory, so the map is built out of core:
+- Points of every sweep are appended to files of chunks, cubes of about CHUNK_SIZE meters,
+  in a folder next to the map. Chunks with more than MAX_CHUNK_POINTS are split in eight.
+- The octree of each chunk is built in memory, and its nodes written except the chunk root.
+- Nodes above the chunks are built from the points of every chunk root, whose points left
+  over are written last.
+
+The map is written to a temporary file and renamed once complete, the chunk folder is removed.
+
+*/
+
+class MapBuilder
+{
+    public:
+        typedef std::function<glm::mat4(int frameId)> PoseFunction;
+        typedef std::function<std::shared_ptr<const CloudPoints>(int frameId, std::shared_ptr<const PointFilter> filter)> SweepFunction;
+
+        static constexpr float MIN_RANGE = 3;               ///< Closer points are returns off the car itself.
+        static constexpr float CHUNK_SIZE = 64;             ///< Largest edge of chunks in meters.
+        static constexpr float MIN_SPACING = 0.02;          ///< Finest grid spacing in meters, denser points are dropped.
+        static const int MAX_LEVEL = 20;
+        static const size_t LEAF_CAPACITY = 20000;          ///< Nodes with fewer points keep them all.
+        static const size_t MAX_CHUNK_POINTS = 1 << 23;     ///< Larger chunks are split before building, 96 MB of points.
+        static const size_t PARTITION_POINTS = 1 << 22;     ///< Points buffered before appending to chunk files.
+
+        MapBuilder(std::string filename, int numFrames, PoseFunction getPose, SweepFunction getSweep);
+        ~MapBuilder();
+
+        bool isDone() const;
+    protected:
+    private:
+        struct Chunk
+        {
+            int level;
+            uint32_t cell[3];
+            size_t numPoints;
+        };
+
+        struct ChunkRoot
+        {
+            std::vector<glm::vec3> points;      ///< Points left at the root of the chunk.
+            int32_t children[8];
+        };
+
+        typedef std::pair<int, uint64_t> CellKey;   ///< Level and packed cell of a node.
+
+        std::string filename;
+        std::string folder;                 ///< Chunk files, removed once done.
+        int numFrames;
+        PoseFunction getPose;
+        SweepFunction getSweep;
+        std::shared_ptr<const PointFilter> filter;
+
+        std::atomic<bool> isStop;
+        std::atomic<bool> isFinished;
+        std::thread builderThread;
+
+        DriveMap::Header header;
+        int chunkLevel = 0;
+        FILE* fout = NULL;
+        bool isWriteFailed = false;
+        std::vector<DriveMap::Node> nodes;
+        std::map<uint64_t, Chunk> chunks;           ///< Chunks of chunkLevel, by packed cell.
+        std::map<CellKey, ChunkRoot> roots;         ///< Root of each chunk built.
+        std::set<CellKey> ancestors;                ///< Nodes above chunk roots.
+
+        void run();
+        bool build();
+        void computeBounds();
+        bool partition();
+        void appendChunks(std::map<uint64_t, std::vector<glm::vec3> >& buffers);
+        bool buildChunks();
+        void buildChunk(const Chunk& chunk);
+        void splitChunk(const Chunk& chunk, std::vector<Chunk>& children);
+        void buildTop();
+
+        int32_t buildNode(int level, const uint32_t cell[3], std::vector<glm::vec3>& points);
+        int32_t buildUpper(int level, const uint32_t cell[3], std::vector<glm::vec3>& points);
+        void buildChildren(int level, const uint32_t cell[3], std::vector<glm::vec3> rest[8], int32_t children[8]);
+        void samplePoints(int level, std::vector<glm::vec3>& points, std::vector<glm::vec3>& kept,
+                          std::vector<glm::vec3> rest[8], bool isKeepingRest) const;
+        int32_t writeNode(int level, const uint32_t cell[3], const std::vector<glm::vec3>& points, const int32_t children[8]);
+
+        bool isInside(const glm::vec3& p) const;
+        void getCell(const glm::vec3& p, int level, uint32_t cell[3]) const;
+        float getNodeSize(int level) const;
+        std::string getChunkFilename(const Chunk& chunk) const;
+        void removeFolder() const;
+        static uint64_t packCell(const uint32_t cell[3]);
+        static bool readChunk(const std::string& filename, std::vector<glm::vec3>& points);
+        static bool appendChunk(const std::string& filename, const std::vector<glm::vec3>& points);
+};
+
+#endif // MAPBUILDER_H
@@ -0,0 +1,356 @@
+#include "MapLoader.h"
+
+MapLoader* MapLoader::mInstance = NULL;
+
+constexpr float MapLoader::MAX_SCREEN_ERROR;
+const int MapLoader::MAX_UPLOADS;
+const int MapLoader::MAX_REQUESTS;
+
+/**
+\brief Constructor
+
+*/
+
+MapLoader::MapLoader()
+{
+    gpuBudget = ConfigLoader::getInstance()->getMapGPUBytes();
+}
+
+/**
+\brief Destructor, stops reading and frees every node on the GPU.
+
+*/
+
+MapLoader::~MapLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStop = true;
+    }
+    cond.notify_one();
+    if (readerThread.joinable())
+        readerThread.join();
+
+    for (int i = 0; i < slots.size(); i++)
+    {
+        if (slots[i].state == RESIDENT)
+            release(i);
+    }
+    delete map;
+}
+
+/**
+\brief Singleton constructor.
+
+Create a singleton object of MapLoader.
+
+*/
+
+MapLoader* MapLoader::getInstance() {
+    if (!mInstance)
+    {
+        mInstance = new MapLoader;
+    }
+    return mInstance;
+}
+
+/**
+\brief Open a map and start reading its nodes. A map is only opened once.
+
+\param filename - path of the map.
+*/
+
+void MapLoader::open(std::string filename)
+{
+    if (map)
+        return;
+    map = new DriveMap(filename);
+    slots.assign(map->getNumNodes(), Slot{ABSENT, 0, 0, 0});
+    readerThread = std::thread(&MapLoader::runReader, this);
+    printf("Opened map %s, %llu points in %d nodes\n", filename.c_str(), (unsigned long long)map->getNumPoints(), map->getNumNodes());
+}
+
+bool MapLoader::isOpen() const
+{
+    return map != NULL;
+}
+
+/**
+\brief Receive the OXT record of a new frame, the map is drawn around its pose.
+
+*/
+
+void MapLoader::update(std::shared_ptr<const OXT> oxt)
+{
+    if (!oxt)
+        return;
+    worldToRender = PointsLoader::SENSOR_TO_RENDER * glm::inverse(oxt->getVelodynePose());
+    hasPose = true;
+}
+
+/**
+\brief Get bytes of node buffers on the GPU.
+*/
+
+size_t MapLoader::getGPUBytes() const
+{
+    return gpuBytes;
+}
+
+/**
+\brief Draw the nodes of the map fine enough for the view, then upload nodes read since the
+last draw and queue the nodes missing.
+
+\param PVMLoc - location of PVM matrix in the shader.
+\param projection - projection matrix.
+\param view - view*model matrix of the current sweep, PVM is restored to projection*view.
+\param viewportHeight - height of the viewport in pixels.
+*/
+
+void MapLoader::draw(GLuint PVMLoc, const glm::mat4& projection, const glm::mat4& view, int viewportHeight)
+{
+    if (!map || !hasPose)
+        return;
+
+    drawCount++;
+    glm::mat4 pvm = projection * view * worldToRender;
+    glm::mat4 cameraToWorld = glm::inverse(view * worldToRender);
+    glm::vec3 eye(cameraToWorld[3][0], cameraToWorld[3][1], cameraToWorld[3][2]);
+    float pixelScale = viewportHeight * projection[1][1] / 2;
+
+    std::vector<int> visible;
+    std::vector<std::pair<float, int> > missing;
+    traverse(map->getRoot(), pvm, eye, pixelScale, visible, missing);
+    upload();
+    request(missing);
+
+    // Points are stored relative to their node, a matrix per node scales them back.
+    GLuint vColor = 1;
+    glVertexAttrib4f(vColor, 0.55f, 0.6f, 0.7f, 1);
+    for (int i = 0; i < visible.size(); i++)
+    {
+        const DriveMap::Node& node = map->getNode(visible[i]);
+        glm::mat4 nodeToWorld = glm::translate(glm::mat4(1.0), glm::vec3(node.origin[0], node.origin[1], node.origin[2]));
+        nodeToWorld = glm::scale(nodeToWorld, glm::vec3(node.size / DriveMap::MAX_COORD));
+        glUniformMatrix4fv(PVMLoc, 1, GL_FALSE, glm::value_ptr(pvm * nodeToWorld));
+
+        glBindVertexArray(slots[visible[i]].vao);
+        glDrawArrays(GL_POINTS, 0, node.numPoints);
+    }
+
+    glUniformMatrix4fv(PVMLoc, 1, GL_FALSE, glm::value_ptr(projection * view));
+}
+
+/**
+\brief Walk a node and its children while they are in view and coarser than MAX_SCREEN_ERROR.
+Children of a node not on the GPU yet are left for later, so the map fills in coarse to fine.
+
+\param node - index of the node.
+\param pvm - projection*view*model of the map frame.
+\param eye - camera position in map frame.
+\param pixelScale - pixels spanned by one meter at a distance of one meter.
+\param visible - receives the nodes to draw.
+\param missing - receives screen error and index of nodes to read.
+*/
+
+void MapLoader::traverse(int node, const glm::mat4& pvm, const glm::vec3& eye, float pixelScale,
+                         std::vector<int>& visible, std::vector<std::pair<float, int> >& missing)
+{
+    const DriveMap::Node& n = map->getNode(node);
+    float half = n.size / 2;
+    glm::vec3 center(n.origin[0] + half, n.origin[1] + half, n.origin[2] + half);
+    float radius = half * sqrtf(3);
+    if (!isInView(pvm, center, radius))
+        return;
+
+    glm::vec3 offset(eye[0] - center[0], eye[1] - center[1], eye[2] - center[2]);
+    float distance = sqrtf(offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2]);
+    float error = n.size / DriveMap::GRID * pixelScale / std::max(distance - radius, 0.001f);
+
+    Slot& slot = slots[node];
+    if (slot.state != RESIDENT)
+    {
+        missing.push_back(std::make_pair(error, node));
+        return;
+    }
+    slot.lastDrawn = drawCount;
+    if (n.numPoints > 0)
+        visible.push_back(node);
+
+    if (error <= MAX_SCREEN_ERROR)
+        return;
+    for (int i = 0; i < 8; i++)
+    {
+        if (n.children[i] >= 0)
+            traverse(n.children[i], pvm, eye, pixelScale, visible, missing);
+    }
+}
+
+/**
+\brief Upload nodes read in background, making room by dropping nodes not drawn this frame.
+Nodes that do not fit are dropped and read again when wanted.
+*/
+
+void MapLoader::upload()
+{
+    GLuint vPosition = 0;
+    for (int i = 0; i < MAX_UPLOADS; i++)
+    {
+        Read read;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (reads.empty())
+                break;
+            read = std::move(reads.front());
+            reads.pop_front();
+        }
+
+        Slot& slot = slots[read.node];
+        size_t bytes = getBytes(read.node);
+        if (read.points.size() * sizeof(uint16_t) != bytes || !reserve(bytes))
+        {
+            slot.state = ABSENT;
+            continue;
+        }
+
+        glGenVertexArrays(1, &slot.vao);
+        glGenBuffers(1, &slot.buffer);
+        glBindVertexArray(slot.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, slot.buffer);
+        glBufferData(GL_ARRAY_BUFFER, bytes, read.points.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(vPosition, 3, GL_UNSIGNED_SHORT, GL_FALSE, 0, BUFFER_OFFSET(0));
+        glEnableVertexAttribArray(vPosition);
+
+        slot.state = RESIDENT;
+        slot.lastDrawn = drawCount;
+        gpuBytes += bytes;
+    }
+}
+
+/**
+\brief Replace the nodes waiting to be read by the nodes missing this frame, coarsest on
+largest screen error first, as many as fit in the GPU budget once nodes not drawn are dropped.
+
+\param missing - screen error and index of nodes not on the GPU.
+*/
+
+void MapLoader::request(std::vector<std::pair<float, int> >& missing)
+{
+    std::sort(missing.begin(), missing.end(), std::greater<std::pair<float, int> >());
+
+    size_t room = gpuBudget > gpuBytes ? gpuBudget - gpuBytes : 0;
+    for (int i = 0; i < slots.size(); i++)
+    {
+        if (slots[i].state == RESIDENT && slots[i].lastDrawn < drawCount)
+            room += getBytes(i);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int i = 0; i < requests.size(); i++)
+            slots[requests[i]].state = ABSENT;
+        requests.clear();
+
+        for (int i = 0; i < missing.size() && requests.size() < MAX_REQUESTS; i++)
+        {
+            int node = missing[i].second;
+            size_t bytes = getBytes(node);
+            if (slots[node].state != ABSENT || bytes > room)
+                continue;
+            room -= bytes;
+            slots[node].state = REQUESTED;
+            requests.push_back(node);
+        }
+    }
+    cond.notify_one();
+}
+
+/**
+\brief Drop nodes not drawn this frame, least recently drawn first, until bytes fit in the
+GPU budget.
+
+\return false if they do not fit.
+*/
+
+bool MapLoader::reserve(size_t bytes)
+{
+    while (gpuBytes + bytes > gpuBudget)
+    {
+        int oldest = -1;
+        for (int i = 0; i < slots.size(); i++)
+        {
+            if (slots[i].state == RESIDENT && slots[i].lastDrawn < drawCount &&
+                (oldest < 0 || slots[i].lastDrawn < slots[oldest].lastDrawn))
+                oldest = i;
+        }
+        if (oldest < 0)
+            return false;
+        release(oldest);
+    }
+    return true;
+}
+
+void MapLoader::release(int node)
+{
+    Slot& slot = slots[node];
+    glDeleteBuffers(1, &slot.buffer);
+    glDeleteVertexArrays(1, &slot.vao);
+    slot.state = ABSENT;
+    gpuBytes -= getBytes(node);
+}
+
+size_t MapLoader::getBytes(int node) const
+{
+    return (size_t)map->getNode(node).numPoints * 3 * sizeof(uint16_t);
+}
+
+/**
+\brief Read requested nodes in order. A node that fails to read is handed over empty and
+dropped on upload.
+*/
+
+void MapLoader::runReader()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        cond.wait(lock, [this]() { return isStop || !requests.empty(); });
+        if (isStop)
+            return;
+
+        Read read;
+        read.node = requests.front();
+        requests.pop_front();
+
+        lock.unlock();
+        if (!map->readPoints(read.node, read.points))
+            read.points.clear();
+        lock.lock();
+
+        reads.push_back(std::move(read));
+    }
+}
+
+/**
+\brief Check if a sphere is at least partly inside the view frustum, with planes taken from the
+rows of the clip matrix.
+*/
+
+bool MapLoader::isInView(const glm::mat4& pvm, const glm::vec3& center, float radius)
+{
+    for (int row = 0; row < 3; row++)
+    {
+        for (int sign = -1; sign <= 1; sign += 2)
+        {
+            float plane[4];
+            for (int col = 0; col < 4; col++)
+                plane[col] = pvm[col][3] + sign * pvm[col][row];
+
+            float distance = plane[0] * center[0] + plane[1] * center[1] + plane[2] * center[2] + plane[3];
+            float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+            if (distance < -radius * length)
+                return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,111 @@
+#ifndef MAPLOADER_H
+#define MAPLOADER_H
+
+#include <GL/glew.h>
+#include <stdio.h>
+#include <cstdlib>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <math.h>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#define GLM_SWIZZLE
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "../patterns/Observer.h"
+#include "../utils/ProgramDefines.h"
+#include "../data/OXT.h"
+#include "DriveMap.h"
+#include "PointsLoader.h"
+#include "ConfigLoader.h"
+
+/**
+\class MapLoader
+
+\brief Draws the DriveMap of the drive around the current frame, streaming nodes from disk.
+
+Each frame the octree is walked from the root. Nodes outside the view are skipped, and the
+children of a node are only visited while its point spacing spans more than MAX_SCREEN_ERROR
+pixels, so far away parts of the drive are drawn from a few coarse nodes. Nodes not on the GPU
+are read by a background thread, most coarse first, and uploaded on the next draw. Nodes not
+drawn lately are dropped once the GPU budget is reached.
+
+*/
+
+class MapLoader : public Observer<OXT>
+{
+    public:
+        ~MapLoader();
+        static MapLoader* getInstance();
+
+        static constexpr float MAX_SCREEN_ERROR = 2;    ///< Pixels between points of a node before its children are drawn.
+        static const int MAX_UPLOADS = 8;               ///< Nodes uploaded per draw.
+        static const int MAX_REQUESTS = 32;             ///< Nodes waiting to be read.
+
+        void open(std::string filename);
+        bool isOpen() const;
+        void update(std::shared_ptr<const OXT> oxt);
+        void draw(GLuint PVMLoc, const glm::mat4& projection, const glm::mat4& view, int viewportHeight);
+
+        size_t getGPUBytes() const;
+    protected:
+    private:
+        MapLoader();
+
+        enum State : uint8_t
+        {
+            ABSENT,
+            REQUESTED,      ///< Queued or being read.
+            RESIDENT
+        };
+
+        struct Slot
+        {
+            State state;
+            GLuint vao;
+            GLuint buffer;
+            unsigned lastDrawn;         ///< Draw count the node was last drawn at.
+        };
+
+        struct Read
+        {
+            int node;
+            std::vector<uint16_t> points;
+        };
+
+        static MapLoader* mInstance;
+
+        DriveMap* map = NULL;
+        std::vector<Slot> slots;        ///< State of each node, render thread only.
+        size_t gpuBudget;               ///< Bytes of node buffers kept on the GPU.
+        size_t gpuBytes = 0;
+        unsigned drawCount = 0;
+        bool hasPose = false;
+        glm::mat4 worldToRender;        ///< From map frame to render frame of the current sweep.
+
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::deque<int> requests;       ///< Nodes to read, most wanted first, guarded by mutex.
+        std::deque<Read> reads;         ///< Nodes read and waiting for upload, guarded by mutex.
+        bool isStop = false;
+        std::thread readerThread;
+
+        void traverse(int node, const glm::mat4& pvm, const glm::vec3& eye, float pixelScale,
+                      std::vector<int>& visible, std::vector<std::pair<float, int> >& missing);
+        void upload();
+        void request(std::vector<std::pair<float, int> >& missing);
+        bool reserve(size_t bytes);
+        void release(int node);
+        size_t getBytes(int node) const;
+        void runReader();
+
+        static bool isInView(const glm::mat4& pvm, const glm::vec3& center, float radius);
+};
+
+#endif // MAPLOADER_H
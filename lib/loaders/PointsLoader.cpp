@@ -10,21 +10,42 @@
 
 */
 
+PointsLoader* PointsLoader::mInstance = NULL;
+
+const int PointsLoader::MAX_SWEEPS;
+const int PointsLoader::MAX_SWEEP_GAP;
+
+// Same as PointTransform::SENSOR_TO_RENDER, flips y and z.
+const glm::mat4 PointsLoader::SENSOR_TO_RENDER = glm::scale(glm::mat4(1.0), glm::vec3(1, -1, -1));
+
 /**
 \brief Constructor
 
-Loads the shaders, and sets some initial data settings.
+Creates a vertex buffer and vertex array for every slot of the sweep ring.
 
 */
 
-PointsLoader* PointsLoader::mInstance = NULL;
-
 PointsLoader::PointsLoader()
 {
-    // This creates our identifier and puts it in vbo
-    glGenVertexArrays(1, &vboptr);
-    glGenBuffers(1, &eboptr);
-    glGenBuffers(1, &bufptr);
+    GLuint vPosition = 0;
+    ConfigLoader* conf = ConfigLoader::getInstance();
+    pointBudget = conf->getPointBudget();
+    numSweeps = std::min(std::max(conf->getNumSweeps(), 1), MAX_SWEEPS);
+
+    for (int i = 0; i < MAX_SWEEPS; i++)
+    {
+        Slot& slot = slots[i];
+        glGenVertexArrays(1, &slot.vao);
+        glGenBuffers(1, &slot.buffer);
+        slot.bufferSize = 0;
+        slot.numPoints = 0;
+        slot.frameId = -1;
+
+        glBindVertexArray(slot.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, slot.buffer);
+        glVertexAttribPointer(vPosition, 4, GL_FLOAT, GL_FALSE, 0, BUFFER_OFFSET(0));
+        glEnableVertexAttribArray(vPosition);
+    }
 }
 
 /**
@@ -34,9 +55,11 @@ PointsLoader::PointsLoader()
 
 PointsLoader::~PointsLoader()
 {
-    glBindVertexArray(vboptr);
-    glDeleteBuffers(1, &bufptr);
-    glDeleteBuffers(1, &eboptr);
+    for (int i = 0; i < MAX_SWEEPS; i++)
+    {
+        glDeleteBuffers(1, &slots[i].buffer);
+        glDeleteVertexArrays(1, &slots[i].vao);
+    }
 }
 
 /**
@@ -55,76 +78,167 @@ PointsLoader* PointsLoader::getInstance() {
 }
 
 /**
-\brief Loads the vertex and color data to the graphics card by vector<float>.
+\brief Receive the sweep of a new frame. It is uploaded on the next draw, once the OXT record
+of the frame, dispatched right after, is known as well.
 
 */
 
-void PointsLoader::update(CloudPoints cp)
+void PointsLoader::update(std::shared_ptr<const CloudPoints> cp)
 {
-    isLoaded = true;
+    pendingPoints = cp;
+    pendingOXT = NULL;
+}
 
-    std::vector<float> data = cp.getData();
-    
-    GLuint vPosition = 0;
-    GLuint vColor = 1;
+/**
+\brief Receive the OXT record of a new frame, giving the pose of its sweep.
 
-    num_pts = data.size() / 4;
-    GLfloat points[num_pts * 4];
-    for (uint i = 0; i < num_pts; i++)
-    {
-        points[i*4] = data[i*4];
-        points[i*4 + 1] = -data[i*4 + 1];
-        // Z axis need to be shifted down by 2.9 ft because that is the height of velodyne radar
-        points[i*4 + 2] = -(data[i*4 + 2]);
-        points[i*4 + 3] = 1;
-    }
+*/
+
+void PointsLoader::update(std::shared_ptr<const OXT> oxt)
+{
+    pendingOXT = oxt;
+}
+
+/**
+\brief Upload the pending sweep into the ring.
+
+The vertices are already in render frame, transformed by the loader thread, so they are
+uploaded as they are. A buffer is only reallocated when it grows, otherwise it is overwritten.
+A sweep of the same frame as the newest one, loaded again after a settings change, replaces
+it. A jump in time, such as a seek, empties the ring.
+
+*/
 
+void PointsLoader::commit()
+{
+    if (!pendingPoints)
+        return;
+
+    // Sweeps without a pose can not be placed relative to each other.
+    int frameId = pendingOXT ? pendingPoints->getFrameID() : -1;
+    if (newest >= 0 && (frameId < 0 || slots[newest].frameId < 0 || abs(frameId - slots[newest].frameId) > MAX_SWEEP_GAP))
+        clear();
+    if (newest < 0 || frameId != slots[newest].frameId)
+        newest = (newest + 1) % MAX_SWEEPS;
 
-    GLushort indices[num_pts];
-    for (uint i = 0; i < num_pts; i++)
+    Slot& slot = slots[newest];
+    ArrayView<float> vertices = pendingPoints->getVertices();
+    GLsizeiptr size = vertices.size() * sizeof(float);
+
+    glBindBuffer(GL_ARRAY_BUFFER, slot.buffer);
+    if (size > slot.bufferSize)
     {
-        indices[i] = i;
+        slot.bufferSize = size;
+        glBufferData(GL_ARRAY_BUFFER, slot.bufferSize, NULL, GL_DYNAMIC_DRAW);
     }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size, vertices.data());
+
+    slot.numPoints = pendingPoints->getNumPoints();
+    slot.frameId = frameId;
+    slot.pose = pendingOXT ? pendingOXT->getVelodynePose() : glm::mat4(1.0);
+
+    pendingPoints = NULL;
+    pendingOXT = NULL;
+}
+
+/**
+\brief Drop every sweep of the ring, their buffers are kept for reuse.
 
-    GLfloat colors[num_pts * 3];
-    for (uint i = 0; i < num_pts; i++)
+*/
+
+void PointsLoader::clear()
+{
+    for (int i = 0; i < MAX_SWEEPS; i++)
     {
-        // float dst = sqrt(pow(points[3*i], 2) + pow(points[3*i+1], 2));
-        colors[i * 3] = 0;
-        colors[i * 3 + 1] = 1;
-        colors[i * 3 + 2] = 0;
+        slots[i].numPoints = 0;
+        slots[i].frameId = -1;
     }
+    newest = -1;
+}
+
+/**
+\brief Set most points drawn per frame, for GPUs too slow to draw whole sweeps.
+
+\param maxPoints - number of points, 0 to draw every point.
+*/
+
+void PointsLoader::setPointBudget(GLuint maxPoints)
+{
+    pointBudget = maxPoints;
+}
 
-    glGenVertexArrays(1, &vboptr);
-    glBindVertexArray(vboptr);
+/**
+\brief Get most points drawn per frame, 0 if every point is drawn.
+*/
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, eboptr);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_DYNAMIC_DRAW);
+GLuint PointsLoader::getPointBudget() const
+{
+    return pointBudget;
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, bufptr);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(points) * 2 + sizeof(colors), NULL, GL_DYNAMIC_DRAW);
+/**
+\brief Set number of sweeps shown, the current one and those before it. Sweeps already in the
+ring show up right away.
 
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(points), points);
-    glBufferSubData(GL_ARRAY_BUFFER, sizeof(points), sizeof(colors), colors);
-    glVertexAttribPointer(vColor, 3, GL_FLOAT, GL_TRUE, 0, BUFFER_OFFSET(sizeof(points)));
-    glVertexAttribPointer(vPosition, 4, GL_FLOAT, GL_FALSE, 0, BUFFER_OFFSET(0));
+\param count - number of sweeps, 1 to MAX_SWEEPS.
+*/
 
-    glEnableVertexAttribArray(vPosition);
-    glEnableVertexAttribArray(vColor);
+void PointsLoader::setNumSweeps(int count)
+{
+    numSweeps = std::min(std::max(count, 1), MAX_SWEEPS);
+}
+
+/**
+\brief Get number of sweeps shown.
+*/
+
+int PointsLoader::getNumSweeps() const
+{
+    return numSweeps;
 }
 
 /**
 \brief Load and draw cloud points.
 
+Sweeps are in progressive order, so drawing the first points of a sweep shows all of it at
+lower density. Fewer points are drawn with a single draw call, without uploading again. The
+point budget is shared by the sweeps shown, older sweeps are drawn darker.
+
+\param PVMLoc - location of PVM matrix in the shader.
+\param pvm - projection*view*model of the current sweep, restored before returning.
+\param detail - fraction of the point budget to draw, 0 to 1.
 */
 
-void PointsLoader::draw() 
+void PointsLoader::draw(GLuint PVMLoc, const glm::mat4& pvm, float detail)
 {
-    if (!isLoaded)
+    commit();
+    if (newest < 0)
         return;
 
-    // Draw points
-    glBindVertexArray(vboptr);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, eboptr);
-    glDrawElements(GL_POINTS, num_pts * 3, GL_UNSIGNED_SHORT, NULL);
-}
\ No newline at end of file
+    GLuint vColor = 1;
+    detail = std::max(std::min(detail, 1.0f), 0.0f);
+    glm::mat4 renderToWorld = slots[newest].pose * SENSOR_TO_RENDER;
+    glm::mat4 worldToRender = glm::inverse(renderToWorld);
+
+    for (int age = numSweeps - 1; age >= 0; age--)
+    {
+        const Slot& slot = slots[(newest - age + MAX_SWEEPS) % MAX_SWEEPS];
+        if (slot.numPoints == 0)
+            continue;
+
+        GLuint count = pointBudget > 0 ? std::min(slot.numPoints, std::max(pointBudget / numSweeps, 1u)) : slot.numPoints;
+        count = std::min((GLuint)ceil(count * detail), slot.numPoints);
+
+        // Only a matrix per slot changes, the vertices of older sweeps are not touched.
+        glm::mat4 slotToRender = age == 0 ? glm::mat4(1.0) : worldToRender * slot.pose * SENSOR_TO_RENDER;
+        glUniformMatrix4fv(PVMLoc, 1, GL_FALSE, glm::value_ptr(pvm * slotToRender));
+
+        // Every point is green, the color attribute is a constant rather than an array.
+        glVertexAttrib4f(vColor, 0, 1 - 0.6f * age / numSweeps, 0, 1);
+
+        glBindVertexArray(slot.vao);
+        glDrawArrays(GL_POINTS, 0, count);
+    }
+
+    glUniformMatrix4fv(PVMLoc, 1, GL_FALSE, glm::value_ptr(pvm));
+}
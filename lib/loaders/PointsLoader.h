@@ -23,31 +23,65 @@
 #include "../utils/ProgramDefines.h"
 #include "../utils/LoadShaders.h"
 #include "../data/CloudPoints.h"
+#include "../data/OXT.h"
+#include "ConfigLoader.h"
 
-class PointsLoader : public Observer<CloudPoints>
+/**
+\class PointsLoader
+
+\brief Draws the current velodyne sweep, optionally along with the sweeps before it.
+
+Sweeps stay on the GPU in a ring of vertex buffers, one slot per sweep. Each slot keeps the
+ego pose of its frame, older sweeps are moved into the frame of the current one by a per-slot
+matrix in the shader. A new frame uploads only its own sweep, however many are shown.
+
+*/
+
+class PointsLoader : public Observer<CloudPoints>, public Observer<OXT>
 {
     public:
         ~PointsLoader();
         static PointsLoader* getInstance();
 
-        void draw();
-        void update(CloudPoints);
+        static const int MAX_SWEEPS = 20;       ///< Most sweeps shown at once.
+        static const int MAX_SWEEP_GAP = 16;    ///< Frames between sweeps beyond which older sweeps are dropped.
+        static const glm::mat4 SENSOR_TO_RENDER;    ///< Velodyne frame to render frame.
 
-        void LoadDataToGraphicsCard(std::vector<float>);
+        void draw(GLuint PVMLoc, const glm::mat4& pvm, float detail = 1);
+        void update(std::shared_ptr<const CloudPoints> cp);
+        void update(std::shared_ptr<const OXT> oxt);
+
+        void setPointBudget(GLuint maxPoints);
+        GLuint getPointBudget() const;
+        void setNumSweeps(int count);
+        int getNumSweeps() const;
     protected:
     private:
         PointsLoader();
 
+        struct Slot
+        {
+            GLuint vao;                 ///< ID for points VAO.
+            GLuint buffer;              ///< ID for vertex buffer, x, y, z, 1 per point.
+            GLsizeiptr bufferSize;      ///< Bytes allocated in vertex buffer.
+            GLuint numPoints;           ///< 0 if slot is empty.
+            int frameId;                ///< Frame of sweep, -1 if unknown.
+            glm::mat4 pose;             ///< Velodyne to world.
+        };
+
         static PointsLoader* mInstance;
-        bool isLoaded;
 
-        static constexpr float maxVelodyneDst = 80;     ///< Approximation of max distance of points in KITTI velodyne setup.
+        GLuint pointBudget = 0;         ///< Most points drawn per frame, 0 for all.
+        int numSweeps = 1;              ///< Sweeps shown, newest first.
+
+        Slot slots[MAX_SWEEPS];
+        int newest = -1;                ///< Slot of current sweep, -1 before first sweep.
 
-        GLuint num_pts;
+        std::shared_ptr<const CloudPoints> pendingPoints;   ///< Sweep dispatched since last draw.
+        std::shared_ptr<const OXT> pendingOXT;              ///< Its OXT record, NULL if none.
 
-        GLuint vboptr;  ///< ID for faces VBO.
-        GLuint eboptr;  ///< ID for faces index array.
-        GLuint bufptr;  ///< ID for faces array buffer.
+        void commit();
+        void clear();
 };
 
 #endif // POINTSLOADER_H
@@ -29,7 +29,7 @@ class Gauge : public Observer<OXT>, public TextureController {
         ~Gauge();
 
         void draw();
-        virtual void update(OXT oxt) = 0;
+        virtual void update(std::shared_ptr<const OXT> oxt) = 0;
     protected:
         glm::mat4 location;
         glm::mat4 levels[10];
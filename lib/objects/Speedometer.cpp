@@ -20,10 +20,9 @@ void Speedometer::draw()
     unit->draw();
 }
 
-void Speedometer::update(OXT oxt)
+void Speedometer::update(std::shared_ptr<const OXT> oxt)
 {
-    float value = sqrt(pow(oxt.vf, 2) + pow(oxt.vl, 2) + pow(oxt.vu, 2));
-    unit->updateSpeed(value);
+    unit->updateSpeed(oxt->getSpeed());
 }
 
 float Speedometer::getSpeed()
@@ -136,7 +136,7 @@ class Speedometer : public Gauge
 
         void toggleUnit();
 
-        virtual void update(OXT oxt) override;
+        virtual void update(std::shared_ptr<const OXT> oxt) override;
     protected:
 
     private:
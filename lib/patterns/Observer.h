@@ -1,11 +1,15 @@
 #ifndef OBSERVER_H
 #define OBSERVER_H
 
+#include <memory>
+
 template <class T>
 
 class Observer {
     public:
-        virtual void update(T data) = 0;
+        virtual ~Observer() {}
+        // Data is shared by all observers and never changes, so observers may keep it.
+        virtual void update(std::shared_ptr<const T> data) = 0;
     protected:
 };
 
@@ -0,0 +1 @@
+#include "ArrayView.h"
@@ -0,0 +1,29 @@
+#ifndef ARRAY_VIEW
+#define ARRAY_VIEW
+
+#include <cstddef>
+#include <vector>
+
+// A read-only view of contiguous elements owned by someone else, e.g. the samples of a
+// shared frame. Copying a view never copies the elements, the owner must outlive it.
+template <typename T>
+class ArrayView
+{
+    public:
+        ArrayView() : data_(NULL), size_(0) {}
+        ArrayView(const T* data, size_t size) : data_(data), size_(size) {}
+        ArrayView(const std::vector<T>& v) : data_(v.empty() ? NULL : &v[0]), size_(v.size()) {}
+
+        const T* data() const { return data_; }
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+
+        const T& operator[](size_t i) const { return data_[i]; }
+        const T* begin() const { return data_; }
+        const T* end() const { return data_ + size_; }
+
+    private:
+        const T* data_;
+        size_t size_;
+};
+#endif
@@ -0,0 +1,76 @@
+#include "BufferPool.h"
+
+BufferPool* BufferPool::mInstance = NULL;
+
+const size_t BufferPool::MAX_FREE_BYTES;
+const size_t BufferPool::ALIGNMENT;
+
+BufferPool::BufferPool()
+{
+    //ctor
+}
+
+BufferPool::~BufferPool()
+{
+    for (int i = 0; i < freeBlocks.size(); i++)
+        free(freeBlocks[i].data);
+}
+
+BufferPool* BufferPool::getInstance()
+{
+    static std::once_flag flag;
+    std::call_once(flag, []() { mInstance = new BufferPool(); });
+    return mInstance;
+}
+
+/**
+\brief Get a buffer, reusing an idle one of the same size if there is one.
+
+\param  size - number of bytes.
+\return buffer that returns to the pool when released, exits if out of memory.
+*/
+
+std::shared_ptr<FileBuffer> BufferPool::acquire(size_t size)
+{
+    void* data = NULL;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int i = freeBlocks.size() - 1; i >= 0; i--)
+        {
+            if (freeBlocks[i].size == size)
+            {
+                data = freeBlocks[i].data;
+                freeBytes -= size;
+                freeBlocks.erase(freeBlocks.begin() + i);
+                break;
+            }
+        }
+    }
+
+    if (!data && posix_memalign(&data, ALIGNMENT, size > 0 ? size : 1) != 0)
+    {
+        printf("Unable to allocate %zu bytes.\n", size);
+        exit(1);
+    }
+    return std::make_shared<FileBuffer>((char*)data, size, [this, data, size]() { release(data, size); });
+}
+
+/**
+\brief Keep a released buffer for reuse, freeing the oldest idle buffers over budget.
+*/
+
+void BufferPool::release(void* data, size_t size)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    freeBlocks.push_back({data, size});
+    freeBytes += size;
+
+    int numFreed = 0;
+    while (freeBytes > MAX_FREE_BYTES && numFreed < freeBlocks.size())
+    {
+        freeBytes -= freeBlocks[numFreed].size;
+        free(freeBlocks[numFreed].data);
+        numFreed++;
+    }
+    freeBlocks.erase(freeBlocks.begin(), freeBlocks.begin() + numFreed);
+}
@@ -0,0 +1,50 @@
+#ifndef BUFFERPOOL_H
+#define BUFFERPOOL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "FileBuffer.h"
+
+/**
+\class BufferPool
+
+\brief Recycles heap buffers of recurring sizes, such as decoded camera frames which all
+have the same size within a drive. A buffer goes back to the pool when its last reference
+is released, instead of being freed.
+
+*/
+
+class BufferPool
+{
+    public:
+        static const size_t MAX_FREE_BYTES = 256 << 20;     ///< Idle memory kept for reuse, older buffers are freed beyond it.
+        static const size_t ALIGNMENT = 64;
+
+        static BufferPool* getInstance();
+        ~BufferPool();
+
+        std::shared_ptr<FileBuffer> acquire(size_t size);
+    protected:
+    private:
+        BufferPool();
+
+        struct Block
+        {
+            void* data;
+            size_t size;
+        };
+
+        static BufferPool* mInstance;
+
+        std::mutex mutex;
+        std::vector<Block> freeBlocks;      ///< Idle buffers, most recently released last.
+        size_t freeBytes = 0;
+
+        void release(void* data, size_t size);
+};
+
+#endif // BUFFERPOOL_H
@@ -0,0 +1,105 @@
+#include "DirectBackend.h"
+
+const size_t DirectBackend::DIRECT_ALIGNMENT;
+
+DirectBackend::DirectBackend()
+{
+    //ctor
+}
+
+DirectBackend::~DirectBackend()
+{
+    //dtor
+}
+
+const char* DirectBackend::getName() const
+{
+    return "direct";
+}
+
+/**
+\brief Read a whole file with O_DIRECT. Length is rounded up to block size, the last read
+comes back short and buffer is trimmed to the file size.
+
+\param  filename - path of the file.
+\return content of the file.
+*/
+
+std::shared_ptr<FileBuffer> DirectBackend::readFile(const std::string& filename)
+{
+    size_t size;
+    int fd = openFile(filename, O_DIRECT, size);
+    if (fd < 0 && errno == EINVAL)
+        fd = openFile(filename, 0, size);
+    if (fd < 0)
+        exitMissing(filename);
+
+    size_t alignedSize = (size + DIRECT_ALIGNMENT - 1) / DIRECT_ALIGNMENT * DIRECT_ALIGNMENT;
+    std::shared_ptr<FileBuffer> buffer = FileBuffer::allocate(alignedSize, DIRECT_ALIGNMENT);
+    readFully(fd, filename, buffer.get(), 0, alignedSize);
+    buffer->setSize(size);
+    close(fd);
+    return buffer;
+}
+
+/**
+\brief Open archive with O_DIRECT, archives are the cold data this backend is meant for.
+
+\param  filename - path of the archive.
+\param  size - receives size of the archive.
+\return file descriptor, exits if archive can not be opened.
+*/
+
+int DirectBackend::openArchive(const std::string& filename, size_t& size)
+{
+    int fd = openFile(filename, O_DIRECT, size);
+    if (fd < 0 && errno == EINVAL)
+        fd = openFile(filename, 0, size);
+    if (fd < 0)
+        exitMissing(filename);
+    return fd;
+}
+
+/**
+\brief Read ranges of an archive with block aligned reads. The buffer points at the first
+byte of the range inside the aligned block.
+
+\param  fd - archive opened by openArchive.
+\param  ranges - byte ranges to read.
+\return content of each range.
+*/
+
+std::vector<std::shared_ptr<FileBuffer> > DirectBackend::readFileRanges(int fd, const std::vector<Range>& ranges)
+{
+    std::vector<std::shared_ptr<FileBuffer> > buffers;
+    for (int i = 0; i < ranges.size(); i++)
+    {
+        uint64_t start = ranges[i].offset / DIRECT_ALIGNMENT * DIRECT_ALIGNMENT;
+        uint64_t end = (ranges[i].offset + ranges[i].size + DIRECT_ALIGNMENT - 1) / DIRECT_ALIGNMENT * DIRECT_ALIGNMENT;
+
+        std::shared_ptr<FileBuffer> block = FileBuffer::allocate(end - start, DIRECT_ALIGNMENT);
+        size_t done = 0;
+        while (done < end - start)
+        {
+            ssize_t n = pread(fd, block->getData() + done, end - start - done, start + done);
+            if (n < 0)
+            {
+                printf(" Error, Couldn't read archive at offset %llu.\n", (unsigned long long)(start + done));
+                exit(1);
+            }
+            if (n == 0)
+                break;
+            done += n;
+        }
+        if (start + done < ranges[i].offset + ranges[i].size)
+        {
+            printf(" Error, Archive is truncated at offset %llu.\n", (unsigned long long)(start + done));
+            exit(1);
+        }
+
+        // The range keeps its aligned block alive.
+        char* first = block->getData() + (ranges[i].offset - start);
+        buffers.push_back(std::make_shared<FileBuffer>(first, ranges[i].size, [block]() {}));
+    }
+    return buffers;
+}
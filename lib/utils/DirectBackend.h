@@ -0,0 +1,31 @@
+#ifndef DIRECTBACKEND_H
+#define DIRECTBACKEND_H
+
+#include "IOBackend.h"
+
+/**
+\class DirectBackend
+
+\brief Reads with O_DIRECT, bypassing the page cache. Meant for cold archives streamed once,
+where caching would only evict more useful pages. Falls back to buffered reads on file
+systems without O_DIRECT support.
+
+*/
+
+class DirectBackend : public IOBackend
+{
+    public:
+        DirectBackend();
+        virtual ~DirectBackend();
+
+        static const size_t DIRECT_ALIGNMENT = 4096;      ///< Alignment of O_DIRECT buffers, offsets and lengths.
+
+        virtual const char* getName() const;
+        virtual int openArchive(const std::string& filename, size_t& size);
+    protected:
+        virtual std::shared_ptr<FileBuffer> readFile(const std::string& filename);
+        virtual std::vector<std::shared_ptr<FileBuffer> > readFileRanges(int fd, const std::vector<Range>& ranges);
+    private:
+};
+
+#endif // DIRECTBACKEND_H
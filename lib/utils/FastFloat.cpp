@@ -0,0 +1,118 @@
+#include "FastFloat.h"
+
+const int FastFloat::MAX_DIGITS;
+const int FastFloat::MAX_EXACT_POWER;
+const int FastFloat::MAX_TEXT;
+
+static const double POWERS_OF_TEN[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/**
+\brief Parse the next number, skipping whitespace in front of it.
+
+\param cursor - where to start, moved past the number on success.
+\param end - end of text.
+\param value - receives the number.
+\return false if there is no number at cursor.
+*/
+
+bool FastFloat::parse(const char*& cursor, const char* end, double& value)
+{
+    const char* p = cursor;
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+        p++;
+    const char* start = p;
+
+    bool isNegative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        isNegative = *p++ == '-';
+
+    uint64_t mantissa = 0;
+    int numDigits = 0;
+    int exponent = 0;
+    bool hasDigits = false;
+    for (; p < end && *p >= '0' && *p <= '9'; p++)
+    {
+        hasDigits = true;
+        if (mantissa == 0 && *p == '0')
+            continue;
+        if (++numDigits > MAX_DIGITS)
+            return parseSlow(start, cursor, end, value);
+        mantissa = mantissa * 10 + (*p - '0');
+    }
+    if (p < end && *p == '.')
+    {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++)
+        {
+            hasDigits = true;
+            if (mantissa == 0 && *p == '0') {
+                exponent--;
+                continue;
+            }
+            if (++numDigits > MAX_DIGITS)
+                return parseSlow(start, cursor, end, value);
+            mantissa = mantissa * 10 + (*p - '0');
+            exponent--;
+        }
+    }
+    if (!hasDigits)
+        return false;
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        const char* q = p + 1;
+        bool isNegativeExponent = false;
+        if (q < end && (*q == '-' || *q == '+'))
+            isNegativeExponent = *q++ == '-';
+        if (q < end && *q >= '0' && *q <= '9')
+        {
+            int e = 0;
+            for (; q < end && *q >= '0' && *q <= '9'; q++)
+                e = e < 10000 ? e * 10 + (*q - '0') : e;
+            exponent += isNegativeExponent ? -e : e;
+            p = q;
+        }
+    }
+
+    // Both operands are exact below 2^53 and 1e22, so the single rounding step gives the
+    // correctly rounded result.
+    if (mantissa >= (1ULL << 53) || exponent < -MAX_EXACT_POWER || exponent > MAX_EXACT_POWER)
+        return parseSlow(start, cursor, end, value);
+
+    value = (double)mantissa;
+    if (exponent < 0)
+        value /= POWERS_OF_TEN[-exponent];
+    else
+        value *= POWERS_OF_TEN[exponent];
+    if (isNegative)
+        value = -value;
+    cursor = p;
+    return true;
+}
+
+/**
+\brief Parse a number the fast path can not convert exactly.
+
+\param start - first character of the number.
+\param cursor - moved past the number on success.
+\param end - end of text.
+\param value - receives the number.
+\return false if there is no number at start.
+*/
+
+bool FastFloat::parseSlow(const char* start, const char*& cursor, const char* end, double& value)
+{
+    char text[MAX_TEXT + 1];
+    size_t size = end - start < MAX_TEXT ? end - start : MAX_TEXT;
+    memcpy(text, start, size);
+    text[size] = 0;
+
+    char* parsed;
+    value = strtod(text, &parsed);
+    if (parsed == text)
+        return false;
+    cursor = start + (parsed - text);
+    return true;
+}
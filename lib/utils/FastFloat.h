@@ -0,0 +1,32 @@
+#ifndef FASTFLOAT_H
+#define FASTFLOAT_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+\class FastFloat
+
+\brief Parses decimal numbers from text that is not null terminated.
+
+Numbers with up to 19 significant digits and a small exponent, which is every number in KITTI
+text files, are converted exactly with one multiplication or division by a power of ten.
+Anything else falls back to strtod.
+
+*/
+
+class FastFloat
+{
+    public:
+        static bool parse(const char*& cursor, const char* end, double& value);
+    protected:
+    private:
+        static const int MAX_DIGITS = 19;       ///< Digits that always fit in a uint64_t.
+        static const int MAX_EXACT_POWER = 22;  ///< Largest power of ten exact in a double.
+        static const int MAX_TEXT = 64;         ///< Longest number handed to strtod.
+
+        static bool parseSlow(const char* start, const char*& cursor, const char* end, double& value);
+};
+
+#endif // FASTFLOAT_H
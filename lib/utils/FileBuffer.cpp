@@ -0,0 +1,64 @@
+#include "FileBuffer.h"
+
+FileBuffer::FileBuffer(char* data, size_t size, std::function<void()> release) : data(data), size(size), release(release)
+{
+    //ctor
+}
+
+FileBuffer::~FileBuffer()
+{
+    if (release)
+        release();
+}
+
+/**
+\brief Create a heap buffer.
+
+\param  size - number of bytes.
+\param  alignment - alignment of first byte, a power of two multiple of pointer size.
+\return new buffer, exits if out of memory.
+*/
+
+std::shared_ptr<FileBuffer> FileBuffer::allocate(size_t size, size_t alignment)
+{
+    void* data = NULL;
+    if (posix_memalign(&data, alignment, size > 0 ? size : 1) != 0)
+    {
+        printf("Unable to allocate %zu bytes.\n", size);
+        exit(1);
+    }
+    return std::make_shared<FileBuffer>((char*)data, size, [data]() { free(data); });
+}
+
+char* FileBuffer::getData()
+{
+    return data;
+}
+
+const char* FileBuffer::getData() const
+{
+    return data;
+}
+
+size_t FileBuffer::getSize() const
+{
+    return size;
+}
+
+/**
+\brief Shrink buffer to the number of bytes actually read, e.g. when reads are rounded up to
+block size.
+
+\param  nsize - new size, at most the current one.
+*/
+
+void FileBuffer::setSize(size_t nsize)
+{
+    if (nsize < size)
+        size = nsize;
+}
+
+bool FileBuffer::isEmpty() const
+{
+    return size == 0;
+}
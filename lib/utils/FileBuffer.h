@@ -0,0 +1,39 @@
+#ifndef FILEBUFFER_H
+#define FILEBUFFER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory>
+#include <functional>
+
+/**
+\class FileBuffer
+
+\brief Content of a file in memory. Depending on the I/O backend the bytes live on the heap
+or in a mapping of the file, the release function given on construction frees them.
+
+*/
+
+class FileBuffer
+{
+    public:
+        FileBuffer(char* data, size_t size, std::function<void()> release);
+        FileBuffer(const FileBuffer &obj) = delete;
+        FileBuffer& operator=(const FileBuffer &obj) = delete;
+        ~FileBuffer();
+
+        static std::shared_ptr<FileBuffer> allocate(size_t size, size_t alignment = 64);
+
+        char* getData();
+        const char* getData() const;
+        size_t getSize() const;
+        void setSize(size_t size);
+        bool isEmpty() const;
+    protected:
+    private:
+        char* data;
+        size_t size;
+        std::function<void()> release;
+};
+
+#endif // FILEBUFFER_H
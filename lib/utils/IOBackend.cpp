@@ -0,0 +1,256 @@
+#include "IOBackend.h"
+#include "PreadBackend.h"
+#include "MmapBackend.h"
+#include "UringBackend.h"
+#include "DirectBackend.h"
+
+IOBackend::IOBackend()
+{
+    //ctor
+}
+
+IOBackend::~IOBackend()
+{
+    //dtor
+}
+
+/**
+\brief Create backend by name.
+
+\param  name - "pread", "mmap", "uring" or "direct".
+\return new backend, pread if name is unknown.
+*/
+
+IOBackend* IOBackend::create(std::string name)
+{
+    if (name == "mmap")
+        return new MmapBackend();
+    if (name == "uring")
+        return new UringBackend();
+    if (name == "direct")
+        return new DirectBackend();
+
+    if (name != "pread")
+        printf("Unknown I/O backend %s, using pread.\n", name.c_str());
+    return new PreadBackend();
+}
+
+/**
+\brief Read a whole file.
+
+\param  filename - path of the file.
+\return content of the file, exits if file can not be read.
+*/
+
+IOBackend::Buffer IOBackend::read(const std::string& filename)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::shared_ptr<FileBuffer> buffer = readFile(filename);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    recordRead(buffer->getSize(), 1, elapsed.count());
+    return buffer;
+}
+
+/**
+\brief Read several whole files, backends able to batch requests submit them together.
+
+\param  filenames - paths of the files.
+\return content of each file, in the same order.
+*/
+
+std::vector<IOBackend::Buffer> IOBackend::readBatch(const std::vector<std::string>& filenames)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<std::shared_ptr<FileBuffer> > buffers = readFiles(filenames);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    size_t bytes = 0;
+    for (int i = 0; i < buffers.size(); i++)
+        bytes += buffers[i]->getSize();
+    recordRead(bytes, buffers.size(), elapsed.count());
+
+    return std::vector<Buffer>(buffers.begin(), buffers.end());
+}
+
+/**
+\brief Open a packed archive for range reads. The descriptor stays open while the archive is
+in use.
+
+\param  filename - path of the archive.
+\param  size - receives size of the archive.
+\return file descriptor, exits if archive can not be opened.
+*/
+
+int IOBackend::openArchive(const std::string& filename, size_t& size)
+{
+    int fd = openFile(filename, 0, size);
+    if (fd < 0)
+        exitMissing(filename);
+    return fd;
+}
+
+/**
+\brief Read several ranges of an open archive.
+
+\param  fd - descriptor from openArchive.
+\param  ranges - byte ranges to read.
+\return content of each range, in the same order.
+*/
+
+std::vector<IOBackend::Buffer> IOBackend::readRanges(int fd, const std::vector<Range>& ranges)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<std::shared_ptr<FileBuffer> > buffers = readFileRanges(fd, ranges);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    size_t bytes = 0;
+    for (int i = 0; i < buffers.size(); i++)
+        bytes += buffers[i]->getSize();
+    recordRead(bytes, buffers.size(), elapsed.count());
+
+    return std::vector<Buffer>(buffers.begin(), buffers.end());
+}
+
+/**
+\brief Default range read, pread of one range after another.
+*/
+
+std::vector<std::shared_ptr<FileBuffer> > IOBackend::readFileRanges(int fd, const std::vector<Range>& ranges)
+{
+    std::vector<std::shared_ptr<FileBuffer> > buffers;
+    for (int i = 0; i < ranges.size(); i++)
+    {
+        std::shared_ptr<FileBuffer> buffer = FileBuffer::allocate(ranges[i].size);
+        readRange(fd, buffer.get(), ranges[i].offset, ranges[i].size);
+        buffers.push_back(buffer);
+    }
+    return buffers;
+}
+
+/**
+\brief Default batch read, one file after another.
+*/
+
+std::vector<std::shared_ptr<FileBuffer> > IOBackend::readFiles(const std::vector<std::string>& filenames)
+{
+    std::vector<std::shared_ptr<FileBuffer> > buffers;
+    for (int i = 0; i < filenames.size(); i++)
+        buffers.push_back(readFile(filenames[i]));
+    return buffers;
+}
+
+/**
+\brief Print throughput of reads so far.
+*/
+
+void IOBackend::printStats()
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    double mb = numBytes / (1024.0 * 1024.0);
+    printf("I/O backend %s: %lu files, %.1f MB, %.1f MB/s per reader, %.2f ms per file\n", getName(),
+           numFiles, mb, busySeconds > 0 ? mb / busySeconds : 0.0,
+           numFiles > 0 ? busySeconds * 1000 / numFiles : 0.0);
+}
+
+/**
+\brief Open a file and get its size.
+
+\param  filename - path of the file.
+\param  flags - flags for open, O_RDONLY is always added.
+\param  size - receives size of the file.
+\return file descriptor, -1 if open failed with the given flags.
+*/
+
+int IOBackend::openFile(const std::string& filename, int flags, size_t& size)
+{
+    int fd = open(filename.c_str(), O_RDONLY | flags);
+    if (fd < 0)
+        return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    size = st.st_size;
+    return fd;
+}
+
+/**
+\brief Report a file that can not be opened and terminate, sensor files are required.
+
+\param  filename - path of the file.
+*/
+
+void IOBackend::exitMissing(const std::string& filename)
+{
+    printf(" Error, Couldn't find file: %s\n", filename.c_str());
+    exit(1);
+}
+
+/**
+\brief Read a range of an archive into the start of buffer with pread. Archives are written
+whole, a short read means the archive is truncated.
+
+\param  fd - open archive.
+\param  buffer - buffer to read into.
+\param  offset - first byte to read.
+\param  length - number of bytes to read.
+*/
+
+void IOBackend::readRange(int fd, FileBuffer* buffer, uint64_t offset, size_t length)
+{
+    size_t done = 0;
+    while (done < length)
+    {
+        ssize_t n = pread(fd, buffer->getData() + done, length - done, offset + done);
+        if (n <= 0)
+        {
+            printf(" Error, Couldn't read archive at offset %llu, file is truncated or unreadable.\n", (unsigned long long)(offset + done));
+            exit(1);
+        }
+        done += n;
+    }
+}
+
+/**
+\brief Read a range of a file into buffer with pread, retrying short reads.
+
+Buffer is shrunk if the file ends early.
+
+\param  fd - open file.
+\param  filename - path of the file, for error messages.
+\param  buffer - buffer to read into.
+\param  offset - first byte to read, also offset into buffer.
+\param  length - number of bytes to read.
+*/
+
+void IOBackend::readFully(int fd, const std::string& filename, FileBuffer* buffer, size_t offset, size_t length)
+{
+    size_t end = offset + length;
+    while (offset < end)
+    {
+        ssize_t n = pread(fd, buffer->getData() + offset, end - offset, offset);
+        if (n < 0)
+        {
+            printf(" Error, Couldn't read file: %s\n", filename.c_str());
+            exit(1);
+        }
+        if (n == 0)
+        {
+            buffer->setSize(offset);
+            return;
+        }
+        offset += n;
+    }
+}
+
+void IOBackend::recordRead(size_t bytes, int files, double seconds)
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    numFiles += files;
+    numBytes += bytes;
+    busySeconds += seconds;
+}
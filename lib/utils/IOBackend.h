@@ -0,0 +1,74 @@
+#ifndef IOBACKEND_H
+#define IOBACKEND_H
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <errno.h>
+
+#include "FileBuffer.h"
+
+/**
+\class IOBackend
+
+\brief Reads whole sensor files, or ranges of a packed drive archive, into memory. Subclasses
+implement one way of reading, the base class keeps throughput statistics so backends can be
+compared on a given storage.
+Create one with IOBackend::create using the `io` value from conf.txt.
+
+*/
+
+class IOBackend
+{
+    public:
+        typedef std::shared_ptr<const FileBuffer> Buffer;
+
+        /**
+        \brief Byte range of a file.
+        */
+        struct Range
+        {
+            uint64_t offset;
+            size_t size;
+        };
+
+        virtual ~IOBackend();
+
+        static IOBackend* create(std::string name);
+
+        Buffer read(const std::string& filename);
+        std::vector<Buffer> readBatch(const std::vector<std::string>& filenames);
+
+        virtual int openArchive(const std::string& filename, size_t& size);
+        std::vector<Buffer> readRanges(int fd, const std::vector<Range>& ranges);
+
+        virtual const char* getName() const = 0;
+        void printStats();
+    protected:
+        IOBackend();
+
+        virtual std::shared_ptr<FileBuffer> readFile(const std::string& filename) = 0;
+        virtual std::vector<std::shared_ptr<FileBuffer> > readFiles(const std::vector<std::string>& filenames);
+        virtual std::vector<std::shared_ptr<FileBuffer> > readFileRanges(int fd, const std::vector<Range>& ranges);
+
+        static int openFile(const std::string& filename, int flags, size_t& size);
+        static void exitMissing(const std::string& filename);
+        static void readFully(int fd, const std::string& filename, FileBuffer* buffer, size_t offset, size_t length);
+        static void readRange(int fd, FileBuffer* buffer, uint64_t offset, size_t length);
+    private:
+        void recordRead(size_t bytes, int files, double seconds);
+
+        std::mutex statsMutex;
+        unsigned long numFiles = 0;
+        unsigned long numBytes = 0;
+        double busySeconds = 0;     ///< Sum of time spent in reads, over all threads.
+};
+
+#endif // IOBACKEND_H
@@ -0,0 +1 @@
+#include "LRUCache.h"
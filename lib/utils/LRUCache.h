@@ -0,0 +1,116 @@
+#ifndef LRU_CACHE
+#define LRU_CACHE
+
+#include <list>
+#include <mutex>
+#include <cstddef>
+#include <unordered_map>
+
+// A threadsafe least-recently-used cache bounded by a byte budget instead of an item count.
+// Each item is inserted with its size, least recently used items are evicted until the
+// total fits the budget again.
+template <typename Key, typename Value>
+class LRUCache
+{
+    public:
+        LRUCache(size_t budget) : budget_(budget), size_(0), hits_(0), misses_(0) {}
+        LRUCache(const LRUCache<Key, Value> &obj) = delete;
+        LRUCache<Key, Value>& operator=(const LRUCache<Key, Value> &obj) = delete;
+
+        bool get(const Key& key, Value& value)
+        {
+            std::lock_guard<std::mutex> mlock(mutex_);
+            auto it = index_.find(key);
+            if (it == index_.end())
+            {
+                misses_++;
+                return false;
+            }
+
+            // Move to front as most recently used.
+            entries_.splice(entries_.begin(), entries_, it->second);
+            value = it->second->value;
+            hits_++;
+            return true;
+        }
+
+        bool contains(const Key& key)
+        {
+            std::lock_guard<std::mutex> mlock(mutex_);
+            return index_.find(key) != index_.end();
+        }
+
+        void put(const Key& key, const Value& value, size_t bytes)
+        {
+            std::lock_guard<std::mutex> mlock(mutex_);
+            eraseLocked(key);
+
+            // Never let a single item flush the whole cache.
+            if (bytes > budget_)
+                return;
+
+            entries_.push_front(Entry{key, value, bytes});
+            index_[key] = entries_.begin();
+            size_ += bytes;
+
+            while (size_ > budget_)
+                eraseLocked(entries_.back().key);
+        }
+
+        void erase(const Key& key)
+        {
+            std::lock_guard<std::mutex> mlock(mutex_);
+            eraseLocked(key);
+        }
+
+        size_t size()
+        {
+            std::lock_guard<std::mutex> mlock(mutex_);
+            return size_;
+        }
+
+        size_t budget() const
+        {
+            return budget_;
+        }
+
+        size_t hits()
+        {
+            std::lock_guard<std::mutex> mlock(mutex_);
+            return hits_;
+        }
+
+        size_t misses()
+        {
+            std::lock_guard<std::mutex> mlock(mutex_);
+            return misses_;
+        }
+
+    private:
+        struct Entry
+        {
+            Key key;
+            Value value;
+            size_t bytes;
+        };
+
+        void eraseLocked(const Key& key)
+        {
+            auto it = index_.find(key);
+            if (it == index_.end())
+                return;
+
+            size_ -= it->second->bytes;
+            entries_.erase(it->second);
+            index_.erase(it);
+        }
+
+        const size_t budget_;
+        size_t size_;
+        size_t hits_;
+        size_t misses_;
+        std::list<Entry> entries_;
+        std::unordered_map<Key, typename std::list<Entry>::iterator> index_;
+        mutable std::mutex mutex_;
+};
+#endif
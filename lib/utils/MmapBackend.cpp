@@ -0,0 +1,88 @@
+#include "MmapBackend.h"
+
+MmapBackend::MmapBackend()
+{
+    //ctor
+}
+
+MmapBackend::~MmapBackend()
+{
+    //dtor
+}
+
+const char* MmapBackend::getName() const
+{
+    return "mmap";
+}
+
+/**
+\brief Map a whole file. Pages are populated up front, so the read cost shows up here and in
+the throughput report rather than as page faults in the decoder.
+
+\param  filename - path of the file.
+\return mapping of the file, unmapped when the buffer is released.
+*/
+
+std::shared_ptr<FileBuffer> MmapBackend::readFile(const std::string& filename)
+{
+    size_t size;
+    int fd = openFile(filename, 0, size);
+    if (fd < 0)
+        exitMissing(filename);
+
+    // Empty files can not be mapped.
+    if (size == 0)
+    {
+        close(fd);
+        return FileBuffer::allocate(0);
+    }
+
+    void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        printf(" Error, Couldn't map file: %s\n", filename.c_str());
+        exit(1);
+    }
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    return std::make_shared<FileBuffer>((char*)data, size, [data, size]() { munmap(data, size); });
+}
+
+/**
+\brief Map ranges of an archive. Mappings start at page boundaries, the buffer points at the
+first byte of the range inside its mapping.
+
+\param  fd - open archive.
+\param  ranges - byte ranges to map.
+\return mapping of each range, unmapped when the buffer is released.
+*/
+
+std::vector<std::shared_ptr<FileBuffer> > MmapBackend::readFileRanges(int fd, const std::vector<Range>& ranges)
+{
+    static const uint64_t pageSize = sysconf(_SC_PAGESIZE);
+
+    std::vector<std::shared_ptr<FileBuffer> > buffers;
+    for (int i = 0; i < ranges.size(); i++)
+    {
+        if (ranges[i].size == 0)
+        {
+            buffers.push_back(FileBuffer::allocate(0));
+            continue;
+        }
+
+        uint64_t start = ranges[i].offset / pageSize * pageSize;
+        size_t length = ranges[i].offset + ranges[i].size - start;
+        void* data = mmap(NULL, length, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, start);
+        if (data == MAP_FAILED)
+        {
+            printf(" Error, Couldn't map archive at offset %llu.\n", (unsigned long long)ranges[i].offset);
+            exit(1);
+        }
+        madvise(data, length, MADV_SEQUENTIAL);
+
+        char* first = (char*)data + (ranges[i].offset - start);
+        buffers.push_back(std::make_shared<FileBuffer>(first, ranges[i].size, [data, length]() { munmap(data, length); }));
+    }
+    return buffers;
+}
@@ -0,0 +1,29 @@
+#ifndef MMAPBACKEND_H
+#define MMAPBACKEND_H
+
+#include <sys/mman.h>
+
+#include "IOBackend.h"
+
+/**
+\class MmapBackend
+
+\brief Maps files instead of copying them, decoders read straight from the page cache. Works
+best on local storage where the kernel can read ahead large sequential ranges.
+
+*/
+
+class MmapBackend : public IOBackend
+{
+    public:
+        MmapBackend();
+        virtual ~MmapBackend();
+
+        virtual const char* getName() const;
+    protected:
+        virtual std::shared_ptr<FileBuffer> readFile(const std::string& filename);
+        virtual std::vector<std::shared_ptr<FileBuffer> > readFileRanges(int fd, const std::vector<Range>& ranges);
+    private:
+};
+
+#endif // MMAPBACKEND_H
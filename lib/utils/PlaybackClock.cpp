@@ -0,0 +1,110 @@
+#include "PlaybackClock.h"
+
+PlaybackClock::PlaybackClock()
+{
+    //ctor
+}
+
+PlaybackClock::~PlaybackClock()
+{
+    //dtor
+}
+
+/**
+\brief Set time span of the recording.
+
+\param nstart - time of first sample.
+\param nend - time of last sample.
+*/
+
+void PlaybackClock::setRange(double nstart, double nend)
+{
+    start = nstart;
+    end = nend;
+    setTime(start);
+}
+
+/**
+\brief Move drive time forward, or backward if reversed.
+
+\param wallSeconds - elapsed real time.
+*/
+
+void PlaybackClock::advance(double wallSeconds)
+{
+    double span = end - start;
+    time += wallSeconds * speed * getDirection();
+
+    if (span <= 0)
+    {
+        time = start;
+        return;
+    }
+
+    // Loop over the recording.
+    while (time > end)
+        time -= span;
+    while (time < start)
+        time += span;
+}
+
+/**
+\brief Jump to a drive time.
+
+\param t - time in seconds, clamped to the recording.
+*/
+
+void PlaybackClock::setTime(double t)
+{
+    if (t < start)
+        t = start;
+    if (t > end)
+        t = end;
+    time = t;
+}
+
+double PlaybackClock::getTime() const
+{
+    return time;
+}
+
+/**
+\brief Set playback speed.
+
+\param nspeed - speed multiplier, clamped between MIN_SPEED and MAX_SPEED.
+*/
+
+void PlaybackClock::setSpeed(float nspeed)
+{
+    if (nspeed < MIN_SPEED)
+        nspeed = MIN_SPEED;
+    if (nspeed > MAX_SPEED)
+        nspeed = MAX_SPEED;
+    speed = nspeed;
+}
+
+float PlaybackClock::getSpeed() const
+{
+    return speed;
+}
+
+void PlaybackClock::setReverse(bool val)
+{
+    reverse = val;
+}
+
+bool PlaybackClock::isReverse() const
+{
+    return reverse;
+}
+
+/**
+\brief Get direction of playback.
+
+\return 1 when playing forward, -1 when playing backward.
+*/
+
+int PlaybackClock::getDirection() const
+{
+    return reverse ? -1 : 1;
+}
@@ -0,0 +1,42 @@
+#ifndef PLAYBACKCLOCK_H
+#define PLAYBACKCLOCK_H
+
+/**
+\class PlaybackClock
+
+\brief Drive time used to pick which frame to show. It advances with wall time scaled by
+playback speed, can run backwards, and loops over the recording.
+
+*/
+
+class PlaybackClock
+{
+    public:
+        PlaybackClock();
+        ~PlaybackClock();
+
+        static constexpr float MIN_SPEED = 0.1;     ///< Slowest playback speed.
+        static constexpr float MAX_SPEED = 16;      ///< Fastest playback speed.
+
+        void setRange(double start, double end);
+        void advance(double wallSeconds);
+
+        void setTime(double t);
+        double getTime() const;
+
+        void setSpeed(float nspeed);
+        float getSpeed() const;
+
+        void setReverse(bool val);
+        bool isReverse() const;
+        int getDirection() const;
+    protected:
+    private:
+        double start = 0;       ///< First sample time of the drive.
+        double end = 0;         ///< Last sample time of the drive.
+        double time = 0;        ///< Current drive time.
+        float speed = 1;        ///< Drive seconds per wall second.
+        bool reverse = false;   ///< Flag for playing backwards.
+};
+
+#endif // PLAYBACKCLOCK_H
@@ -0,0 +1,314 @@
+#include "PngDecoder.h"
+
+namespace
+{
+    const uint8_t SIGNATURE[8] = {137, 'P', 'N', 'G', '\r', '\n', 26, '\n'};
+    const size_t IHDR_END = 8 + 8 + 13 + 4;      ///< Signature, chunk header, header data and CRC.
+
+#if defined(__SSE2__)
+    inline __m128i load3(const uint8_t* p)
+    {
+        uint32_t v = p[0] | p[1] << 8 | p[2] << 16;
+        return _mm_cvtsi32_si128(v);
+    }
+
+    inline void store3(uint8_t* p, __m128i v)
+    {
+        uint32_t x = _mm_cvtsi128_si32(v);
+        p[0] = x;
+        p[1] = x >> 8;
+        p[2] = x >> 16;
+    }
+
+    inline __m128i load4(const uint8_t* p)
+    {
+        uint32_t v;
+        memcpy(&v, p, 4);
+        return _mm_cvtsi32_si128(v);
+    }
+
+    inline void store4(uint8_t* p, __m128i v)
+    {
+        uint32_t x = _mm_cvtsi128_si32(v);
+        memcpy(p, &x, 4);
+    }
+
+    inline __m128i loadPixel(const uint8_t* p, int bpp)
+    {
+        return bpp == 3 ? load3(p) : load4(p);
+    }
+
+    inline void storePixel(uint8_t* p, __m128i v, int bpp)
+    {
+        if (bpp == 3)
+            store3(p, v);
+        else
+            store4(p, v);
+    }
+#endif
+
+    inline uint8_t paeth(int a, int b, int c)
+    {
+        int pa = abs(b - c);
+        int pb = abs(a - c);
+        int pc = abs(a + b - 2 * c);
+        if (pa <= pb && pa <= pc)
+            return a;
+        return pb <= pc ? b : c;
+    }
+}
+
+/**
+\brief Read image size and layout from the header.
+
+\param bytes - content of a PNG file.
+\param size - number of bytes.
+\param info - receives size and channel count.
+\return false if bytes are not a PNG this decoder handles.
+*/
+
+bool PngDecoder::readInfo(const char* bytes, size_t size, Info& info)
+{
+    if (size < IHDR_END || memcmp(bytes, SIGNATURE, sizeof(SIGNATURE)) != 0 || readU32(bytes + 8) != 13 ||
+        memcmp(bytes + 12, "IHDR", 4) != 0)
+        return false;
+
+    const uint8_t* header = (const uint8_t*)bytes + 16;
+    uint32_t width = readU32(bytes + 16);
+    uint32_t height = readU32(bytes + 20);
+    int bitDepth = header[8];
+    int colorType = header[9];
+    int interlace = header[12];
+    if (width == 0 || height == 0 || width > 1 << 15 || height > 1 << 15 || bitDepth != 8 || interlace != 0)
+        return false;
+
+    switch (colorType)
+    {
+        case 0: info.channels = 1; break;
+        case 2: info.channels = 3; break;
+        case 6: info.channels = 4; break;
+        default: return false;
+    }
+    info.width = width;
+    info.height = height;
+    return true;
+}
+
+/**
+\brief Decode pixels.
+
+\param bytes - content of a PNG file.
+\param size - number of bytes.
+\param info - result of readInfo on the same bytes.
+\param pixels - receives width * height * channels bytes, rows top to bottom.
+\return false if the file is corrupt.
+*/
+
+bool PngDecoder::decode(const char* bytes, size_t size, const Info& info, uint8_t* pixels)
+{
+    size_t stride = (size_t)info.width * info.channels;
+    size_t filteredSize = (stride + 1) * info.height;
+
+    // Filtered rows are kept per thread, loader threads decode frame after frame of one size.
+    thread_local std::vector<uint8_t> filtered;
+    thread_local std::vector<uint8_t> zeros;
+    if (filtered.size() < filteredSize)
+        filtered.resize(filteredSize);
+    if (zeros.size() < stride)
+        zeros.resize(stride, 0);
+
+    if (!inflateData(bytes, size, filtered.data(), filteredSize))
+        return false;
+
+    const uint8_t* prev = zeros.data();
+    for (int y = 0; y < info.height; y++)
+    {
+        const uint8_t* row = filtered.data() + y * (stride + 1);
+        uint8_t* out = pixels + y * stride;
+        if (!unfilter(row[0], row + 1, prev, out, stride, info.channels))
+            return false;
+        prev = out;
+    }
+    return true;
+}
+
+uint32_t PngDecoder::readU32(const char* bytes)
+{
+    const uint8_t* p = (const uint8_t*)bytes;
+    return (uint32_t)p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3];
+}
+
+/**
+\brief Inflate the concatenated IDAT chunks.
+
+\param bytes - content of a PNG file.
+\param size - number of bytes.
+\param out - receives filtered rows.
+\param outSize - exact size of filtered rows.
+\return false if data is missing or corrupt.
+*/
+
+bool PngDecoder::inflateData(const char* bytes, size_t size, uint8_t* out, size_t outSize)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit(&stream) != Z_OK)
+        return false;
+    stream.next_out = out;
+    stream.avail_out = outSize;
+
+    int status = Z_OK;
+    size_t pos = IHDR_END;
+    while (pos + 12 <= size && status == Z_OK)
+    {
+        uint32_t length = readU32(bytes + pos);
+        const char* type = bytes + pos + 4;
+        if (length > size - pos - 12)
+            break;
+
+        if (memcmp(type, "IDAT", 4) == 0)
+        {
+            stream.next_in = (Bytef*)bytes + pos + 8;
+            stream.avail_in = length;
+            while (stream.avail_in > 0 && status == Z_OK)
+                status = inflate(&stream, Z_NO_FLUSH);
+        } else if (memcmp(type, "IEND", 4) == 0)
+        {
+            break;
+        }
+        pos += length + 12;
+    }
+
+    bool isComplete = (status == Z_STREAM_END || status == Z_OK) && stream.avail_out == 0;
+    inflateEnd(&stream);
+    return isComplete;
+}
+
+/**
+\brief Undo the filter of one row.
+
+\param filter - filter type of the row.
+\param in - filtered row.
+\param prev - unfiltered row above, zeros for the first row.
+\param out - receives unfiltered row.
+\param stride - bytes per row.
+\param bpp - bytes per pixel.
+\return false for an unknown filter type.
+*/
+
+bool PngDecoder::unfilter(int filter, const uint8_t* in, const uint8_t* prev, uint8_t* out, size_t stride, int bpp)
+{
+    switch (filter)
+    {
+        case NONE: memcpy(out, in, stride); return true;
+        case SUB: unfilterSub(in, out, stride, bpp); return true;
+        case UP: unfilterUp(in, prev, out, stride); return true;
+        case AVERAGE: unfilterAverage(in, prev, out, stride, bpp); return true;
+        case PAETH: unfilterPaeth(in, prev, out, stride, bpp); return true;
+        default: return false;
+    }
+}
+
+void PngDecoder::unfilterSub(const uint8_t* in, uint8_t* out, size_t stride, int bpp)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    if (bpp == 3 || bpp == 4)
+    {
+        // Each pixel depends on the one before, all its channels are added at once.
+        __m128i a = _mm_setzero_si128();
+        for (; i + bpp <= stride; i += bpp)
+        {
+            a = _mm_add_epi8(a, loadPixel(in + i, bpp));
+            storePixel(out + i, a, bpp);
+        }
+        return;
+    }
+#endif
+    for (; i < bpp && i < stride; i++)
+        out[i] = in[i];
+    for (; i < stride; i++)
+        out[i] = in[i] + out[i - bpp];
+}
+
+void PngDecoder::unfilterUp(const uint8_t* in, const uint8_t* prev, uint8_t* out, size_t stride)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 16 <= stride; i += 16)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(in + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(prev + i));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_add_epi8(x, b));
+    }
+#endif
+    for (; i < stride; i++)
+        out[i] = in[i] + prev[i];
+}
+
+void PngDecoder::unfilterAverage(const uint8_t* in, const uint8_t* prev, uint8_t* out, size_t stride, int bpp)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    if (bpp == 3 || bpp == 4)
+    {
+        // _mm_avg_epu8 rounds up, PNG rounds down: subtract the carry of odd sums.
+        __m128i one = _mm_set1_epi8(1);
+        __m128i a = _mm_setzero_si128();
+        for (; i + bpp <= stride; i += bpp)
+        {
+            __m128i b = loadPixel(prev + i, bpp);
+            __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+            a = _mm_add_epi8(loadPixel(in + i, bpp), avg);
+            storePixel(out + i, a, bpp);
+        }
+        return;
+    }
+#endif
+    for (; i < bpp && i < stride; i++)
+        out[i] = in[i] + (prev[i] >> 1);
+    for (; i < stride; i++)
+        out[i] = in[i] + ((out[i - bpp] + prev[i]) >> 1);
+}
+
+void PngDecoder::unfilterPaeth(const uint8_t* in, const uint8_t* prev, uint8_t* out, size_t stride, int bpp)
+{
+    size_t i = 0;
+#if defined(__SSE2__)
+    if (bpp == 3 || bpp == 4)
+    {
+        // Predictor distances are computed for all channels of a pixel in 16 bit lanes.
+        __m128i zero = _mm_setzero_si128();
+        __m128i a = zero;
+        __m128i c = zero;
+        for (; i + bpp <= stride; i += bpp)
+        {
+            __m128i b = _mm_unpacklo_epi8(loadPixel(prev + i, bpp), zero);
+            __m128i pa = _mm_sub_epi16(b, c);
+            __m128i pb = _mm_sub_epi16(a, c);
+            __m128i pc = _mm_add_epi16(pa, pb);
+            pa = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+            pb = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+            pc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+
+            // Pick c where it is strictly closest, then b over a where b is strictly closer.
+            __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+            __m128i predictor = c;
+            __m128i isB = _mm_cmpeq_epi16(smallest, pb);
+            predictor = _mm_or_si128(_mm_and_si128(isB, b), _mm_andnot_si128(isB, predictor));
+            __m128i isA = _mm_cmpeq_epi16(smallest, pa);
+            predictor = _mm_or_si128(_mm_and_si128(isA, a), _mm_andnot_si128(isA, predictor));
+
+            __m128i x = _mm_add_epi8(loadPixel(in + i, bpp), _mm_packus_epi16(predictor, zero));
+            storePixel(out + i, x, bpp);
+            a = _mm_unpacklo_epi8(x, zero);
+            c = b;
+        }
+        return;
+    }
+#endif
+    for (; i < bpp && i < stride; i++)
+        out[i] = in[i] + prev[i];
+    for (; i < stride; i++)
+        out[i] = in[i] + paeth(out[i - bpp], prev[i], prev[i - bpp]);
+}
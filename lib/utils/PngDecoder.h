@@ -0,0 +1,58 @@
+#ifndef PNGDECODER_H
+#define PNGDECODER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <zlib.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+\class PngDecoder
+
+\brief Decoder for the PNG variant KITTI cameras are stored in: 8 bits per channel,
+grayscale, RGB or RGBA, not interlaced. Pixels are written in their native channel count
+straight into a buffer of the caller, rows are unfiltered with SSE2 where available.
+
+Other PNG variants are rejected by readInfo, callers fall back to a generic decoder for them.
+
+*/
+
+class PngDecoder
+{
+    public:
+        struct Info
+        {
+            int width;
+            int height;
+            int channels;       ///< 1 for grayscale, 3 for RGB, 4 for RGBA.
+        };
+
+        static bool readInfo(const char* bytes, size_t size, Info& info);
+        static bool decode(const char* bytes, size_t size, const Info& info, uint8_t* pixels);
+    protected:
+    private:
+        enum Filter
+        {
+            NONE,
+            SUB,
+            UP,
+            AVERAGE,
+            PAETH
+        };
+
+        static uint32_t readU32(const char* bytes);
+        static bool inflateData(const char* bytes, size_t size, uint8_t* out, size_t outSize);
+        static bool unfilter(int filter, const uint8_t* in, const uint8_t* prev, uint8_t* out, size_t stride, int bpp);
+        static void unfilterSub(const uint8_t* in, uint8_t* out, size_t stride, int bpp);
+        static void unfilterUp(const uint8_t* in, const uint8_t* prev, uint8_t* out, size_t stride);
+        static void unfilterAverage(const uint8_t* in, const uint8_t* prev, uint8_t* out, size_t stride, int bpp);
+        static void unfilterPaeth(const uint8_t* in, const uint8_t* prev, uint8_t* out, size_t stride, int bpp);
+};
+
+#endif // PNGDECODER_H
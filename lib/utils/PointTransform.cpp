@@ -0,0 +1,294 @@
+#include "PointTransform.h"
+
+const float PointTransform::SENSOR_TO_RENDER[12] = {1,  0,  0, 0,
+                                                    0, -1,  0, 0,
+                                                    0,  0, -1, 0};
+
+/**
+\brief Get the instruction set kernels run with, detected once.
+*/
+
+PointTransform::Path PointTransform::getPath()
+{
+    static const Path path = detectPath();
+    return path;
+}
+
+/**
+\brief Get name of the instruction set kernels run with, for printing.
+*/
+
+const char* PointTransform::getPathName()
+{
+    switch (getPath())
+    {
+        case AVX2: return "AVX2";
+        case SSE2: return "SSE2";
+        case NEON: return "NEON";
+        default: return "scalar";
+    }
+}
+
+PointTransform::Path PointTransform::detectPath()
+{
+#if defined(POINTTRANSFORM_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return AVX2;
+#endif
+#if defined(__SSE2__)
+    return SSE2;
+#elif defined(__ARM_NEON)
+    return NEON;
+#else
+    return SCALAR;
+#endif
+}
+
+/**
+\brief Split interleaved points into one column per channel.
+
+\param points - four floats x, y, z, reflectance per point, as stored in KITTI files. Need not
+be aligned.
+\param numPoints - number of points.
+\param x, y, z, reflectance - receive numPoints floats each.
+*/
+
+void PointTransform::split(const float* points, size_t numPoints, float* x, float* y, float* z, float* reflectance)
+{
+    switch (getPath())
+    {
+#if defined(POINTTRANSFORM_X86)
+        case AVX2: splitAVX2(points, numPoints, x, y, z, reflectance); return;
+#endif
+#if defined(__SSE2__)
+        case SSE2: splitSSE2(points, numPoints, x, y, z, reflectance); return;
+#endif
+#if defined(__ARM_NEON)
+        case NEON: splitNEON(points, numPoints, x, y, z, reflectance); return;
+#endif
+        default: splitScalar(points, numPoints, x, y, z, reflectance); return;
+    }
+}
+
+/**
+\brief Transform point columns by an affine matrix into vertices ready for upload.
+
+\param x, y, z - columns of numPoints floats.
+\param numPoints - number of points.
+\param matrix - 3x4 row major affine transform, e.g. SENSOR_TO_RENDER.
+\param vertices - receives four floats x, y, z, 1 per point.
+*/
+
+void PointTransform::transform(const float* x, const float* y, const float* z, size_t numPoints,
+                               const float matrix[12], float* vertices)
+{
+    switch (getPath())
+    {
+#if defined(POINTTRANSFORM_X86)
+        case AVX2: transformAVX2(x, y, z, numPoints, matrix, vertices); return;
+#endif
+#if defined(__SSE2__)
+        case SSE2: transformSSE2(x, y, z, numPoints, matrix, vertices); return;
+#endif
+#if defined(__ARM_NEON)
+        case NEON: transformNEON(x, y, z, numPoints, matrix, vertices); return;
+#endif
+        default: transformScalar(x, y, z, numPoints, matrix, vertices); return;
+    }
+}
+
+void PointTransform::splitScalar(const float* points, size_t numPoints, float* x, float* y, float* z, float* reflectance)
+{
+    for (size_t i = 0; i < numPoints; i++)
+    {
+        x[i] = points[i * 4];
+        y[i] = points[i * 4 + 1];
+        z[i] = points[i * 4 + 2];
+        reflectance[i] = points[i * 4 + 3];
+    }
+}
+
+void PointTransform::transformScalar(const float* x, const float* y, const float* z, size_t numPoints,
+                                     const float matrix[12], float* vertices)
+{
+    for (size_t i = 0; i < numPoints; i++)
+    {
+        for (int row = 0; row < 3; row++)
+        {
+            const float* m = matrix + row * 4;
+            vertices[i * 4 + row] = m[0] * x[i] + m[1] * y[i] + m[2] * z[i] + m[3];
+        }
+        vertices[i * 4 + 3] = 1;
+    }
+}
+
+#if defined(POINTTRANSFORM_X86)
+__attribute__((target("avx2,fma")))
+void PointTransform::splitAVX2(const float* points, size_t numPoints, float* x, float* y, float* z, float* reflectance)
+{
+    size_t i = 0;
+    for (; i + 8 <= numPoints; i += 8)
+    {
+        const float* p = points + i * 4;
+        __m256 m0 = _mm256_loadu_ps(p);
+        __m256 m1 = _mm256_loadu_ps(p + 8);
+        __m256 m2 = _mm256_loadu_ps(p + 16);
+        __m256 m3 = _mm256_loadu_ps(p + 24);
+
+        // Pair points i and i+4 in lanes, then transpose each 4x4 lane.
+        __m256 t0 = _mm256_permute2f128_ps(m0, m2, 0x20);
+        __m256 t1 = _mm256_permute2f128_ps(m0, m2, 0x31);
+        __m256 t2 = _mm256_permute2f128_ps(m1, m3, 0x20);
+        __m256 t3 = _mm256_permute2f128_ps(m1, m3, 0x31);
+
+        __m256 u0 = _mm256_unpacklo_ps(t0, t1);
+        __m256 u1 = _mm256_unpackhi_ps(t0, t1);
+        __m256 u2 = _mm256_unpacklo_ps(t2, t3);
+        __m256 u3 = _mm256_unpackhi_ps(t2, t3);
+
+        _mm256_storeu_ps(x + i, _mm256_shuffle_ps(u0, u2, _MM_SHUFFLE(1, 0, 1, 0)));
+        _mm256_storeu_ps(y + i, _mm256_shuffle_ps(u0, u2, _MM_SHUFFLE(3, 2, 3, 2)));
+        _mm256_storeu_ps(z + i, _mm256_shuffle_ps(u1, u3, _MM_SHUFFLE(1, 0, 1, 0)));
+        _mm256_storeu_ps(reflectance + i, _mm256_shuffle_ps(u1, u3, _MM_SHUFFLE(3, 2, 3, 2)));
+    }
+    splitScalar(points + i * 4, numPoints - i, x + i, y + i, z + i, reflectance + i);
+}
+
+__attribute__((target("avx2,fma")))
+void PointTransform::transformAVX2(const float* x, const float* y, const float* z, size_t numPoints,
+                                   const float matrix[12], float* vertices)
+{
+    __m256 m[12];
+    for (int k = 0; k < 12; k++)
+        m[k] = _mm256_set1_ps(matrix[k]);
+    __m256 one = _mm256_set1_ps(1);
+
+    size_t i = 0;
+    for (; i + 8 <= numPoints; i += 8)
+    {
+        __m256 px = _mm256_loadu_ps(x + i);
+        __m256 py = _mm256_loadu_ps(y + i);
+        __m256 pz = _mm256_loadu_ps(z + i);
+
+        __m256 r[3];
+        for (int row = 0; row < 3; row++)
+        {
+            const __m256* mr = m + row * 4;
+            r[row] = _mm256_fmadd_ps(mr[0], px, _mm256_fmadd_ps(mr[1], py, _mm256_fmadd_ps(mr[2], pz, mr[3])));
+        }
+
+        // Transpose rows x, y, z, 1 of eight points back into one vertex after another.
+        __m256 u0 = _mm256_unpacklo_ps(r[0], r[1]);
+        __m256 u1 = _mm256_unpackhi_ps(r[0], r[1]);
+        __m256 u2 = _mm256_unpacklo_ps(r[2], one);
+        __m256 u3 = _mm256_unpackhi_ps(r[2], one);
+
+        __m256 v0 = _mm256_shuffle_ps(u0, u2, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 v1 = _mm256_shuffle_ps(u0, u2, _MM_SHUFFLE(3, 2, 3, 2));
+        __m256 v2 = _mm256_shuffle_ps(u1, u3, _MM_SHUFFLE(1, 0, 1, 0));
+        __m256 v3 = _mm256_shuffle_ps(u1, u3, _MM_SHUFFLE(3, 2, 3, 2));
+
+        float* out = vertices + i * 4;
+        _mm256_storeu_ps(out, _mm256_permute2f128_ps(v0, v1, 0x20));
+        _mm256_storeu_ps(out + 8, _mm256_permute2f128_ps(v2, v3, 0x20));
+        _mm256_storeu_ps(out + 16, _mm256_permute2f128_ps(v0, v1, 0x31));
+        _mm256_storeu_ps(out + 24, _mm256_permute2f128_ps(v2, v3, 0x31));
+    }
+    transformScalar(x + i, y + i, z + i, numPoints - i, matrix, vertices + i * 4);
+}
+#endif
+
+#if defined(__SSE2__)
+void PointTransform::splitSSE2(const float* points, size_t numPoints, float* x, float* y, float* z, float* reflectance)
+{
+    size_t i = 0;
+    for (; i + 4 <= numPoints; i += 4)
+    {
+        const float* p = points + i * 4;
+        __m128 r0 = _mm_loadu_ps(p);
+        __m128 r1 = _mm_loadu_ps(p + 4);
+        __m128 r2 = _mm_loadu_ps(p + 8);
+        __m128 r3 = _mm_loadu_ps(p + 12);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        _mm_storeu_ps(x + i, r0);
+        _mm_storeu_ps(y + i, r1);
+        _mm_storeu_ps(z + i, r2);
+        _mm_storeu_ps(reflectance + i, r3);
+    }
+    splitScalar(points + i * 4, numPoints - i, x + i, y + i, z + i, reflectance + i);
+}
+
+void PointTransform::transformSSE2(const float* x, const float* y, const float* z, size_t numPoints,
+                                   const float matrix[12], float* vertices)
+{
+    __m128 m[12];
+    for (int k = 0; k < 12; k++)
+        m[k] = _mm_set1_ps(matrix[k]);
+
+    size_t i = 0;
+    for (; i + 4 <= numPoints; i += 4)
+    {
+        __m128 px = _mm_loadu_ps(x + i);
+        __m128 py = _mm_loadu_ps(y + i);
+        __m128 pz = _mm_loadu_ps(z + i);
+
+        __m128 r[4];
+        for (int row = 0; row < 3; row++)
+        {
+            const __m128* mr = m + row * 4;
+            r[row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(mr[0], px), _mm_mul_ps(mr[1], py)),
+                                _mm_add_ps(_mm_mul_ps(mr[2], pz), mr[3]));
+        }
+        r[3] = _mm_set1_ps(1);
+        _MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+
+        float* out = vertices + i * 4;
+        for (int k = 0; k < 4; k++)
+            _mm_storeu_ps(out + k * 4, r[k]);
+    }
+    transformScalar(x + i, y + i, z + i, numPoints - i, matrix, vertices + i * 4);
+}
+#endif
+
+#if defined(__ARM_NEON)
+void PointTransform::splitNEON(const float* points, size_t numPoints, float* x, float* y, float* z, float* reflectance)
+{
+    size_t i = 0;
+    for (; i + 4 <= numPoints; i += 4)
+    {
+        float32x4x4_t p = vld4q_f32(points + i * 4);
+        vst1q_f32(x + i, p.val[0]);
+        vst1q_f32(y + i, p.val[1]);
+        vst1q_f32(z + i, p.val[2]);
+        vst1q_f32(reflectance + i, p.val[3]);
+    }
+    splitScalar(points + i * 4, numPoints - i, x + i, y + i, z + i, reflectance + i);
+}
+
+void PointTransform::transformNEON(const float* x, const float* y, const float* z, size_t numPoints,
+                                   const float matrix[12], float* vertices)
+{
+    size_t i = 0;
+    for (; i + 4 <= numPoints; i += 4)
+    {
+        float32x4_t px = vld1q_f32(x + i);
+        float32x4_t py = vld1q_f32(y + i);
+        float32x4_t pz = vld1q_f32(z + i);
+
+        float32x4x4_t v;
+        for (int row = 0; row < 3; row++)
+        {
+            const float* m = matrix + row * 4;
+            float32x4_t r = vdupq_n_f32(m[3]);
+            r = vmlaq_n_f32(r, px, m[0]);
+            r = vmlaq_n_f32(r, py, m[1]);
+            r = vmlaq_n_f32(r, pz, m[2]);
+            v.val[row] = r;
+        }
+        v.val[3] = vdupq_n_f32(1);
+        vst4q_f32(vertices + i * 4, v);
+    }
+    transformScalar(x + i, y + i, z + i, numPoints - i, matrix, vertices + i * 4);
+}
+#endif
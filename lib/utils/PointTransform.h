@@ -0,0 +1,70 @@
+#ifndef POINTTRANSFORM_H
+#define POINTTRANSFORM_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define POINTTRANSFORM_X86
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/**
+\class PointTransform
+
+\brief Kernels converting velodyne points between the interleaved layout of KITTI files, the
+column layout of CloudPoints and the vertex layout uploaded to the GPU.
+
+The widest instruction set of the running CPU is picked on first use: AVX2 with FMA on x86,
+whatever the compiler targets otherwise, NEON on ARM, and plain C++ as fallback. The x86 path
+is compiled for AVX2 on its own, so the program still runs on CPUs without it.
+
+*/
+
+class PointTransform
+{
+    public:
+        enum Path
+        {
+            SCALAR,
+            SSE2,
+            AVX2,
+            NEON
+        };
+
+        static const float SENSOR_TO_RENDER[12];    ///< Flips y and z of velodyne frame into render frame.
+
+        static Path getPath();
+        static const char* getPathName();
+
+        static void split(const float* points, size_t numPoints, float* x, float* y, float* z, float* reflectance);
+        static void transform(const float* x, const float* y, const float* z, size_t numPoints,
+                              const float matrix[12], float* vertices);
+    protected:
+    private:
+        static Path detectPath();
+
+        static void splitScalar(const float* points, size_t numPoints, float* x, float* y, float* z, float* reflectance);
+        static void transformScalar(const float* x, const float* y, const float* z, size_t numPoints,
+                                    const float matrix[12], float* vertices);
+#if defined(POINTTRANSFORM_X86)
+        static void splitAVX2(const float* points, size_t numPoints, float* x, float* y, float* z, float* reflectance);
+        static void transformAVX2(const float* x, const float* y, const float* z, size_t numPoints,
+                                  const float matrix[12], float* vertices);
+#endif
+#if defined(__SSE2__)
+        static void splitSSE2(const float* points, size_t numPoints, float* x, float* y, float* z, float* reflectance);
+        static void transformSSE2(const float* x, const float* y, const float* z, size_t numPoints,
+                                  const float matrix[12], float* vertices);
+#endif
+#if defined(__ARM_NEON)
+        static void splitNEON(const float* points, size_t numPoints, float* x, float* y, float* z, float* reflectance);
+        static void transformNEON(const float* x, const float* y, const float* z, size_t numPoints,
+                                  const float matrix[12], float* vertices);
+#endif
+};
+
+#endif // POINTTRANSFORM_H
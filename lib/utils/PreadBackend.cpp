@@ -0,0 +1,39 @@
+#include "PreadBackend.h"
+
+PreadBackend::PreadBackend()
+{
+    //ctor
+}
+
+PreadBackend::~PreadBackend()
+{
+    //dtor
+}
+
+const char* PreadBackend::getName() const
+{
+    return "pread";
+}
+
+/**
+\brief Read a whole file with pread. Files are read front to back once, so kernel readahead
+is told so.
+
+\param  filename - path of the file.
+\return content of the file.
+*/
+
+std::shared_ptr<FileBuffer> PreadBackend::readFile(const std::string& filename)
+{
+    size_t size;
+    int fd = openFile(filename, 0, size);
+    if (fd < 0)
+        exitMissing(filename);
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    std::shared_ptr<FileBuffer> buffer = FileBuffer::allocate(size);
+    readFully(fd, filename, buffer.get(), 0, size);
+    close(fd);
+    return buffer;
+}
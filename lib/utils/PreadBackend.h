@@ -0,0 +1,25 @@
+#ifndef PREADBACKEND_H
+#define PREADBACKEND_H
+
+#include "IOBackend.h"
+
+/**
+\class PreadBackend
+
+\brief Buffered reads through the page cache into a heap buffer. A safe default on any storage.
+
+*/
+
+class PreadBackend : public IOBackend
+{
+    public:
+        PreadBackend();
+        virtual ~PreadBackend();
+
+        virtual const char* getName() const;
+    protected:
+        virtual std::shared_ptr<FileBuffer> readFile(const std::string& filename);
+    private:
+};
+
+#endif // PREADBACKEND_H
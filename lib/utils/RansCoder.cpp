@@ -0,0 +1,303 @@
+#include "RansCoder.h"
+
+const int RansCoder::PROB_BITS;
+const uint32_t RansCoder::PROB_SCALE;
+const uint32_t RansCoder::RANS_L;
+const int RansCoder::NUM_STATES;
+const int RansCoder::MAX_REFILL;
+const int RansCoder::MAX_STREAMS;
+
+/**
+\brief Scale symbol counts to frequencies summing to PROB_SCALE. Every symbol that occurs
+keeps a frequency of at least 1.
+
+\param counts - occurrences of each byte value.
+\param total - sum of counts, not 0.
+\param freqs - receives frequency of each byte value.
+*/
+
+void RansCoder::normalize(const uint32_t* counts, size_t total, uint32_t* freqs)
+{
+    uint32_t sum = 0;
+    int largest = 0;
+    for (int s = 0; s < 256; s++)
+    {
+        freqs[s] = counts[s] ? std::max<uint64_t>(1, (uint64_t)counts[s] * PROB_SCALE / total) : 0;
+        sum += freqs[s];
+        if (counts[s] > counts[largest])
+            largest = s;
+    }
+
+    // Rounding leaves sum off by a little, settle it on symbols that can afford it.
+    while (sum > PROB_SCALE)
+    {
+        for (int s = 0; s < 256 && sum > PROB_SCALE; s++)
+        {
+            if (freqs[s] > 1 && (s == largest || freqs[s] > freqs[largest] / 2))
+            {
+                freqs[s]--;
+                sum--;
+            }
+        }
+    }
+    freqs[largest] += PROB_SCALE - sum;
+}
+
+/**
+\brief Encode a byte stream.
+
+\param symbols - bytes to encode.
+\param out - coded stream is appended to it.
+*/
+
+void RansCoder::encode(const std::vector<uint8_t>& symbols, std::vector<uint8_t>& out)
+{
+    uint32_t counts[256] = {0};
+    for (size_t i = 0; i < symbols.size(); i++)
+        counts[symbols[i]]++;
+
+    uint32_t freqs[256] = {0};
+    uint32_t starts[256];
+    if (!symbols.empty())
+        normalize(counts, symbols.size(), freqs);
+    for (int s = 0, start = 0; s < 256; start += freqs[s], s++)
+        starts[s] = start;
+
+    uint32_t numSymbols = symbols.size();
+    out.insert(out.end(), (uint8_t*)&numSymbols, (uint8_t*)&numSymbols + 4);
+    for (int s = 0; s < 256; s++)
+    {
+        uint16_t freq = freqs[s];
+        out.insert(out.end(), (uint8_t*)&freq, (uint8_t*)&freq + 2);
+    }
+    if (symbols.empty())
+        return;
+
+    // rANS is last in, first out: encode backwards into a reversed buffer.
+    std::vector<uint8_t> reversed;
+    reversed.reserve(symbols.size() / 2 + 16);
+    uint32_t states[NUM_STATES] = {RANS_L, RANS_L};
+    for (size_t i = symbols.size(); i-- > 0; )
+    {
+        uint32_t& x = states[i % NUM_STATES];
+        uint32_t freq = freqs[symbols[i]];
+        uint32_t xMax = ((RANS_L >> PROB_BITS) << 8) * freq;
+        while (x >= xMax)
+        {
+            reversed.push_back(x & 0xff);
+            x >>= 8;
+        }
+        x = ((x / freq) << PROB_BITS) + (x % freq) + starts[symbols[i]];
+    }
+    for (int k = NUM_STATES - 1; k >= 0; k--)
+        for (int i = 3; i >= 0; i--)
+            reversed.push_back(states[k] >> (i * 8));
+
+    out.insert(out.end(), reversed.rbegin(), reversed.rend());
+}
+
+/**
+\brief Decode byte streams written by encode and stored back to back.
+
+Within a stream the states share one input pointer, so each state waits for the previous one
+to refill and decoding is bound by that chain. Streams are independent, so they are stepped
+together, as many rounds at a time as every stream can take without reaching its end, and
+finished one by one with checked input.
+
+\param in - first coded stream.
+\param sizes - number of bytes of each coded stream.
+\param numStreams - number of streams.
+\param maxSymbols - most bytes a stream decodes to, streams claiming more are corrupt.
+\param symbols - receive decoded bytes of each stream.
+\return false if a stream is corrupt.
+*/
+
+bool RansCoder::decode(const uint8_t* in, const size_t* sizes, int numStreams, size_t maxSymbols, std::vector<uint8_t>* symbols)
+{
+    std::vector<Stream> streams(numStreams);
+    for (int k = 0; k < numStreams; k++)
+    {
+        if (!open(in, sizes[k], maxSymbols, symbols[k], streams[k]))
+            return false;
+        in += sizes[k];
+    }
+
+    // Streams are stepped MAX_STREAMS at a time. States and pointers are kept in locals, the
+    // stores of decoded bytes could otherwise alias them and force reloads.
+    for (int first = 0; first < numStreams; first += MAX_STREAMS)
+    {
+        int count = std::min(numStreams - first, MAX_STREAMS);
+        Stream* group = &streams[first];
+        uint32_t x[MAX_STREAMS][NUM_STATES];
+        const uint8_t* ptr[MAX_STREAMS];
+        uint8_t* out[MAX_STREAMS];
+        for (int k = 0; k < count; k++)
+        {
+            for (int j = 0; j < NUM_STATES; j++)
+                x[k][j] = group[k].states[j];
+            ptr[k] = group[k].ptr;
+            out[k] = group[k].out + group[k].next;
+        }
+
+        while (true)
+        {
+            size_t rounds = SIZE_MAX;
+            for (int k = 0; k < count; k++)
+            {
+                size_t symbolRounds = (group[k].numSymbols - (out[k] - group[k].out)) / NUM_STATES;
+                size_t inputRounds = (group[k].end - ptr[k]) / (NUM_STATES * MAX_REFILL);
+                rounds = std::min(rounds, std::min(symbolRounds, inputRounds));
+            }
+            if (rounds == 0)
+                break;
+
+            for (size_t r = 0; r < rounds; r++)
+            {
+                for (int k = 0; k < count; k++)
+                {
+                    const Stream& stream = group[k];
+                    for (int j = 0; j < NUM_STATES; j++)
+                    {
+                        uint32_t slot = x[k][j] & (PROB_SCALE - 1);
+                        uint8_t s = stream.lookup[slot];
+                        out[k][j] = s;
+                        x[k][j] = stream.freqs[s] * (x[k][j] >> PROB_BITS) + slot - stream.starts[s];
+                        refill(x[k][j], ptr[k]);
+                    }
+                    out[k] += NUM_STATES;
+                }
+            }
+        }
+
+        for (int k = 0; k < count; k++)
+        {
+            for (int j = 0; j < NUM_STATES; j++)
+                group[k].states[j] = x[k][j];
+            group[k].ptr = ptr[k];
+            group[k].next = out[k] - group[k].out;
+        }
+    }
+
+    for (int k = 0; k < numStreams; k++)
+    {
+        if (!finish(streams[k]))
+            return false;
+    }
+    return true;
+}
+
+/**
+\brief Read the frequency table and initial states of a stream.
+
+\param in - coded stream.
+\param size - number of bytes of coded stream.
+\param maxSymbols - most bytes the stream may decode to.
+\param symbols - resized to the decoded size of the stream.
+\param stream - receives decoder of the stream.
+\return false if stream is corrupt.
+*/
+
+bool RansCoder::open(const uint8_t* in, size_t size, size_t maxSymbols, std::vector<uint8_t>& symbols, Stream& stream)
+{
+    const size_t tableSize = 4 + 256 * 2;
+    if (size < tableSize)
+        return false;
+
+    uint32_t numSymbols;
+    memcpy(&numSymbols, in, 4);
+    if (numSymbols > maxSymbols)
+        return false;
+
+    uint32_t sum = 0;
+    for (int s = 0; s < 256; s++)
+    {
+        uint16_t freq;
+        memcpy(&freq, in + 4 + s * 2, 2);
+        stream.freqs[s] = freq;
+        stream.starts[s] = sum;
+        sum += freq;
+    }
+
+    symbols.resize(numSymbols);
+    stream.ptr = stream.end = in + size;
+    stream.out = symbols.data();
+    stream.numSymbols = numSymbols;
+    stream.next = numSymbols;
+    if (numSymbols == 0)
+        return true;
+    if (sum != PROB_SCALE || size < tableSize + 4 * NUM_STATES)
+        return false;
+
+    for (int s = 0; s < 256; s++)
+        memset(stream.lookup + stream.starts[s], s, stream.freqs[s]);
+
+    stream.ptr = in + tableSize;
+    for (int k = 0; k < NUM_STATES; k++, stream.ptr += 4)
+    {
+        // Encoders end above RANS_L, which bounds the bytes a state takes per symbol.
+        stream.states[k] = stream.ptr[0] | (stream.ptr[1] << 8) | (stream.ptr[2] << 16) | ((uint32_t)stream.ptr[3] << 24);
+        if (stream.states[k] < RANS_L)
+            return false;
+    }
+    stream.next = 0;
+    return true;
+}
+
+/**
+\brief Decode symbols left in a stream, checking for the end of input.
+
+\return false if input ran out.
+*/
+
+bool RansCoder::finish(Stream& stream)
+{
+    for (; stream.next < stream.numSymbols; stream.next++)
+    {
+        // Symbol i belongs to state i % NUM_STATES.
+        uint32_t& x = stream.states[stream.next % NUM_STATES];
+        uint32_t slot = x & (PROB_SCALE - 1);
+        uint8_t s = stream.lookup[slot];
+        stream.out[stream.next] = s;
+        x = stream.freqs[s] * (x >> PROB_BITS) + slot - stream.starts[s];
+        if (!renormalize(x, stream.ptr, stream.end))
+            return false;
+    }
+    return true;
+}
+
+/**
+\brief Refill decoder state from input until it is back above RANS_L, without branches: how
+many bytes a state takes depends on the data, so a branch on it is mispredicted about every
+other symbol.
+
+\param x - decoder state after decoding a symbol.
+\param ptr - next input byte, at least MAX_REFILL left, advanced past consumed bytes.
+*/
+
+void RansCoder::refill(uint32_t& x, const uint8_t*& ptr)
+{
+    int n = (x < RANS_L) + (x < (RANS_L >> 8));
+    uint32_t bytes = (ptr[0] << 8 | ptr[1]) >> (8 * (MAX_REFILL - n));
+    x = (x << (8 * n)) | bytes;
+    ptr += n;
+}
+
+/**
+\brief Refill decoder state from input until it is back above RANS_L.
+
+\param x - decoder state.
+\param ptr - next input byte, advanced past consumed bytes.
+\param end - end of input.
+\return false if input ran out.
+*/
+
+bool RansCoder::renormalize(uint32_t& x, const uint8_t*& ptr, const uint8_t* end)
+{
+    while (x < RANS_L)
+    {
+        if (ptr == end)
+            return false;
+        x = (x << 8) | *ptr++;
+    }
+    return true;
+}
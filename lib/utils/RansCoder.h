@@ -0,0 +1,56 @@
+#ifndef RANSCODER_H
+#define RANSCODER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+/**
+\class RansCoder
+
+\brief Order-0 range asymmetric numeral system coder for byte streams. Symbol frequencies are
+counted per stream and stored in front of it, so each stream is coded with its own model.
+
+Stream layout: symbol count (u32), frequency of each byte value (256 x u16, summing to
+PROB_SCALE), then the coder output starting with its final states. Two coder states take turns
+on even and odd symbols so that the decoder can work on both at once.
+
+*/
+
+class RansCoder
+{
+    public:
+        static const int PROB_BITS = 12;
+        static const uint32_t PROB_SCALE = 1 << PROB_BITS;
+        static const uint32_t RANS_L = 1 << 23;     ///< Lower bound of normalized coder state.
+        static const int NUM_STATES = 2;
+        static const int MAX_REFILL = 2;            ///< Most bytes a state reads per symbol decoded.
+        static const int MAX_STREAMS = 4;           ///< Streams decoded together.
+
+        static void encode(const std::vector<uint8_t>& symbols, std::vector<uint8_t>& out);
+        static bool decode(const uint8_t* in, const size_t* sizes, int numStreams, size_t maxSymbols, std::vector<uint8_t>* symbols);
+    protected:
+    private:
+        struct Stream
+        {
+            uint32_t freqs[256];
+            uint32_t starts[256];
+            uint8_t lookup[PROB_SCALE];     ///< Symbol of each slot.
+            uint32_t states[NUM_STATES];
+            const uint8_t* ptr;             ///< Next input byte.
+            const uint8_t* end;
+            uint8_t* out;
+            uint32_t numSymbols;
+            uint32_t next;                  ///< Next symbol to decode.
+        };
+
+        static bool open(const uint8_t* in, size_t size, size_t maxSymbols, std::vector<uint8_t>& symbols, Stream& stream);
+        static bool finish(Stream& stream);
+        static void normalize(const uint32_t* counts, size_t total, uint32_t* freqs);
+        static bool renormalize(uint32_t& x, const uint8_t*& ptr, const uint8_t* end);
+        static void refill(uint32_t& x, const uint8_t*& ptr);
+};
+
+#endif // RANSCODER_H
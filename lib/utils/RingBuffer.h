@@ -0,0 +1,101 @@
+#ifndef RING_BUFFER
+#define RING_BUFFER
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// A bounded lock-free single-producer/single-consumer queue.
+//
+// Exactly one thread may call tryPush and exactly one other thread may call tryPop.
+// Items are moved in and out of preallocated slots so no allocation and no lock
+// happens on the hand-off. Head and tail live on separate cache lines to avoid
+// false sharing between producer and consumer.
+template <typename T>
+class RingBuffer
+{
+    public:
+        static const size_t CACHE_LINE = 64;
+
+        RingBuffer(size_t capacity) : capacity_(capacity), slots_(capacity), head_(0), tail_(0), cachedHead_(0), cachedTail_(0) {}
+        RingBuffer(const RingBuffer<T> &obj) = delete;
+        RingBuffer<T>& operator=(const RingBuffer<T> &obj) = delete;
+
+        // Producer side. Returns false without touching item if the buffer is full.
+        bool tryPush(T&& item)
+        {
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - cachedHead_ == capacity_)
+            {
+                cachedHead_ = head_.load(std::memory_order_acquire);
+                if (tail - cachedHead_ == capacity_)
+                    return false;
+            }
+
+            slots_[tail % capacity_] = std::move(item);
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer side. Returns false if the buffer is empty.
+        bool tryPop(T& item)
+        {
+            const size_t head = head_.load(std::memory_order_relaxed);
+            if (head == cachedTail_)
+            {
+                cachedTail_ = tail_.load(std::memory_order_acquire);
+                if (head == cachedTail_)
+                    return false;
+            }
+
+            T& slot = slots_[head % capacity_];
+            item = std::move(slot);
+            // Release whatever the moved-from slot still owns.
+            slot = T();
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer side. Returns the next item without removing it, or NULL if the buffer is empty.
+        T* front()
+        {
+            const size_t head = head_.load(std::memory_order_relaxed);
+            if (head == cachedTail_)
+            {
+                cachedTail_ = tail_.load(std::memory_order_acquire);
+                if (head == cachedTail_)
+                    return NULL;
+            }
+            return &slots_[head % capacity_];
+        }
+
+        // Approximate when called while the other side is running.
+        int size() const
+        {
+            const size_t head = head_.load(std::memory_order_acquire);
+            const size_t tail = tail_.load(std::memory_order_acquire);
+            return (int)(tail - head);
+        }
+
+        size_t capacity() const
+        {
+            return capacity_;
+        }
+
+    private:
+        const size_t capacity_;
+        std::vector<T> slots_;
+
+        // Padding keeps each index on its own cache line.
+        char pad0_[CACHE_LINE];
+        std::atomic<size_t> head_;      // Next slot to pop, written by consumer.
+        char pad1_[CACHE_LINE - sizeof(size_t)];
+        std::atomic<size_t> tail_;      // Next slot to push, written by producer.
+        char pad2_[CACHE_LINE - sizeof(size_t)];
+        size_t cachedHead_;             // Producer's last view of head_.
+        char pad3_[CACHE_LINE - sizeof(size_t)];
+        size_t cachedTail_;             // Consumer's last view of tail_.
+        char pad4_[CACHE_LINE - sizeof(size_t)];
+};
+#endif
@@ -26,7 +26,7 @@ class SafeQueue
             {
                 cond_.wait(mlock);
             }
-            auto item = queue_.front();
+            auto item = std::move(queue_.front());
             queue_.pop();
             return item;
         }
@@ -38,7 +38,7 @@ class SafeQueue
             {
                 cond_.wait(mlock);
             }
-            item = queue_.front();
+            item = std::move(queue_.front());
             queue_.pop();
         }
        
@@ -60,11 +60,8 @@ class SafeQueue
 
         int size()
         {
-            std::unique_lock<std::mutex> mlock(mutex_);
-            int size = queue_.size();
-            mlock.unlock();
-            cond_.notify_one();
-            return size;
+            std::lock_guard<std::mutex> mlock(mutex_);
+            return queue_.size();
         }
        
     private:
@@ -73,10 +73,66 @@ void TextureController::loadTexture(sf::Image texture)
     glBindTexture(GL_TEXTURE_2D, texID);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texture.getSize().x, texture.getSize().y, 0, GL_RGBA, GL_UNSIGNED_BYTE, texture.getPixelsPtr());
     glGenerateMipmap(GL_TEXTURE_2D);
+    GLint swizzle[4] = {GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA};
+    glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);     // GL default, all generated levels.
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    texWidth = texHeight = texLevels = texChannels = 0;
+}
+
+/**
+\brief Load a transcoded camera frame. Its mip levels are uploaded as they are, in the
+channel count of the frame, and frames of the same layout as the last one overwrite its
+storage instead of reallocating it. Grayscale is stored as one channel and shown gray
+through the texture swizzle.
+\param frame - grayscale, RGB or RGBA image with mip levels.
+*/
+
+void TextureController::loadTexture(const CameraFrame& frame)
+{
+    glUseProgram(program);
+    glUniform1i(tex1Loc, texID);
+
+    glActiveTexture(GL_TEXTURE0 + texID);
+    glBindTexture(GL_TEXTURE_2D, texID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    GLenum format = frame.getChannels() == 1 ? GL_RED : frame.getChannels() == 4 ? GL_RGBA : GL_RGB;
+    GLint internalFormat = frame.getChannels() == 1 ? GL_R8 : frame.getChannels() == 4 ? GL_RGBA8 : GL_RGB8;
+    bool isSameLayout = frame.getWidth() == texWidth && frame.getHeight() == texHeight &&
+                        frame.getNumLevels() == texLevels && frame.getChannels() == texChannels;
+    for (int level = 0; level < frame.getNumLevels(); level++)
+    {
+        if (isSameLayout)
+            glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, frame.getWidth(level), frame.getHeight(level), format, GL_UNSIGNED_BYTE, frame.getPixels(level));
+        else
+            glTexImage2D(GL_TEXTURE_2D, level, internalFormat, frame.getWidth(level), frame.getHeight(level), 0, format, GL_UNSIGNED_BYTE, frame.getPixels(level));
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    if (!isSameLayout)
+    {
+        GLint swizzle[4] = {GL_RED, GL_GREEN, GL_BLUE, GL_ALPHA};
+        if (frame.getChannels() == 1)
+        {
+            swizzle[1] = swizzle[2] = GL_RED;
+            swizzle[3] = GL_ONE;
+        }
+        glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, frame.getNumLevels() - 1);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        texWidth = frame.getWidth();
+        texHeight = frame.getHeight();
+        texLevels = frame.getNumLevels();
+        texChannels = frame.getChannels();
+    }
 }
 
 /**
@@ -16,6 +16,7 @@
 
 #include "../utils/LoadShaders.h"
 #include "../utils/ProgramDefines.h"
+#include "../data/CameraFrame.h"
 
 class TextureController
 {
@@ -28,7 +29,8 @@ class TextureController
 
         void loadTextureFromFile(const char* filename);
         void loadTexture(sf::Image texture);
-        
+        void loadTexture(const CameraFrame& frame);
+
         void useProgram();
 
         void turnOnTexture();
@@ -44,6 +46,10 @@ class TextureController
         GLuint program;        ///< ID of the shader program.
 
         GLuint texID;
+        int texWidth = 0;       ///< Size of texture storage filled by last CameraFrame, 0 if none.
+        int texHeight = 0;
+        int texLevels = 0;
+        int texChannels = 0;
 };
 
 #endif // TEXTURECONTROLLER_H
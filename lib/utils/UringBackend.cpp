@@ -0,0 +1,266 @@
+#include "UringBackend.h"
+
+const unsigned UringBackend::QUEUE_DEPTH;
+
+UringBackend::UringBackend()
+{
+    if (!getRing().isReady())
+        printf("io_uring is not available, reading with pread.\n");
+}
+
+UringBackend::~UringBackend()
+{
+    //dtor
+}
+
+const char* UringBackend::getName() const
+{
+    return "uring";
+}
+
+/**
+\brief Set up a ring and map its queues. Kernels before 5.6 set up rings but lack
+IORING_OP_READ, such rings are closed again so reads go through pread.
+*/
+
+UringBackend::Ring::Ring() : fd(-1), sqMap(MAP_FAILED), cqMap(MAP_FAILED), sqes((io_uring_sqe*)MAP_FAILED)
+{
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    fd = syscall(__NR_io_uring_setup, QUEUE_DEPTH, &params);
+    if (fd < 0)
+        return;
+    if (!isReadSupported())
+    {
+        close(fd);
+        fd = -1;
+        return;
+    }
+
+    sqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        sqMapSize = cqMapSize = std::max(sqMapSize, cqMapSize);
+
+    sqMap = mmap(NULL, sqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+        cqMap = sqMap;
+    else
+        cqMap = mmap(NULL, cqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    sqes = (io_uring_sqe*)mmap(NULL, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (!isReady())
+        return;
+
+    char* sq = (char*)sqMap;
+    sqHead = (unsigned*)(sq + params.sq_off.head);
+    sqTail = (unsigned*)(sq + params.sq_off.tail);
+    sqMask = (unsigned*)(sq + params.sq_off.ring_mask);
+    sqArray = (unsigned*)(sq + params.sq_off.array);
+
+    char* cq = (char*)cqMap;
+    cqHead = (unsigned*)(cq + params.cq_off.head);
+    cqTail = (unsigned*)(cq + params.cq_off.tail);
+    cqMask = (unsigned*)(cq + params.cq_off.ring_mask);
+    cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+}
+
+UringBackend::Ring::~Ring()
+{
+    if (sqes != MAP_FAILED)
+        munmap(sqes, sqesSize);
+    if (cqMap != MAP_FAILED && cqMap != sqMap)
+        munmap(cqMap, cqMapSize);
+    if (sqMap != MAP_FAILED)
+        munmap(sqMap, sqMapSize);
+    if (fd >= 0)
+        close(fd);
+}
+
+bool UringBackend::Ring::isReady() const
+{
+    return fd >= 0 && sqMap != MAP_FAILED && cqMap != MAP_FAILED && sqes != MAP_FAILED;
+}
+
+/**
+\brief Ask the kernel if it knows IORING_OP_READ. Kernels without IORING_REGISTER_PROBE are
+older than 5.6 and do not know it either.
+*/
+
+bool UringBackend::Ring::isReadSupported() const
+{
+    std::vector<char> buffer(sizeof(io_uring_probe) + IORING_OP_LAST * sizeof(io_uring_probe_op), 0);
+    io_uring_probe* probe = (io_uring_probe*)buffer.data();
+    if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, IORING_OP_LAST) < 0)
+        return false;
+    return probe->last_op >= IORING_OP_READ && (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+}
+
+/**
+\brief Get ring of calling thread. Every loader thread has its own, so batches of different
+threads never wait on each other.
+*/
+
+UringBackend::Ring& UringBackend::getRing()
+{
+    static thread_local Ring ring;
+    return ring;
+}
+
+std::shared_ptr<FileBuffer> UringBackend::readFile(const std::string& filename)
+{
+    return readFiles(std::vector<std::string>(1, filename))[0];
+}
+
+/**
+\brief Read whole files in one batch.
+
+\param  filenames - paths of the files.
+\return content of each file, in the same order.
+*/
+
+std::vector<std::shared_ptr<FileBuffer> > UringBackend::readFiles(const std::vector<std::string>& filenames)
+{
+    if (!getRing().isReady())
+        return PreadBackend::readFiles(filenames);
+
+    std::vector<std::shared_ptr<FileBuffer> > buffers(filenames.size());
+    std::vector<Read> reads(filenames.size());
+    for (int i = 0; i < filenames.size(); i++)
+    {
+        size_t size;
+        reads[i].fd = openFile(filenames[i], 0, size);
+        if (reads[i].fd < 0)
+            exitMissing(filenames[i]);
+        buffers[i] = FileBuffer::allocate(size);
+        reads[i].offset = 0;
+        reads[i].buffer = buffers[i].get();
+        reads[i].isWholeFile = true;
+    }
+
+    submitReads(reads);
+
+    for (int i = 0; i < reads.size(); i++)
+        close(reads[i].fd);
+    return buffers;
+}
+
+/**
+\brief Read ranges of an archive in one batch.
+
+\param  fd - open archive.
+\param  ranges - byte ranges to read.
+\return content of each range, in the same order.
+*/
+
+std::vector<std::shared_ptr<FileBuffer> > UringBackend::readFileRanges(int fd, const std::vector<Range>& ranges)
+{
+    if (!getRing().isReady())
+        return PreadBackend::readFileRanges(fd, ranges);
+
+    std::vector<std::shared_ptr<FileBuffer> > buffers(ranges.size());
+    std::vector<Read> reads(ranges.size());
+    for (int i = 0; i < ranges.size(); i++)
+    {
+        buffers[i] = FileBuffer::allocate(ranges[i].size);
+        reads[i].fd = fd;
+        reads[i].offset = ranges[i].offset;
+        reads[i].buffer = buffers[i].get();
+        reads[i].isWholeFile = false;
+    }
+
+    submitReads(reads);
+    return buffers;
+}
+
+/**
+\brief Fill buffers with one submission per round. Short reads are resubmitted for the rest
+of the buffer in the next round.
+
+\param  reads - reads to run, every buffer is filled from its offset on.
+*/
+
+void UringBackend::submitReads(std::vector<Read>& reads)
+{
+    Ring& ring = getRing();
+
+    std::vector<size_t> done(reads.size(), 0);
+    std::vector<int> pending;
+    for (int i = 0; i < reads.size(); i++)
+        if (!reads[i].buffer->isEmpty())
+            pending.push_back(i);
+
+    while (!pending.empty())
+    {
+        // Queue one read per buffer, as many as the ring holds.
+        int count = std::min((int)pending.size(), (int)QUEUE_DEPTH);
+        unsigned tail = *ring.sqTail;
+        for (int k = 0; k < count; k++)
+        {
+            int i = pending[k];
+            unsigned index = tail & *ring.sqMask;
+            io_uring_sqe* sqe = &ring.sqes[index];
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = reads[i].fd;
+            sqe->addr = (unsigned long)(reads[i].buffer->getData() + done[i]);
+            sqe->len = std::min(reads[i].buffer->getSize() - done[i], (size_t)1 << 30);
+            sqe->off = reads[i].offset + done[i];
+            sqe->user_data = i;
+            ring.sqArray[index] = index;
+            tail++;
+        }
+        __atomic_store_n(ring.sqTail, tail, __ATOMIC_RELEASE);
+
+        int submitted = 0;
+        while (submitted < count)
+        {
+            int ret = syscall(__NR_io_uring_enter, ring.fd, count - submitted, count - submitted, IORING_ENTER_GETEVENTS, NULL, 0);
+            if (ret == 0 || (ret < 0 && errno != EINTR))
+            {
+                printf(" Error, io_uring submission failed: %s\n", ret == 0 ? "no request accepted" : strerror(errno));
+                exit(1);
+            }
+            if (ret > 0)
+                submitted += ret;
+        }
+
+        // Reap every completion of this round.
+        std::vector<int> next;
+        for (int reaped = 0; reaped < count; )
+        {
+            unsigned head = *ring.cqHead;
+            if (head == __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE))
+            {
+                if (syscall(__NR_io_uring_enter, ring.fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR)
+                {
+                    printf(" Error, io_uring wait failed: %s\n", strerror(errno));
+                    exit(1);
+                }
+                continue;
+            }
+
+            io_uring_cqe* cqe = &ring.cqes[head & *ring.cqMask];
+            int i = cqe->user_data;
+            if (cqe->res < 0 || (cqe->res == 0 && !reads[i].isWholeFile))
+            {
+                printf(" Error, Couldn't read at offset %llu: %s\n", (unsigned long long)(reads[i].offset + done[i]),
+                       cqe->res < 0 ? strerror(-cqe->res) : "end of file");
+                exit(1);
+            }
+
+            done[i] += cqe->res;
+            if (cqe->res == 0)
+                reads[i].buffer->setSize(done[i]);
+            else if (done[i] < reads[i].buffer->getSize())
+                next.push_back(i);
+
+            __atomic_store_n(ring.cqHead, head + 1, __ATOMIC_RELEASE);
+            reaped++;
+        }
+
+        next.insert(next.end(), pending.begin() + count, pending.end());
+        pending.swap(next);
+    }
+}
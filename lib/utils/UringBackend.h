@@ -0,0 +1,79 @@
+#ifndef URINGBACKEND_H
+#define URINGBACKEND_H
+
+#include <string.h>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+#include "PreadBackend.h"
+
+/**
+\class UringBackend
+
+\brief Reads all files of a batch, e.g. both camera images of a frame, or all ranges of a frame
+in a packed archive, through one io_uring submission, so the device sees every request at once. Useful where single requests have
+high latency, like RAID and network mounts. Talks to the kernel through raw system calls
+and falls back to pread where io_uring is not available.
+
+*/
+
+class UringBackend : public PreadBackend
+{
+    public:
+        UringBackend();
+        virtual ~UringBackend();
+
+        static const unsigned QUEUE_DEPTH = 32;     ///< Submission queue entries of each thread's ring.
+
+        virtual const char* getName() const;
+    protected:
+        virtual std::shared_ptr<FileBuffer> readFile(const std::string& filename);
+        virtual std::vector<std::shared_ptr<FileBuffer> > readFiles(const std::vector<std::string>& filenames);
+        virtual std::vector<std::shared_ptr<FileBuffer> > readFileRanges(int fd, const std::vector<Range>& ranges);
+    private:
+        /**
+        \brief One buffer to fill from a file.
+        */
+        struct Read
+        {
+            int fd;
+            uint64_t offset;        ///< File offset of first byte of buffer.
+            FileBuffer* buffer;
+            bool isWholeFile;       ///< Whole files may come back shorter than expected, ranges may not.
+        };
+
+        /**
+        \brief Submission and completion rings of one io_uring instance, mapped from the kernel.
+        */
+        struct Ring
+        {
+            Ring();
+            ~Ring();
+            bool isReady() const;
+            bool isReadSupported() const;
+
+            int fd;
+            void* sqMap;
+            size_t sqMapSize;
+            void* cqMap;
+            size_t cqMapSize;
+            io_uring_sqe* sqes;
+            size_t sqesSize;
+
+            unsigned* sqHead;
+            unsigned* sqTail;
+            unsigned* sqMask;
+            unsigned* sqArray;
+            unsigned* cqHead;
+            unsigned* cqTail;
+            unsigned* cqMask;
+            io_uring_cqe* cqes;
+        };
+
+        static Ring& getRing();
+        void submitReads(std::vector<Read>& reads);
+};
+
+#endif // URINGBACKEND_H
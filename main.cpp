@@ -7,6 +7,8 @@
 
 #include "GraphicsEngine.h"
 #include "UI.h"
+#include "lib/loaders/ConfigLoader.h"
+#include "lib/loaders/DriveCatalog.h"
 
 /**
 \mainpage Wavefront Simple OBJ File Loader
@@ -105,9 +107,92 @@ class, and links the two.
 */
 
 
+/**
+\brief Handle drive catalog options. Catalog options exit before any window is opened.
+
+\param argc - number of arguments.
+\param argv - arguments.
+
+Options:
+- --catalog [threads]: Summarize every drive under the root of conf.txt into its catalog.
+- --list: Print drives of the catalog, narrowed by --date D, --min-frames N, --tracklets
+and --packed.
+- --drive NAME: View drive NAME, e.g. 2011_09_26_drive_0001_sync, instead of the one in conf.txt.
+
+*/
+
+void parseArguments(int argc, char* argv[])
+{
+    ConfigLoader* conf = ConfigLoader::getInstance();
+    bool isCatalog = false;
+    bool isList = false;
+    int numThreads = std::max((int)std::thread::hardware_concurrency(), 1);
+    DriveCatalog::Filter filter;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc && argv[i + 1][0] != '-';
+        if (arg == "--catalog")
+        {
+            isCatalog = true;
+            if (hasValue)
+                numThreads = std::max(atoi(argv[++i]), 1);
+        } else if (arg == "--list")
+        {
+            isList = true;
+        } else if (arg == "--date" && hasValue)
+        {
+            filter.date = argv[++i];
+        } else if (arg == "--min-frames" && hasValue)
+        {
+            filter.minFrames = atoi(argv[++i]);
+        } else if (arg == "--tracklets")
+        {
+            filter.needsTracklets = true;
+        } else if (arg == "--packed")
+        {
+            filter.needsPacked = true;
+        } else if (arg == "--drive" && hasValue)
+        {
+            DriveCatalog::Drive drive;
+            if (!DriveCatalog::parseName(argv[++i], drive))
+            {
+                printf("Wrong drive name: %s\n", argv[i]);
+                exit(1);
+            }
+            conf->setDrive(drive.date, drive.drive, drive.layout);
+        } else
+        {
+            printf("Unknown option: %s\n", argv[i]);
+            printf("Usage: %s [--catalog [threads]] [--list [--date D] [--min-frames N] [--tracklets] [--packed]] [--drive NAME]\n", argv[0]);
+            exit(1);
+        }
+    }
+
+    if (!isCatalog && !isList)
+        return;
+
+    DriveCatalog catalog(conf->getRootPath());
+    if (isCatalog)
+    {
+        catalog.scan(numThreads);
+        catalog.write();
+    } else if (!catalog.isLoaded())
+    {
+        printf("No catalog in %s, build it with --catalog\n", conf->getRootPath().c_str());
+        exit(1);
+    }
+
+    DriveCatalog::print(catalog.find(filter));
+    exit(EXIT_SUCCESS);
+}
+
 /**
 \brief The Main function, program entry point.
 
+\param argc - number of arguments.
+\param argv - arguments, see parseArguments.
 \return Standard EXIT_SUCCESS return on successful run.
 
 This is the main function, responsible for initializing GLEW and setting up
@@ -115,8 +200,11 @@ the SFML interface for OpenGL.
 
 */
 
-int main()
+int main(int argc, char* argv[])
 {
+    ConfigLoader::getInstance()->loadFile("conf.txt");
+    parseArguments(argc, argv);
+
     sf::RenderWindow d;
     if (glewInit())
     {
@@ -143,8 +231,8 @@ int main()
         if (timesec > 1.0)
         {
             float fps = framecount / timesec;
-            int simulatorFps = ge.getFrameRate();
-            sprintf(titlebar, "%s     FPS: %.2f, Simulator FPS: %d", progName.c_str(), fps, simulatorFps);
+            float speed = ge.getPlaybackSpeed();
+            sprintf(titlebar, "%s     FPS: %.2f, Playback speed: %.2fx%s", progName.c_str(), fps, speed, ge.isReverse() ? " (reverse)" : "");
             ge.setTitle(titlebar);
             time = clock.restart();
             framecount = 0;
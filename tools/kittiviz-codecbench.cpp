@@ -0,0 +1,209 @@
+/**
+\file kittiviz-codecbench.cpp
+
+\brief Measures how small PointCodec makes velodyne sweeps and how fast it decodes them.
+
+Usage: kittiviz-codecbench <drive folder> [frames] [max error in meters]
+
+The first binary sweeps of velodyne_points/data, 100 unless given, are read into memory
+first, so only the codec is timed. Each is encoded lossless and with the given maximum
+error, 0.001 unless given, the way kittiviz-pack --codec does. Every encoded sweep is then
+decoded once to warm up and once timed, and checked against the input.
+
+Decode speed is given in MB/s of raw floats produced. A packed drive only loads faster with
+the codec when this is above the rate the disk delivers the raw `.bin` files at.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include "../lib/data/PointCodec.h"
+
+static const int DEFAULT_FRAMES = 100;
+static const float DEFAULT_ERROR = 0.001;
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+\brief A sweep split into the x, y, z and reflectance columns PointCodec works on.
+*/
+
+struct Sweep
+{
+    size_t numPoints;
+    std::vector<float> columns[PointCodec::NUM_CHANNELS];
+};
+
+/**
+\brief Read a binary sweep, four floats per point.
+
+\param filename - path of the file.
+\param sweep - receives points of the file.
+\return false if file can not be read.
+*/
+
+static bool readSweep(const std::string& filename, Sweep& sweep)
+{
+    FILE* fin = fopen(filename.c_str(), "rb");
+    if (!fin)
+        return false;
+
+    fseeko(fin, 0, SEEK_END);
+    std::vector<float> points(ftello(fin) / sizeof(float));
+    fseeko(fin, 0, SEEK_SET);
+    bool isRead = points.empty() || fread(&points[0], sizeof(float), points.size(), fin) == points.size();
+    fclose(fin);
+    if (!isRead)
+        return false;
+
+    sweep.numPoints = points.size() / PointCodec::NUM_CHANNELS;
+    for (int c = 0; c < PointCodec::NUM_CHANNELS; c++)
+    {
+        sweep.columns[c].resize(sweep.numPoints);
+        for (size_t i = 0; i < sweep.numPoints; i++)
+            sweep.columns[c][i] = points[i * PointCodec::NUM_CHANNELS + c];
+    }
+    return true;
+}
+
+/**
+\brief Decode every encoded sweep.
+
+\param decoded - receives the sweeps, sized like the input.
+\return seconds taken, negative if a sweep can not be decoded.
+*/
+
+static double decodeAll(const std::vector<std::vector<char> >& encoded, std::vector<Sweep>& decoded)
+{
+    auto start = Clock::now();
+    for (int i = 0; i < encoded.size(); i++)
+    {
+        float* columns[PointCodec::NUM_CHANNELS];
+        for (int c = 0; c < PointCodec::NUM_CHANNELS; c++)
+            columns[c] = decoded[i].columns[c].data();
+        if (!PointCodec::decode(encoded[i].data(), encoded[i].size(), columns))
+            return -1;
+    }
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+\brief Get the largest difference between input and decoded values of a channel, infinite
+if a lossless channel differs at all.
+*/
+
+static float getMaxError(const std::vector<Sweep>& sweeps, const std::vector<Sweep>& decoded, int channel, bool isLossless)
+{
+    float maxError = 0;
+    for (int i = 0; i < sweeps.size(); i++)
+    {
+        const std::vector<float>& in = sweeps[i].columns[channel];
+        const std::vector<float>& out = decoded[i].columns[channel];
+        if (isLossless && memcmp(in.data(), out.data(), in.size() * sizeof(float)) != 0)
+            return INFINITY;
+        for (size_t k = 0; k < in.size(); k++)
+            maxError = std::max(maxError, fabsf(in[k] - out[k]));
+    }
+    return maxError;
+}
+
+/**
+\brief Encode, decode and check every sweep with one maximum error, 0 for lossless.
+
+\return false if a sweep does not come back within the error.
+*/
+
+static bool run(const char* name, const std::vector<Sweep>& sweeps, float maxError)
+{
+    std::vector<std::vector<char> > encoded(sweeps.size());
+    std::vector<Sweep> decoded(sweeps.size());
+    size_t rawBytes = 0, encodedBytes = 0;
+    auto start = Clock::now();
+    for (int i = 0; i < sweeps.size(); i++)
+    {
+        const float* columns[PointCodec::NUM_CHANNELS];
+        for (int c = 0; c < PointCodec::NUM_CHANNELS; c++)
+        {
+            columns[c] = sweeps[i].columns[c].data();
+            decoded[i].columns[c].resize(sweeps[i].numPoints);
+        }
+        decoded[i].numPoints = sweeps[i].numPoints;
+        PointCodec::encode(columns, sweeps[i].numPoints, maxError, encoded[i]);
+        rawBytes += sweeps[i].numPoints * PointCodec::NUM_CHANNELS * sizeof(float);
+        encodedBytes += encoded[i].size();
+    }
+    double encodeSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    decodeAll(encoded, decoded);
+    double decodeSeconds = decodeAll(encoded, decoded);
+    if (decodeSeconds < 0)
+    {
+        printf("%-9s could not decode its own output\n", name);
+        return false;
+    }
+
+    printf("%-9s %5.1f%% of raw  encode %7.1f MB/s  decode %7.1f MB/s  %6.2f ms/sweep\n", name,
+           100.0 * encodedBytes / rawBytes, rawBytes / 1e6 / encodeSeconds, rawBytes / 1e6 / decodeSeconds,
+           decodeSeconds * 1000 / sweeps.size());
+
+    bool isLossless = maxError == 0;
+    for (int c = 0; c < PointCodec::NUM_CHANNELS; c++)
+    {
+        float allowed = isLossless ? 0 : c == PointCodec::NUM_CHANNELS - 1 ? PointCodec::REFLECTANCE_ERROR : maxError;
+        float error = getMaxError(sweeps, decoded, c, isLossless);
+        if (error > allowed)
+        {
+            printf("%-9s channel %d is off by %g, more than %g\n", name, c, error, allowed);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printf("Usage: %s <drive folder> [frames] [max error in meters]\n", argv[0]);
+        return 1;
+    }
+    std::string drive = argv[1];
+    int numFrames = argc > 2 ? atoi(argv[2]) : DEFAULT_FRAMES;
+    float maxError = argc > 3 ? atof(argv[3]) : DEFAULT_ERROR;
+    if (maxError <= 0)
+    {
+        printf("Invalid codec error: %s\n", argv[3]);
+        return 1;
+    }
+
+    std::vector<Sweep> sweeps;
+    size_t numPoints = 0;
+    for (int i = 0; i < numFrames; i++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "/%010d.bin", i);
+        Sweep sweep;
+        if (!readSweep(drive + "/velodyne_points/data" + name, sweep))
+            break;
+        numPoints += sweep.numPoints;
+        sweeps.push_back(sweep);
+    }
+    if (sweeps.empty())
+    {
+        printf("No binary sweeps in %s/velodyne_points/data\n", drive.c_str());
+        return 1;
+    }
+
+    printf("%d sweeps, %zu points per sweep\n", (int)sweeps.size(), numPoints / sweeps.size());
+    char name[32];
+    snprintf(name, sizeof(name), "%g m", maxError);
+    bool isValid = run("lossless", sweeps, 0);
+    isValid = run(name, sweeps, maxError) && isValid;
+    return isValid ? 0 : 1;
+}
@@ -0,0 +1,273 @@
+/**
+\file kittiviz-pack.cpp
+
+\brief Converts a KITTI drive folder into a single drive archive read by DataLoader.
+
+Usage: kittiviz-pack [--codec lossless|<max error in meters>] <drive folder> [archive]
+
+Velodyne sweeps are stored raw. With --codec, they are stored encoded by PointCodec, either
+exactly or with coordinates off by at most the given error, e.g. 0.001 for 1 mm. The codec
+only saves space, decoding is slower than reading raw sweeps from local disks, see
+kittiviz-codecbench. The archive defaults to the drive folder name with `.kvpk` appended,
+which is where DataLoader looks for it. Camera and OXT samples closest in time to each
+velodyne sweep are stored with the sweep, so the archive holds exactly what the viewer shows
+per frame.
+Files are taken from the DriveManifest of the drive, frames are the sweeps present, so a
+drive missing sweeps is packed without them.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "../lib/loaders/DriveArchive.h"
+#include "../lib/loaders/DriveManifest.h"
+#include "../lib/data/Timestamps.h"
+#include "../lib/data/CloudPoints.h"
+#include "../lib/data/PointCodec.h"
+
+static const int NUM_CAMERA = 4;    ///< Cameras image_00 to image_03 are packed when present.
+
+/**
+\brief Check if sweeps of a folder are text, as on unsynced "extract" drives.
+*/
+
+static bool hasTextSweeps(const std::string& folderPath)
+{
+    DIR *dp = opendir(folderPath.c_str());
+    if (dp == NULL)
+        return false;
+
+    bool isText = false;
+    struct dirent *dirp;
+    while (!isText && (dirp = readdir(dp))) {
+        size_t length = strlen(dirp->d_name);
+        isText = length > 4 && strcmp(dirp->d_name + length - 4, ".txt") == 0;
+    }
+    closedir(dp);
+    return isText;
+}
+
+/**
+\brief Read a whole file.
+
+\param filename - path of the file.
+\param data - receives content of the file.
+\return false if file can not be read.
+*/
+
+static bool readFile(const std::string& filename, std::vector<char>& data)
+{
+    FILE* fin = fopen(filename.c_str(), "rb");
+    if (!fin)
+        return false;
+
+    fseeko(fin, 0, SEEK_END);
+    data.resize(ftello(fin));
+    fseeko(fin, 0, SEEK_SET);
+    bool isRead = data.empty() || fread(&data[0], 1, data.size(), fin) == data.size();
+    fclose(fin);
+    return isRead;
+}
+
+static void writeOrExit(FILE* fout, const void* data, size_t size, uint64_t& offset)
+{
+    if (size > 0 && fwrite(data, 1, size, fout) != size)
+    {
+        printf("Could not write archive.\n");
+        exit(1);
+    }
+    offset += size;
+}
+
+int main(int argc, char** argv)
+{
+    bool isEncoding = false;
+    float maxError = 0;
+    int arg = 1;
+    if (argc > 2 && strcmp(argv[1], "--codec") == 0)
+    {
+        isEncoding = true;
+        if (strcmp(argv[2], "lossless") != 0)
+        {
+            maxError = atof(argv[2]);
+            if (maxError <= 0)
+            {
+                printf("Invalid codec error: %s\n", argv[2]);
+                return 1;
+            }
+        }
+        arg = 3;
+    }
+
+    if (argc <= arg)
+    {
+        printf("Usage: %s [--codec lossless|<max error in meters>] <drive folder> [archive]\n", argv[0]);
+        return 1;
+    }
+
+    std::string drive = argv[arg];
+    while (drive.size() > 1 && drive[drive.size() - 1] == '/')
+        drive.erase(drive.size() - 1);
+    std::string output = argc > arg + 1 ? argv[arg + 1] : drive + ".kvpk";
+
+    bool isExtract = hasTextSweeps(drive + "/velodyne_points/data");
+    DriveManifest manifest(drive, isExtract);
+    std::vector<int> frameFiles = manifest.getPresent("velodyne_points/data");
+    int numFrames = frameFiles.size();
+    if (numFrames == 0)
+    {
+        printf("No velodyne sweeps in %s/velodyne_points/data\n", drive.c_str());
+        return 1;
+    }
+    int numMissing = manifest.getNumMissing("velodyne_points/data");
+    if (numMissing > 0)
+        printf("Drive misses %d velodyne sweeps, packing the %d present.\n", numMissing, numFrames);
+
+    std::vector<int> cameras;
+    std::vector<std::vector<int> > imageFiles;
+    uint32_t cameraMask = 0;
+    for (int i = 0; i < NUM_CAMERA; i++)
+    {
+        std::vector<int> files = manifest.getPresent("image_0" + std::to_string(i) + "/data");
+        if (!files.empty())
+        {
+            cameras.push_back(i);
+            imageFiles.push_back(files);
+            cameraMask |= 1 << i;
+        }
+    }
+    int numCameras = cameras.size();
+    if (numCameras == 0)
+    {
+        printf("No camera images in %s/image_00/data to image_03/data\n", drive.c_str());
+        return 1;
+    }
+
+    // Match every sensor to the velodyne timeline among its files present, the same way
+    // DataLoader does for folders.
+    Timestamps velodyneTimes(manifest.getPresentTimes("velodyne_points/data"));
+    std::vector<Timestamps*> imageTimes;
+    for (int i = 0; i < numCameras; i++)
+        imageTimes.push_back(new Timestamps(manifest.getPresentTimes("image_0" + std::to_string(cameras[i]) + "/data")));
+    std::vector<int> oxtFiles = manifest.getPresent("oxts/data");
+    Timestamps oxtTimes(manifest.getPresentTimes("oxts/data"));
+    if (oxtFiles.empty())
+    {
+        printf("No OXT records in %s/oxts/data\n", drive.c_str());
+        return 1;
+    }
+
+    std::string partial = output + ".part";
+    FILE* fout = fopen(partial.c_str(), "wb");
+    if (!fout)
+    {
+        printf("Could not create %s\n", partial.c_str());
+        return 1;
+    }
+
+    DriveArchive::Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DriveArchive::MAGIC, sizeof(header.magic));
+    header.version = DriveArchive::VERSION;
+    header.numFrames = numFrames;
+    header.numCameras = numCameras;
+    header.cameras = cameraMask;
+    if (isEncoding)
+        header.flags = DriveArchive::FLAG_ENCODED_VELODYNE;
+    else
+        header.flags = isExtract ? DriveArchive::FLAG_TEXT_VELODYNE : 0;
+
+    uint64_t offset = 0;
+    writeOrExit(fout, &header, sizeof(header), offset);
+
+    header.timesOffset = offset;
+    for (int i = 0; i < numFrames; i++)
+    {
+        double time = velodyneTimes.get(i);
+        writeOrExit(fout, &time, sizeof(time), offset);
+    }
+    for (int i = 0; i < numFrames; i++)
+    {
+        uint32_t fileId = frameFiles[i];
+        writeOrExit(fout, &fileId, sizeof(fileId), offset);
+    }
+
+    int numSensors = DriveArchive::CAMERA + numCameras;
+    std::vector<DriveArchive::Entry> index;
+    std::vector<char> data;
+    std::vector<char> padding(DriveArchive::PAYLOAD_ALIGNMENT, 0);
+    char filename[1000];
+    for (int frameId = 0; frameId < numFrames; frameId++)
+    {
+        writeOrExit(fout, &padding[0], (DriveArchive::PAYLOAD_ALIGNMENT - offset % DriveArchive::PAYLOAD_ALIGNMENT) % DriveArchive::PAYLOAD_ALIGNMENT, offset);
+
+        int fileId = frameFiles[frameId];
+        double time = velodyneTimes.get(frameId);
+        for (int sensor = 0; sensor < numSensors; sensor++)
+        {
+            bool isRequired = true;
+            if (sensor == DriveArchive::VELODYNE) {
+                sprintf(filename, "%s/velodyne_points/data/%010d.%s", drive.c_str(), fileId, isExtract ? "txt" : "bin");
+            } else if (sensor == DriveArchive::TRACKLET) {
+                sprintf(filename, "%s/tracklets/%010d.txt", drive.c_str(), fileId);
+                isRequired = false;
+            } else if (sensor == DriveArchive::OXTS) {
+                sprintf(filename, "%s/oxts/data/%010d.txt", drive.c_str(), oxtFiles[oxtTimes.nearest(time)]);
+            } else {
+                int camera = sensor - DriveArchive::CAMERA;
+                sprintf(filename, "%s/image_%02d/data/%010d.png", drive.c_str(), cameras[camera], imageFiles[camera][imageTimes[camera]->nearest(time)]);
+            }
+
+            if (!readFile(filename, data))
+            {
+                if (isRequired)
+                {
+                    printf("Could not read %s\n", filename);
+                    fclose(fout);
+                    remove(partial.c_str());
+                    return 1;
+                }
+                data.clear();
+            }
+
+            if (sensor == DriveArchive::VELODYNE && isEncoding)
+            {
+                CloudPoints sweep(data.empty() ? NULL : &data[0], data.size(), isExtract);
+                PointCodec::encode(sweep.getColumns(), sweep.getNumPoints(), maxError, data);
+            }
+
+            DriveArchive::Entry entry;
+            entry.offset = offset;
+            entry.size = data.size();
+            index.push_back(entry);
+            writeOrExit(fout, data.empty() ? NULL : &data[0], data.size(), offset);
+        }
+
+        if ((frameId + 1) % 100 == 0 || frameId + 1 == numFrames)
+            printf("Packed %d/%d frames\n", frameId + 1, numFrames);
+    }
+
+    header.indexOffset = offset;
+    writeOrExit(fout, &index[0], index.size() * sizeof(DriveArchive::Entry), offset);
+
+    // Header goes last, a crash leaves no valid archive behind.
+    fseeko(fout, 0, SEEK_SET);
+    uint64_t headerOffset = 0;
+    writeOrExit(fout, &header, sizeof(header), headerOffset);
+    if (fclose(fout) != 0 || rename(partial.c_str(), output.c_str()) != 0)
+    {
+        printf("Could not write %s\n", output.c_str());
+        return 1;
+    }
+
+    for (int i = 0; i < numCameras; i++)
+        delete imageTimes[i];
+
+    printf("Wrote %s, %.1f MB\n", output.c_str(), offset / (1024.0 * 1024.0));
+    return 0;
+}
@@ -0,0 +1,169 @@
+/**
+\file kittiviz-pngbench.cpp
+
+\brief Measures decoding camera images of a drive with PngDecoder and with SFML.
+
+Usage: kittiviz-pngbench <drive folder> [frames]
+
+The first frames of image_02, 100 unless given, are read into memory first, so only decoding
+is timed. Each decoder then decodes every frame once to warm up and once timed, the way
+ImageData decodes them: PngDecoder into a buffer in the native channel count, SFML into an
+sf::Image. Decoded pixels of both are compared, so a decoder that is fast but wrong is caught.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <SFML/Graphics.hpp>
+
+#include "../lib/utils/PngDecoder.h"
+
+static const int DEFAULT_FRAMES = 100;
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+\brief Read a whole file.
+
+\param filename - path of the file.
+\param data - receives content of the file.
+\return false if file can not be read.
+*/
+
+static bool readFile(const std::string& filename, std::vector<char>& data)
+{
+    FILE* fin = fopen(filename.c_str(), "rb");
+    if (!fin)
+        return false;
+
+    fseeko(fin, 0, SEEK_END);
+    data.resize(ftello(fin));
+    fseeko(fin, 0, SEEK_SET);
+    bool isRead = data.empty() || fread(&data[0], 1, data.size(), fin) == data.size();
+    fclose(fin);
+    return isRead;
+}
+
+/**
+\brief Decode every file with PngDecoder.
+
+\param pixels - receives pixels of the last file.
+\return seconds taken, negative if a file is not in the layout of KITTI cameras.
+*/
+
+static double decodePng(const std::vector<std::vector<char> >& files, std::vector<uint8_t>& pixels, PngDecoder::Info& info)
+{
+    auto start = Clock::now();
+    for (int i = 0; i < files.size(); i++)
+    {
+        if (!PngDecoder::readInfo(files[i].data(), files[i].size(), info))
+            return -1;
+        pixels.resize((size_t)info.width * info.height * info.channels);
+        if (!PngDecoder::decode(files[i].data(), files[i].size(), info, pixels.data()))
+            return -1;
+    }
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+\brief Decode every file with SFML.
+
+\param image - receives the last file.
+\return seconds taken, negative if a file can not be decoded.
+*/
+
+static double decodeSFML(const std::vector<std::vector<char> >& files, sf::Image& image)
+{
+    auto start = Clock::now();
+    for (int i = 0; i < files.size(); i++)
+    {
+        if (!image.loadFromMemory(files[i].data(), files[i].size()))
+            return -1;
+    }
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+\brief Count pixels that differ between PngDecoder and SFML, which always gives RGBA.
+*/
+
+static size_t countMismatches(const std::vector<uint8_t>& pixels, const PngDecoder::Info& info, const sf::Image& image)
+{
+    if (image.getSize().x != info.width || image.getSize().y != info.height)
+        return (size_t)info.width * info.height;
+
+    const uint8_t* rgba = image.getPixelsPtr();
+    size_t numPixels = (size_t)info.width * info.height;
+    size_t mismatches = 0;
+    for (size_t i = 0; i < numPixels; i++)
+    {
+        const uint8_t* p = &pixels[i * info.channels];
+        const uint8_t* q = &rgba[i * 4];
+        bool isSame = info.channels == 1 ? q[0] == p[0] && q[1] == p[0] && q[2] == p[0] :
+                      q[0] == p[0] && q[1] == p[1] && q[2] == p[2] && (info.channels == 3 || q[3] == p[3]);
+        if (!isSame)
+            mismatches++;
+    }
+    return mismatches;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printf("Usage: %s <drive folder> [frames]\n", argv[0]);
+        return 1;
+    }
+    std::string drive = argv[1];
+    int numFrames = argc > 2 ? atoi(argv[2]) : DEFAULT_FRAMES;
+
+    std::vector<std::vector<char> > files;
+    size_t fileBytes = 0;
+    for (int i = 0; i < numFrames; i++)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "/%010d.png", i);
+        std::vector<char> data;
+        if (!readFile(drive + "/image_02/data" + name, data))
+            break;
+        fileBytes += data.size();
+        files.push_back(data);
+    }
+    if (files.empty())
+    {
+        printf("No images in %s/image_02/data\n", drive.c_str());
+        return 1;
+    }
+
+    std::vector<uint8_t> pixels;
+    PngDecoder::Info info;
+    sf::Image image;
+    decodePng(files, pixels, info);
+    double pngSeconds = decodePng(files, pixels, info);
+    decodeSFML(files, image);
+    double sfmlSeconds = decodeSFML(files, image);
+    if (pngSeconds < 0 || sfmlSeconds < 0)
+    {
+        printf("Could not decode images with %s\n", pngSeconds < 0 ? "PngDecoder" : "SFML");
+        return 1;
+    }
+
+    int numRead = files.size();
+    double pixelMB = (double)info.width * info.height * numRead / 1e6;
+    printf("%d frames of %dx%d, %d channel(s), %.1f KB per file\n", numRead, info.width, info.height, info.channels,
+           fileBytes / 1024.0 / numRead);
+    printf("PngDecoder %7.2f ms/frame %7.1f Mpixel/s\n", pngSeconds * 1000 / numRead, pixelMB / pngSeconds);
+    printf("SFML       %7.2f ms/frame %7.1f Mpixel/s\n", sfmlSeconds * 1000 / numRead, pixelMB / sfmlSeconds);
+    printf("Speedup    %7.2fx\n", sfmlSeconds / pngSeconds);
+
+    size_t mismatches = countMismatches(pixels, info, image);
+    if (mismatches > 0)
+    {
+        printf("Last frame differs in %zu pixels\n", mismatches);
+        return 1;
+    }
+    return 0;
+}
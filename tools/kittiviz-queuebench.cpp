@@ -0,0 +1,186 @@
+/**
+\file kittiviz-queuebench.cpp
+
+\brief Measures handing frames from one thread to another through RingBuffer and SafeQueue.
+
+Usage: kittiviz-queuebench [items] [capacity]
+
+Items hold four shared pointers, like a FrameBundle, so each hand-off also pays the reference
+counting the loader pays. Two runs are made per queue:
+- Throughput, the producer pushes items as fast as the consumer takes them.
+- Latency, the producer pushes an item every PACE_US microseconds and the consumer reports
+  how long each one waited, as the render thread sees frames of the worker.
+
+RingBuffer is bounded by capacity, defaulting to DataLoader::MAX_QUEUE_SIZE, and both sides
+yield while it is full or empty. SafeQueue is unbounded and its consumer blocks in pop.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+
+#include "../lib/utils/RingBuffer.h"
+#include "../lib/utils/SafeQueue.h"
+
+static const int NUM_PAYLOADS = 4;      ///< Sensors of a frame.
+static const int PACE_US = 50;          ///< Microseconds between items of the latency run.
+static const int LATENCY_ITEMS = 20000;
+
+typedef std::chrono::steady_clock Clock;
+
+struct Item
+{
+    int id = -1;
+    Clock::time_point pushed;
+    std::shared_ptr<const std::vector<char> > payloads[NUM_PAYLOADS];
+};
+
+/**
+\brief Hand-offs of one thread to another, the queue only differs in how items are pushed and
+popped.
+*/
+
+class RingChannel
+{
+    public:
+        RingChannel(size_t capacity) : ring(capacity) {}
+
+        void push(Item&& item)
+        {
+            while (!ring.tryPush(std::move(item)))
+                std::this_thread::yield();
+        }
+
+        void pop(Item& item)
+        {
+            while (!ring.tryPop(item))
+                std::this_thread::yield();
+        }
+    private:
+        RingBuffer<Item> ring;
+};
+
+class QueueChannel
+{
+    public:
+        QueueChannel(size_t capacity) {}
+
+        void push(Item&& item)
+        {
+            queue.push(std::move(item));
+        }
+
+        void pop(Item& item)
+        {
+            queue.pop(item);
+        }
+    private:
+        SafeQueue<Item> queue;
+};
+
+static Item makeItem(int id, const std::shared_ptr<const std::vector<char> >& payload)
+{
+    Item item;
+    item.id = id;
+    for (int i = 0; i < NUM_PAYLOADS; i++)
+        item.payloads[i] = payload;
+    return item;
+}
+
+/**
+\brief Push items as fast as possible.
+
+\return items handed over per second.
+*/
+
+template <class Channel>
+static double measureThroughput(int numItems, size_t capacity)
+{
+    Channel channel(capacity);
+    std::shared_ptr<const std::vector<char> > payload = std::make_shared<const std::vector<char> >(64);
+
+    auto start = Clock::now();
+    std::thread producer([&]() {
+        for (int i = 0; i < numItems; i++)
+            channel.push(makeItem(i, payload));
+    });
+
+    Item item;
+    for (int i = 0; i < numItems; i++)
+    {
+        channel.pop(item);
+        if (item.id != i)
+        {
+            printf("Item %d popped out of order as %d\n", i, item.id);
+            exit(1);
+        }
+    }
+    producer.join();
+    return numItems / std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+\brief Push an item every PACE_US microseconds and time how long each waits in the channel.
+
+\param waits - receives wait of each item in microseconds, sorted.
+*/
+
+template <class Channel>
+static void measureLatency(size_t capacity, std::vector<double>& waits)
+{
+    Channel channel(capacity);
+    std::shared_ptr<const std::vector<char> > payload = std::make_shared<const std::vector<char> >(64);
+
+    std::thread producer([&]() {
+        auto next = Clock::now();
+        for (int i = 0; i < LATENCY_ITEMS; i++)
+        {
+            next += std::chrono::microseconds(PACE_US);
+            std::this_thread::sleep_until(next);
+            Item item = makeItem(i, payload);
+            item.pushed = Clock::now();
+            channel.push(std::move(item));
+        }
+    });
+
+    waits.resize(LATENCY_ITEMS);
+    Item item;
+    for (int i = 0; i < LATENCY_ITEMS; i++)
+    {
+        channel.pop(item);
+        waits[i] = std::chrono::duration<double, std::micro>(Clock::now() - item.pushed).count();
+    }
+    producer.join();
+    std::sort(waits.begin(), waits.end());
+}
+
+template <class Channel>
+static void run(const char* name, int numItems, size_t capacity)
+{
+    double perSecond = measureThroughput<Channel>(numItems, capacity);
+    std::vector<double> waits;
+    measureLatency<Channel>(capacity, waits);
+    printf("%-10s %8.2f M items/s %8.0f ns/item   wait median %6.2f us  p99 %6.2f us  max %8.2f us\n",
+           name, perSecond / 1e6, 1e9 / perSecond, waits[waits.size() / 2], waits[waits.size() * 99 / 100], waits.back());
+}
+
+int main(int argc, char** argv)
+{
+    int numItems = argc > 1 ? atoi(argv[1]) : 2000000;
+    int capacity = argc > 2 ? atoi(argv[2]) : 64;
+    if (numItems <= 0 || capacity <= 0)
+    {
+        printf("Usage: %s [items] [capacity]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%d items, ring capacity %d, %u hardware threads\n", numItems, capacity, std::thread::hardware_concurrency());
+    run<RingChannel>("RingBuffer", numItems, capacity);
+    run<QueueChannel>("SafeQueue", numItems, capacity);
+    return 0;
+}